@@ -82,18 +82,62 @@ function set_compiler( settings, config )
     elseif compiler == "gcc" then
         SetDriversGCC( settings )
         settings.cc.flags:Add( "-Wconversion", "-Wextra", "-Wall", "-Werror", "-Wstrict-aliasing=2" )
+        settings.link.flags:Add( "-pthread" ) -- getopt_check_paths() checks paths on threads
         if config == "release" then
             settings.cc.flags:Add( "-O2" )
         end
     elseif compiler == "clang" then
         SetDriversClang( settings )
         settings.cc.flags:Add( "-Wconversion", "-Wextra", "-Wall", "-Werror", "-Wstrict-aliasing=2" )
+        settings.link.flags:Add( "-pthread" ) -- getopt_check_paths() checks paths on threads
         if config == "release" then
             settings.cc.flags:Add( "-O2" )
         end
     end
 end
 
+-- write include/getopt/getopt_single.h to 'output' with all includes of getopt-files replaced by the included
+-- file, each file is only included once.
+function amalgamate( output )
+    local included = {}
+    local function expand( path )
+        local file = io.open( path, "rb" )
+        if file == nil then
+            error( "amalgamate: could not open " .. path )
+        end
+        local data = file:read( "*all" )
+        file:close()
+
+        local dir = PathDir( path )
+        local function resolve( prefix, include_path )
+            local resolved = PathJoin( "include", include_path )
+            if prefix == '"' then
+                resolved = PathJoin( dir, include_path )
+            end
+            if included[resolved] then
+                return "\n"
+            end
+            included[resolved] = true
+            return "\n/* ---- " .. include_path .. " ---- */\n" .. expand( resolved ) .. "\n"
+        end
+        -- only includes at the start of a line, not the ones in doc-comments
+        data = data:gsub( "\n#include (<)(getopt/[%w_]+%.h)>[^\n]*", resolve )
+        data = data:gsub( '\n#include (")([%w_%./]+%.[ch])"[^\n]*', resolve )
+        return data
+    end
+
+    local root = "include/getopt/getopt_single.h"
+    included[root] = true
+
+    local file = io.open( output, "wb" )
+    if file == nil then
+        error( "amalgamate: could not write " .. output )
+    end
+    file:write( expand( root ) )
+    file:close()
+    print( "wrote single-header build to " .. output )
+end
+
 config   = get_config()
 platform = get_platform()
 settings = get_base_settings()
@@ -108,10 +152,44 @@ settings.link.Output = output_func
 
 settings.cc.includes:Add( 'include' )
 
-local objs  = Compile( settings, 'src/getopt.c' )
+local objs  = Compile( settings, 'src/getopt.c', 'src/getopt_store.c' )
 local lib   = StaticLibrary( settings, 'getopt', objs )
 
 local example = Link( settings, 'example', Compile( settings, 'example/example.cpp' ), lib )
 
 local test_objs  = Compile( settings, 'test/getopt_tests.cpp' )
 local tests      = Link( settings, 'getopt_tests', test_objs, lib )
+
+local bench_objs = Compile( settings, 'bench/getopt_bench.cpp' )
+local bench      = Link( settings, 'getopt_bench', bench_objs, lib )
+
+-- same bench with getopt compiled into it through getopt_single.h, to compare against the library-build
+local single_settings = settings:Copy()
+single_settings.config_ext = "_single"
+single_settings.cc.defines:Add( "GETOPT_BENCH_SINGLE_HEADER" )
+local bench_single = Link( single_settings, 'getopt_bench', Compile( single_settings, 'bench/getopt_bench.cpp' ) )
+
+-- getopt built with features left out, see the GETOPT_NO_*-switches in getopt.h. Each configuration gets its
+-- own library and a getopt_minimal_<name> to compare size and startup-time of with getopt_startup.
+local feature_configs = {
+    { name = "full",    defines = {} },
+    { name = "no_help", defines = { "GETOPT_NO_HELP", "GETOPT_NO_COMPLETION", "GETOPT_NO_SUGGEST" } },
+    { name = "no_conv", defines = { "GETOPT_NO_INT", "GETOPT_NO_FLOAT", "GETOPT_NO_UNITS" } },
+    { name = "minimal", defines = { "GETOPT_MINIMAL" } },
+}
+
+for _, feature_config in ipairs( feature_configs ) do
+    local feature_settings = settings:Copy()
+    feature_settings.config_ext = "_" .. feature_config.name
+    for _, define in ipairs( feature_config.defines ) do
+        feature_settings.cc.defines:Add( define )
+    end
+    local feature_lib = StaticLibrary( feature_settings, 'getopt', Compile( feature_settings, 'src/getopt.c' ) )
+    Link( feature_settings, 'getopt_minimal', Compile( feature_settings, 'bench/getopt_minimal.c' ), feature_lib )
+end
+
+local startup = Link( settings, 'getopt_startup', Compile( settings, 'bench/getopt_startup.cpp' ), lib )
+
+if ScriptArgs["amalgamate"] ~= nil then
+    amalgamate( ScriptArgs["amalgamate"] )
+end
@@ -0,0 +1,579 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+/**
+ * Benchmark-harness for getopt.
+ *
+ * Times getopt_create_context(), a full getopt_next()-loop, getopt_create_help_string(), getopt_suggest(),
+ * getopt_complete() and getopt_fingerprint() over a set of scenarios and reports the result per scenario and per token. When run with --perf on linux the hardware
+ * performance counters cycles, instructions, branch-misses, L1d- and LLC-misses are read around each measured
+ * loop via perf_event_open().
+ *
+ * Built twice by bam.lua, getopt_bench links the static library and getopt_bench_single compiles getopt into
+ * the harness via getopt_single.h with GETOPT_BENCH_SINGLE_HEADER defined. Each result is tagged with the build
+ * so the output of both can be compared.
+ *
+ * When compiled as C++17 the "next_cpp" phase runs the same loop as "next" through getopt.hpp, the two should
+ * report the same numbers.
+ *
+ * usage: getopt_bench [--iterations=N] [--scenario=name] [--format=text|csv|json] [--perf]
+ */
+
+#if defined(GETOPT_BENCH_SINGLE_HEADER)
+#  define GETOPT_STATIC
+#  include <getopt/getopt_single.h>
+#else
+#  include <getopt/getopt.h>
+#endif
+
+#if __cplusplus >= 201703L || ( defined(_MSVC_LANG) && _MSVC_LANG >= 201703L )
+#  include <getopt/getopt.hpp>
+#  define GETOPT_BENCH_CPP17
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#define ARRAY_LENGTH( arr ) ( sizeof( arr ) / sizeof( arr[0] ) )
+
+// ... sink to keep the compiler from optimizing away measured work ...
+static volatile int g_sink = 0;
+
+static int g_flag = 0;
+
+#if defined(GETOPT_BENCH_SINGLE_HEADER)
+static const char* g_build = "single-header";
+#else
+static const char* g_build = "library";
+#endif
+
+enum bench_counter
+{
+	BENCH_COUNTER_CYCLES,
+	BENCH_COUNTER_INSTRUCTIONS,
+	BENCH_COUNTER_BRANCH_MISSES,
+	BENCH_COUNTER_L1D_MISSES,
+	BENCH_COUNTER_LLC_MISSES,
+
+	BENCH_COUNTER_COUNT
+};
+
+static const char* g_counter_names[BENCH_COUNTER_COUNT] =
+{
+	"cycles",
+	"instructions",
+	"branch_misses",
+	"l1d_misses",
+	"llc_misses"
+};
+
+struct bench_counters
+{
+	int fd[BENCH_COUNTER_COUNT]; // -1 if the counter is not available
+};
+
+struct bench_result
+{
+	const char* scenario;
+	const char* phase;
+	int         iterations;
+	int         tokens;
+	double      ns;
+	long long   counters[BENCH_COUNTER_COUNT]; // -1 if the counter is not available
+};
+
+#if defined(__linux__)
+static int bench_open_counter( unsigned int type, unsigned long long config )
+{
+	struct perf_event_attr attr;
+	memset( &attr, 0x0, sizeof( attr ) );
+	attr.type           = type;
+	attr.size           = sizeof( attr );
+	attr.config         = config;
+	attr.disabled       = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+	return (int)syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+}
+#endif
+
+static void bench_counters_open( bench_counters* c, bool enable )
+{
+	for( int i = 0; i < BENCH_COUNTER_COUNT; ++i )
+		c->fd[i] = -1;
+
+	if( !enable )
+		return;
+
+#if defined(__linux__)
+	// ... counters are opened one by one and not as a group so that one unsupported counter do not take the rest down ...
+	c->fd[BENCH_COUNTER_CYCLES]        = bench_open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES );
+	c->fd[BENCH_COUNTER_INSTRUCTIONS]  = bench_open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+	c->fd[BENCH_COUNTER_BRANCH_MISSES] = bench_open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES );
+	c->fd[BENCH_COUNTER_L1D_MISSES]    = bench_open_counter( PERF_TYPE_HW_CACHE,   PERF_COUNT_HW_CACHE_L1D
+	                                                                             | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+	                                                                             | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) );
+	c->fd[BENCH_COUNTER_LLC_MISSES]    = bench_open_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+
+	for( int i = 0; i < BENCH_COUNTER_COUNT; ++i )
+		if( c->fd[i] < 0 )
+			fprintf( stderr, "could not open counter %s, check /proc/sys/kernel/perf_event_paranoid.\n", g_counter_names[i] );
+#else
+	fprintf( stderr, "--perf is only supported on linux, reporting timings only.\n" );
+#endif
+}
+
+static void bench_counters_close( bench_counters* c )
+{
+#if defined(__linux__)
+	for( int i = 0; i < BENCH_COUNTER_COUNT; ++i )
+		if( c->fd[i] >= 0 )
+			close( c->fd[i] );
+#else
+	(void)c;
+#endif
+}
+
+static void bench_counters_start( bench_counters* c )
+{
+#if defined(__linux__)
+	for( int i = 0; i < BENCH_COUNTER_COUNT; ++i )
+	{
+		if( c->fd[i] < 0 )
+			continue;
+		ioctl( c->fd[i], PERF_EVENT_IOC_RESET,  0 );
+		ioctl( c->fd[i], PERF_EVENT_IOC_ENABLE, 0 );
+	}
+#else
+	(void)c;
+#endif
+}
+
+static void bench_counters_stop( bench_counters* c, long long* out )
+{
+	for( int i = 0; i < BENCH_COUNTER_COUNT; ++i )
+	{
+		out[i] = -1;
+#if defined(__linux__)
+		if( c->fd[i] < 0 )
+			continue;
+
+		ioctl( c->fd[i], PERF_EVENT_IOC_DISABLE, 0 );
+		long long value;
+		if( read( c->fd[i], &value, sizeof( value ) ) == (ssize_t)sizeof( value ) )
+			out[i] = value;
+#else
+		(void)c;
+#endif
+	}
+}
+
+/**
+ * A scenario is one option-list and one argv to parse with it.
+ */
+struct bench_scenario
+{
+	const char*            name;
+	const getopt_option_t* opts;
+	int                    argc;
+	const char**           argv;
+	bool                   use_index;  // create a lookup-index with getopt_create_index()
+	const char*            misspelled; // unknown token to find suggestions for with getopt_suggest()
+	const char*            partial;    // partial option to complete with getopt_complete()
+};
+
+// ... small option-list, same as the one in example/example.cpp ...
+static const getopt_option_t small_option_list[] =
+{
+	{ "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,   0x0,      'h', "print this help text",       0x0, 0x0, 0 },
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET, &g_flag,   1,  "verbose logging enabled",    0x0, 0x0, 0 },
+	{ "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0,      'i', "an input file",           "FILE", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static const char* small_argv[] = { "bench", "-v", "--input=file.txt", "-i", "other.txt", "positional", "--verbose", "-h" };
+
+// ... large option-list, generated at startup to stress the option-lookup ...
+#define BENCH_LARGE_NUM_OPTS 512
+#define BENCH_LARGE_NUM_ARGS 256
+
+static char            large_names[BENCH_LARGE_NUM_OPTS][32];
+static getopt_option_t large_option_list[BENCH_LARGE_NUM_OPTS + 1];
+static char            large_tokens[BENCH_LARGE_NUM_ARGS][48];
+static const char*     large_argv[BENCH_LARGE_NUM_ARGS + 1];
+
+static void bench_build_large_scenario()
+{
+	static const getopt_option_type_t types[] =
+	{
+		GETOPT_OPTION_TYPE_NO_ARG,
+		GETOPT_OPTION_TYPE_REQUIRED,
+		GETOPT_OPTION_TYPE_REQUIRED_INT32,
+		GETOPT_OPTION_TYPE_OPTIONAL_FP32,
+		GETOPT_OPTION_TYPE_FLAG_OR
+	};
+
+	for( int i = 0; i < BENCH_LARGE_NUM_OPTS; ++i )
+	{
+		getopt_option_t* opt = large_option_list + i;
+		snprintf( large_names[i], sizeof( large_names[i] ), "option-number-%d", i );
+		memset( opt, 0x0, sizeof( *opt ) );
+		opt->name       = large_names[i];
+		opt->name_short = 0;
+		opt->type       = types[ i % ARRAY_LENGTH( types ) ];
+		opt->flag       = opt->type == GETOPT_OPTION_TYPE_FLAG_OR ? &g_flag : 0x0;
+		opt->value      = opt->type == GETOPT_OPTION_TYPE_FLAG_OR ? 1 : 1000 + i;
+		opt->desc       = "generated option";
+		opt->value_desc = "VALUE";
+	}
+	memset( large_option_list + BENCH_LARGE_NUM_OPTS, 0x0, sizeof( getopt_option_t ) );
+
+	// ... spread the used options over the table, late options are the expensive ones for a linear lookup ...
+	large_argv[0] = "bench";
+	for( int i = 0; i < BENCH_LARGE_NUM_ARGS; ++i )
+	{
+		int opt_index = ( i * 193 ) % BENCH_LARGE_NUM_OPTS;
+		switch( large_option_list[opt_index].type )
+		{
+			case GETOPT_OPTION_TYPE_REQUIRED:
+			case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+				snprintf( large_tokens[i], sizeof( large_tokens[i] ), "--%s=%d", large_names[opt_index], i );
+				break;
+			default:
+				snprintf( large_tokens[i], sizeof( large_tokens[i] ), "--%s", large_names[opt_index] );
+				break;
+		}
+		large_argv[i + 1] = large_tokens[i];
+	}
+}
+
+static bench_scenario g_scenarios[] =
+{
+	{ "small",         small_option_list, (int)ARRAY_LENGTH( small_argv ), small_argv, false, "--verbsoe",          "--verb" },
+	{ "large",         large_option_list, BENCH_LARGE_NUM_ARGS + 1,        large_argv, false, "--option-numbr-511", "--option-number-51" },
+	{ "large_indexed", large_option_list, BENCH_LARGE_NUM_ARGS + 1,        large_argv, true,  "--option-numbr-511", "--option-number-51" }
+};
+
+static void bench_create_context( getopt_context_t* ctx, const bench_scenario* s )
+{
+	static getopt_index_entry_t index[BENCH_LARGE_NUM_OPTS];
+	g_sink += getopt_create_context( ctx, s->argc, s->argv, s->opts );
+	if( s->use_index )
+		g_sink += getopt_create_index( ctx, index, (int)ARRAY_LENGTH( index ) );
+}
+
+static void bench_phase_create( const bench_scenario* s )
+{
+	getopt_context_t ctx;
+	bench_create_context( &ctx, s );
+}
+
+static void bench_phase_next( const bench_scenario* s )
+{
+	getopt_context_t ctx;
+	bench_create_context( &ctx, s );
+
+	int opt;
+	while( ( opt = getopt_next( &ctx ) ) != -1 )
+		g_sink += opt;
+}
+
+#if defined(GETOPT_BENCH_CPP17)
+// ... same loop through getopt.hpp, should cost the same as "next" ...
+static void bench_phase_next_cpp( const bench_scenario* s )
+{
+	static getopt_index_entry_t index[BENCH_LARGE_NUM_OPTS];
+	auto ctx = getopt_cpp::context::create( s->argc, s->argv, s->opts );
+	if( !ctx )
+		return;
+	if( s->use_index )
+		g_sink += getopt_create_index( ctx->get(), index, (int)ARRAY_LENGTH( index ) );
+
+	for( auto ev : *ctx )
+		g_sink += ev.raw();
+}
+#endif
+
+static void bench_phase_help( const bench_scenario* s )
+{
+	static char buffer[64 * 1024];
+	getopt_context_t ctx;
+	bench_create_context( &ctx, s );
+	g_sink += getopt_create_help_string( &ctx, buffer, sizeof( buffer ) )[0];
+}
+
+static void bench_phase_suggest( const bench_scenario* s )
+{
+	const getopt_option_t* suggestions[4];
+	getopt_context_t ctx;
+	bench_create_context( &ctx, s );
+	g_sink += getopt_suggest( &ctx, s->misspelled, 2, suggestions, (int)ARRAY_LENGTH( suggestions ) );
+}
+
+static void bench_phase_complete( const bench_scenario* s )
+{
+	static char buffer[4096];
+	const char* argv[] = { "bench", GETOPT_COMPLETE_ARG "=0", s->partial };
+	bench_scenario query = *s;
+	query.argc = (int)ARRAY_LENGTH( argv );
+	query.argv = argv;
+
+	getopt_context_t ctx;
+	bench_create_context( &ctx, &query );
+	g_sink += getopt_complete( &ctx, buffer, sizeof( buffer ) );
+}
+
+static void bench_phase_fingerprint( const bench_scenario* s )
+{
+	static getopt_occurrence_t occurrences[BENCH_LARGE_NUM_OPTS];
+	getopt_context_t ctx;
+	getopt_fingerprint_t fp;
+	bench_create_context( &ctx, s );
+	g_sink += getopt_create_query_index( &ctx, occurrences, (int)ARRAY_LENGTH( occurrences ) );
+	if( getopt_fingerprint( &ctx, 0x0, &fp ) == 0 )
+		g_sink += (int)fp.lo;
+}
+
+struct bench_phase
+{
+	const char* name;
+	void (*func)( const bench_scenario* s );
+};
+
+static const bench_phase g_phases[] =
+{
+	{ "create_context", bench_phase_create },
+	{ "next",           bench_phase_next },
+#if defined(GETOPT_BENCH_CPP17)
+	{ "next_cpp",       bench_phase_next_cpp },
+#endif
+	{ "help_string",    bench_phase_help },
+	{ "suggest",        bench_phase_suggest },
+	{ "complete",       bench_phase_complete },
+	{ "fingerprint",    bench_phase_fingerprint }
+};
+
+static void bench_run( bench_result* res, bench_counters* counters, const bench_scenario* s, const bench_phase* phase, int iterations )
+{
+	// ... warm up caches and branch-predictors before measuring ...
+	for( int i = 0; i < 16; ++i )
+		phase->func( s );
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bench_counters_start( counters );
+
+	for( int i = 0; i < iterations; ++i )
+		phase->func( s );
+
+	bench_counters_stop( counters, res->counters );
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	res->scenario   = s->name;
+	res->phase      = phase->name;
+	res->iterations = iterations;
+	res->tokens     = s->argc - 1;
+	res->ns         = (double)std::chrono::duration_cast<std::chrono::nanoseconds>( end - start ).count();
+}
+
+static double bench_per_token( const bench_result* res, double value )
+{
+	return value / ( (double)res->iterations * (double)( res->tokens > 0 ? res->tokens : 1 ) );
+}
+
+enum bench_format
+{
+	BENCH_FORMAT_TEXT,
+	BENCH_FORMAT_CSV,
+	BENCH_FORMAT_JSON
+};
+
+static void bench_print( bench_format format, const bench_result* results, int num_results )
+{
+	switch( format )
+	{
+		case BENCH_FORMAT_TEXT:
+		{
+			printf( "%-14s %-14s %-16s %12s %12s", "build", "scenario", "phase", "ns/iter", "ns/token" );
+			for( int c = 0; c < BENCH_COUNTER_COUNT; ++c )
+				printf( " %16s", g_counter_names[c] );
+			printf( "\n" );
+
+			for( int r = 0; r < num_results; ++r )
+			{
+				const bench_result* res = results + r;
+				printf( "%-14s %-14s %-16s %12.1f %12.2f", g_build, res->scenario, res->phase, res->ns / res->iterations, bench_per_token( res, res->ns ) );
+				for( int c = 0; c < BENCH_COUNTER_COUNT; ++c )
+				{
+					if( res->counters[c] < 0 )
+						printf( " %16s", "n/a" );
+					else
+						printf( " %16.2f", bench_per_token( res, (double)res->counters[c] ) );
+				}
+				printf( "\n" );
+			}
+			printf( "(counters are reported per token)\n" );
+		}
+		break;
+		case BENCH_FORMAT_CSV:
+		{
+			printf( "build,scenario,phase,iterations,tokens,ns_total,ns_per_iter,ns_per_token" );
+			for( int c = 0; c < BENCH_COUNTER_COUNT; ++c )
+				printf( ",%s_total,%s_per_token", g_counter_names[c], g_counter_names[c] );
+			printf( "\n" );
+
+			for( int r = 0; r < num_results; ++r )
+			{
+				const bench_result* res = results + r;
+				printf( "%s,%s,%s,%d,%d,%.0f,%.3f,%.3f", g_build, res->scenario, res->phase, res->iterations, res->tokens, res->ns, res->ns / res->iterations, bench_per_token( res, res->ns ) );
+				for( int c = 0; c < BENCH_COUNTER_COUNT; ++c )
+				{
+					if( res->counters[c] < 0 )
+						printf( ",," );
+					else
+						printf( ",%lld,%.3f", res->counters[c], bench_per_token( res, (double)res->counters[c] ) );
+				}
+				printf( "\n" );
+			}
+		}
+		break;
+		case BENCH_FORMAT_JSON:
+		{
+			printf( "[\n" );
+			for( int r = 0; r < num_results; ++r )
+			{
+				const bench_result* res = results + r;
+				printf( "  { \"build\": \"%s\", \"scenario\": \"%s\", \"phase\": \"%s\", \"iterations\": %d, \"tokens\": %d, \"ns_total\": %.0f, \"ns_per_iter\": %.3f, \"ns_per_token\": %.3f",
+						g_build, res->scenario, res->phase, res->iterations, res->tokens, res->ns, res->ns / res->iterations, bench_per_token( res, res->ns ) );
+				for( int c = 0; c < BENCH_COUNTER_COUNT; ++c )
+				{
+					if( res->counters[c] < 0 )
+						printf( ", \"%s_total\": null, \"%s_per_token\": null", g_counter_names[c], g_counter_names[c] );
+					else
+						printf( ", \"%s_total\": %lld, \"%s_per_token\": %.3f", g_counter_names[c], res->counters[c], g_counter_names[c], bench_per_token( res, (double)res->counters[c] ) );
+				}
+				printf( " }%s\n", r == num_results - 1 ? "" : "," );
+			}
+			printf( "]\n" );
+		}
+		break;
+	}
+}
+
+static const getopt_option_t bench_option_list[] =
+{
+	{ "help",       'h', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'h', "print this help text",                              0x0, 0x0, 0 },
+	{ "iterations", 'n', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0, 'n', "number of iterations per measurement",              "N", 0x0, 0 },
+	{ "scenario",   's', GETOPT_OPTION_TYPE_REQUIRED,       0x0, 's', "only run scenario with this name",                  "NAME", 0x0, 0 },
+	{ "format",     'f', GETOPT_OPTION_TYPE_REQUIRED,       0x0, 'f', "output format, text, csv or json",                  "FORMAT", 0x0, 0 },
+	{ "perf",       'p', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'p', "read hardware performance counters (linux only)",   0x0, 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+int main( int argc, const char** argv )
+{
+	int          iterations = 10000;
+	const char*  scenario   = 0x0;
+	bench_format format     = BENCH_FORMAT_TEXT;
+	bool         use_perf   = false;
+
+	getopt_context_t ctx;
+	if( getopt_create_context( &ctx, argc, argv, bench_option_list ) < 0 )
+	{
+		fprintf( stderr, "error while creating getopt ctx, bad options-list?\n" );
+		return 1;
+	}
+
+	int opt;
+	while( ( opt = getopt_next( &ctx ) ) != -1 )
+	{
+		switch( opt )
+		{
+			case 'h':
+			{
+				char buffer[2048];
+				printf( "%s\n", getopt_create_help_string( &ctx, buffer, sizeof( buffer ) ) );
+				return 0;
+			}
+			case 'n': iterations = ctx.current_value.i32; break;
+			case 's': scenario   = ctx.current_opt_arg;   break;
+			case 'p': use_perf   = true;                  break;
+			case 'f':
+				if( strcmp( ctx.current_opt_arg, "text" ) == 0 )      format = BENCH_FORMAT_TEXT;
+				else if( strcmp( ctx.current_opt_arg, "csv" ) == 0 )  format = BENCH_FORMAT_CSV;
+				else if( strcmp( ctx.current_opt_arg, "json" ) == 0 ) format = BENCH_FORMAT_JSON;
+				else
+				{
+					fprintf( stderr, "unknown format %s\n", ctx.current_opt_arg );
+					return 1;
+				}
+				break;
+			case '+':
+			case '?':
+			case '!':
+				fprintf( stderr, "invalid argument %s\n", ctx.current_opt_arg );
+				return 1;
+			default:
+				break;
+		}
+	}
+
+	if( iterations <= 0 )
+	{
+		fprintf( stderr, "--iterations need to be > 0\n" );
+		return 1;
+	}
+
+	bench_build_large_scenario();
+
+	bench_counters counters;
+	bench_counters_open( &counters, use_perf );
+
+	bench_result results[ ARRAY_LENGTH( g_scenarios ) * ARRAY_LENGTH( g_phases ) ];
+	int num_results = 0;
+
+	for( size_t s = 0; s < ARRAY_LENGTH( g_scenarios ); ++s )
+	{
+		if( scenario != 0x0 && strcmp( scenario, g_scenarios[s].name ) != 0 )
+			continue;
+
+		for( size_t p = 0; p < ARRAY_LENGTH( g_phases ); ++p )
+			bench_run( &results[num_results++], &counters, &g_scenarios[s], &g_phases[p], iterations );
+	}
+
+	bench_counters_close( &counters );
+
+	bench_print( format, results, num_results );
+	return 0;
+}
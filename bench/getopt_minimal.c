@@ -0,0 +1,65 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+/*
+	Smallest useful program using getopt, built by bam.lua once per feature-configuration so that binary-size and
+	exec-to-parse time can be compared with getopt_startup. Does not use stdio, the result of the parse is returned
+	as exit-code.
+*/
+
+#include <getopt/getopt.h>
+
+static int verbose = 0;
+
+static const getopt_option_t option_list[] =
+{
+	{ "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,        0x0,      'h', "print this help text",    0x0, 0x0, 0 },
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET,      &verbose,  1,  "verbose logging enabled", 0x0, 0x0, 0 },
+	{ "input",   'i', GETOPT_OPTION_TYPE_REQUIRED,      0x0,      'i', "an input file",           "FILE", 0x0, 0 },
+	{ "mode",    'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM, 0x0,      'm', "how to run",              "fast|safe", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+int main( int argc, const char** argv )
+{
+	getopt_context_t ctx;
+	if( getopt_create_context( &ctx, argc, argv, option_list ) < 0 )
+		return 2;
+
+	int opt;
+	while( ( opt = getopt_next( &ctx ) ) != -1 )
+	{
+		switch( opt )
+		{
+			case '?':
+			case '!':
+				return 1;
+			default:
+				break;
+		}
+	}
+	return 0;
+}
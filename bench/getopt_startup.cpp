@@ -0,0 +1,148 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+/**
+ * Reports binary-size and exec-to-parse time for the getopt_minimal-binaries that bam.lua builds for each
+ * feature-configuration, see the GETOPT_NO_* switches in getopt.h.
+ *
+ * Each binary is started --iterations times with a short command line and the mean time from spawn until it
+ * has parsed the command line and exited is reported.
+ *
+ * usage: getopt_startup [--iterations=N] binary...
+ */
+
+#include <getopt/getopt.h>
+
+#include <stdio.h>
+#include <chrono>
+
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#  include <spawn.h>
+#  include <sys/wait.h>
+#endif
+
+static const char* g_child_argv[] = { 0x0, "-v", "--input=file.txt", "-i", "other.txt", "--mode=fast", "positional", 0x0 };
+
+// ... returns mean ns per exec or -1.0 if the binary could not be started ...
+static double startup_time( const char* path, int iterations )
+{
+#if defined(_WIN32)
+	(void)path;
+	(void)iterations;
+	return -1.0;
+#else
+	g_child_argv[0] = path;
+	char* env[] = { 0x0 };
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for( int i = 0; i < iterations; ++i )
+	{
+		pid_t pid;
+		if( posix_spawn( &pid, path, 0x0, 0x0, (char* const*)g_child_argv, env ) != 0 )
+			return -1.0;
+
+		int status = 0;
+		if( waitpid( pid, &status, 0 ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+			return -1.0;
+	}
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>( stop - start ).count() / iterations;
+#endif
+}
+
+static const getopt_option_t startup_option_list[] =
+{
+	{ "help",       'h', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'h', "print this help text",           0x0, 0x0, 0 },
+	{ "iterations", 'n', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0, 'n', "number of starts per binary",    "N", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+int main( int argc, const char** argv )
+{
+	int iterations = 200;
+
+	getopt_context_t ctx;
+	if( getopt_create_context( &ctx, argc, argv, startup_option_list ) < 0 )
+	{
+		fprintf( stderr, "error while creating getopt ctx, bad options-list?\n" );
+		return 1;
+	}
+
+	const char* binaries[64];
+	int num_binaries = 0;
+
+	int opt;
+	while( ( opt = getopt_next( &ctx ) ) != -1 )
+	{
+		switch( opt )
+		{
+			case 'h':
+			{
+				char buffer[1024];
+				printf( "usage: getopt_startup [options] binary...\n\n%s\n", getopt_create_help_string( &ctx, buffer, sizeof( buffer ) ) );
+				return 0;
+			}
+			case 'n':
+				iterations = ctx.current_value.i32;
+				break;
+			case '+':
+				if( num_binaries < (int)( sizeof( binaries ) / sizeof( binaries[0] ) ) )
+					binaries[num_binaries++] = ctx.current_opt_arg;
+				break;
+			case '?':
+			case '!':
+				fprintf( stderr, "invalid argument %s\n", ctx.current_opt_arg );
+				return 1;
+			default:
+				break;
+		}
+	}
+
+	if( iterations <= 0 || num_binaries == 0 )
+	{
+		fprintf( stderr, "need at least one binary and --iterations > 0\n" );
+		return 1;
+	}
+
+	printf( "%-48s %12s %14s\n", "binary", "bytes", "us/exec" );
+	for( int i = 0; i < num_binaries; ++i )
+	{
+		struct stat st;
+		if( stat( binaries[i], &st ) != 0 )
+		{
+			printf( "%-48s %12s %14s\n", binaries[i], "n/a", "n/a" );
+			continue;
+		}
+
+		double ns = startup_time( binaries[i], iterations );
+		if( ns < 0.0 )
+			printf( "%-48s %12lld %14s\n", binaries[i], (long long)st.st_size, "n/a" );
+		else
+			printf( "%-48s %12lld %14.1f\n", binaries[i], (long long)st.st_size, ns / 1000.0 );
+	}
+	return 0;
+}
@@ -5,16 +5,16 @@ int verbose = 0; // verbose flag
 
 static const getopt_option_t option_list[] =
 {
-	{ "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,   0x0,      'h', "print this help text",       0x0 },
-	{ "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET, &verbose,  1,  "verbose logging enabled",    0x0 },
-	{ "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0,      'i', "an input file",           "FILE" },
+	{ "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,   0x0,      'h', "print this help text",       0x0, 0x0, 0 },
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET, &verbose,  1,  "verbose logging enabled",    0x0, 0x0, 0 },
+	{ "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0,      'i', "an input file",           "FILE", 0x0, 0 },
 	GETOPT_OPTIONS_END
 };
 
-static void print_help_string( getopt_context_t ctx )
+static void print_help_string( getopt_context_t* ctx )
 {
 	char buffer[2048];
-	printf( "%s\n", getopt_create_help_string( &ctx, buffer, sizeof( buffer ) ) );
+	printf( "%s\n", getopt_create_help_string( ctx, buffer, sizeof( buffer ) ) );
 }
 
 int main( int argc, const char** argv )
@@ -37,7 +37,7 @@ int main( int argc, const char** argv )
 			case '!': printf( "invalid use of flag %s\n",          ctx.current_opt_arg ); break;
 			case 'i': printf( "got -i or --input with value %s\n", ctx.current_opt_arg ); break;
 			case   0: printf( "flag was set!\n"); break;
-			case 'h': print_help_string( ctx ); break;
+			case 'h': print_help_string( &ctx ); break;
 			default: break;
 		}
 	}
@@ -29,6 +29,83 @@
 
 #include <stddef.h>
 
+/**
+ * Compile-time switches to leave features out of the library, for binaries where size and startup matter.
+ * The same switches need to be defined when compiling getopt and code including this header.
+ *
+ * GETOPT_NO_HELP              - leave out getopt_create_help_string().
+ * GETOPT_NO_COMPLETION        - leave out getopt_complete() and getopt_create_completion_script().
+ * GETOPT_NO_SUGGEST           - leave out getopt_suggest().
+ * GETOPT_NO_INT               - no int-conversion, options of type *_INT32 are rejected by getopt_create_context().
+ * GETOPT_NO_FLOAT             - no float-conversion, options of type *_FP32 are rejected by getopt_create_context().
+ * GETOPT_NO_UNITS             - SIZE, DURATION and RATE options are rejected by getopt_create_context().
+ * GETOPT_NO_CASE_INSENSITIVE  - long options are matched case-sensitive.
+ * GETOPT_NO_PATH              - PATH options are rejected by getopt_create_context(), no path-batch.
+ * GETOPT_NO_PATH_THREADS      - getopt_check_paths() checks all paths on the calling thread.
+ * GETOPT_NO_GLOB              - leave out glob-expansion of non-options, always set on windows.
+ * GETOPT_NO_BLOB              - HEX and BASE64 options are rejected by getopt_create_context().
+ * GETOPT_NO_PATTERN           - PATTERN options are rejected by getopt_create_context().
+ * GETOPT_NO_SIMD              - only use the portable decoders and UTF-8 validator, not the SSE2-ones.
+ * GETOPT_MINIMAL              - all of the above, getopt.c then does not use stdio.
+ */
+#if defined(GETOPT_MINIMAL)
+#  if !defined(GETOPT_NO_HELP)
+#    define GETOPT_NO_HELP
+#  endif
+#  if !defined(GETOPT_NO_COMPLETION)
+#    define GETOPT_NO_COMPLETION
+#  endif
+#  if !defined(GETOPT_NO_SUGGEST)
+#    define GETOPT_NO_SUGGEST
+#  endif
+#  if !defined(GETOPT_NO_INT)
+#    define GETOPT_NO_INT
+#  endif
+#  if !defined(GETOPT_NO_FLOAT)
+#    define GETOPT_NO_FLOAT
+#  endif
+#  if !defined(GETOPT_NO_UNITS)
+#    define GETOPT_NO_UNITS
+#  endif
+#  if !defined(GETOPT_NO_CASE_INSENSITIVE)
+#    define GETOPT_NO_CASE_INSENSITIVE
+#  endif
+#  if !defined(GETOPT_NO_PATH)
+#    define GETOPT_NO_PATH
+#  endif
+#  if !defined(GETOPT_NO_GLOB)
+#    define GETOPT_NO_GLOB
+#  endif
+#  if !defined(GETOPT_NO_BLOB)
+#    define GETOPT_NO_BLOB
+#  endif
+#  if !defined(GETOPT_NO_PATTERN)
+#    define GETOPT_NO_PATTERN
+#  endif
+#endif
+#if defined(_WIN32) && !defined(GETOPT_NO_GLOB)
+#  define GETOPT_NO_GLOB
+#endif
+#if defined(GETOPT_NO_PATH) && !defined(GETOPT_NO_PATH_THREADS)
+#  define GETOPT_NO_PATH_THREADS
+#endif
+
+/**
+ * Put before all functions in the api. With GETOPT_STATIC defined all functions are declared as static inline,
+ * used by getopt_single.h to compile a private copy of getopt into the translation unit that includes it.
+ */
+#if !defined(GETOPT_API)
+#  if defined(GETOPT_STATIC)
+#    if defined(_MSC_VER) && !defined(__cplusplus)
+#      define GETOPT_API static __inline
+#    else
+#      define GETOPT_API static inline
+#    endif
+#  else
+#    define GETOPT_API
+#  endif
+#endif
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
@@ -43,9 +120,9 @@ extern "C" {
  *   // ... first we need to define our options, these need to be valid during the entire commandline-parse ...
  *   const getopt_option_t option_list[] =
  *   {
- *       { "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,   0x0,      'h', "print this help text",       0x0 },
- *       { "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET, &verbose,  1,  "verbose logging enabled",    0x0 },
- *       { "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0,      'i', "an input file",           "FILE" },
+ *       { "help",    'h', GETOPT_OPTION_TYPE_NO_ARG,   0x0,      'h', "print this help text",       0x0, 0x0, 0 },
+ *       { "verbose", 'v', GETOPT_OPTION_TYPE_FLAG_SET, &verbose,  1,  "verbose logging enabled",    0x0, 0x0, 0 },
+ *       { "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0,      'i', "an input file",           "FILE", 0x0, 0 },
  *       GETOPT_OPTIONS_END
  *   };
  *
@@ -80,23 +157,50 @@ extern "C" {
  */
 typedef enum getopt_option_type
 {
-	GETOPT_OPTION_TYPE_NO_ARG,         ///< The option can have no argument
-	GETOPT_OPTION_TYPE_REQUIRED,       ///< The option requires an argument (--option=arg, -o arg)
-	GETOPT_OPTION_TYPE_OPTIONAL,       ///< The option-argument is optional
-	GETOPT_OPTION_TYPE_REQUIRED_INT32, ///< The option requires an argument and this argument has to be parseable as an int (--option=arg, -o arg)
-	GETOPT_OPTION_TYPE_OPTIONAL_INT32, ///< The option-argument is optional, but if it is there it has to be parseable as int.
-	GETOPT_OPTION_TYPE_REQUIRED_FP32,  ///< The option requires an argument and this argument has to be parseable as an float (--option=arg, -o arg)
-	GETOPT_OPTION_TYPE_OPTIONAL_FP32,  ///< The option-argument is optional, but if it is there it has to be parseable as float.
-	GETOPT_OPTION_TYPE_FLAG_SET,       ///< The option is a flag and value will be set to flag
-	GETOPT_OPTION_TYPE_FLAG_AND,       ///< The option is a flag and value will be and:ed with flag
-	GETOPT_OPTION_TYPE_FLAG_OR         ///< The option is a flag and value will be or:ed with flag
+	GETOPT_OPTION_TYPE_NO_ARG,            ///< The option can have no argument
+	GETOPT_OPTION_TYPE_REQUIRED,          ///< The option requires an argument (--option=arg, -o arg)
+	GETOPT_OPTION_TYPE_OPTIONAL,          ///< The option-argument is optional
+	GETOPT_OPTION_TYPE_REQUIRED_INT32,    ///< The option requires an argument and this argument has to be parseable as an int (--option=arg, -o arg)
+	GETOPT_OPTION_TYPE_OPTIONAL_INT32,    ///< The option-argument is optional, but if it is there it has to be parseable as int.
+	GETOPT_OPTION_TYPE_REQUIRED_FP32,     ///< The option requires an argument and this argument has to be parseable as an float (--option=arg, -o arg)
+	GETOPT_OPTION_TYPE_OPTIONAL_FP32,     ///< The option-argument is optional, but if it is there it has to be parseable as float.
+	GETOPT_OPTION_TYPE_FLAG_SET,          ///< The option is a flag and value will be set to flag
+	GETOPT_OPTION_TYPE_FLAG_AND,          ///< The option is a flag and value will be and:ed with flag
+	GETOPT_OPTION_TYPE_FLAG_OR,           ///< The option is a flag and value will be or:ed with flag
+	GETOPT_OPTION_TYPE_REQUIRED_ENUM,     ///< The option requires an argument that is one of the names listed in value_desc as "fast|balanced|safe".
+	GETOPT_OPTION_TYPE_REQUIRED_BITMASK,  ///< The option requires an argument that is a ','-separated list of the names listed in value_desc as "simd|mmap|async", max 32 names.
+	GETOPT_OPTION_TYPE_REQUIRED_SIZE,     ///< The option requires an argument that is a size in bytes with optional unit, "512M", "1.5GiB".
+	GETOPT_OPTION_TYPE_REQUIRED_DURATION, ///< The option requires an argument that is a duration with optional unit, "250ms", "2h". Seconds if no unit is given.
+	GETOPT_OPTION_TYPE_REQUIRED_RATE,     ///< The option requires an argument that is an amount per second with optional unit, "10k/s", "100MB/s".
+	GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS,   ///< The option requires an argument that is a path that exists. See <getopt_create_path_batch> for when it is checked.
+	GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE,     ///< The option requires an argument that is a path to a regular file.
+	GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR,      ///< The option requires an argument that is a path to a directory.
+	GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE, ///< The option requires an argument that is a path that the process can read.
+	GETOPT_OPTION_TYPE_REQUIRED_HEX,           ///< The option requires an argument that is bytes as hex, 2 digits per byte, "00ff10". See <getopt_set_blob_buffer>.
+	GETOPT_OPTION_TYPE_REQUIRED_BASE64,        ///< The option requires an argument that is bytes as base64 (RFC 4648), padding is optional. See <getopt_set_blob_buffer>.
+	GETOPT_OPTION_TYPE_REQUIRED_PATTERN        ///< The option requires an argument that matches the pattern in value_desc as "[a-z][a-z0-9-]*". See <getopt_create_patterns>.
 } getopt_option_type_t;
 
+/**
+ * Flags that can be set on a context with <getopt_set_flags> to change how options are parsed.
+ */
+typedef enum getopt_flags
+{
+	GETOPT_FLAG_NONE                = 0,      ///< Default behaviour, only exact long option-names are matched.
+	GETOPT_FLAG_ALLOW_ABBREVIATIONS = 1 << 0, ///< Long options can be abbreviated to any unique prefix, i.e. --verb will match --verbose.
+	GETOPT_FLAG_LAZY_VALUES         = 1 << 1, ///< Arguments to options with typed values, int, float, enum, bitmask, size, duration, rate, hex, base64 and
+	                                          ///< pattern, are not converted by getopt_next(), current_value is not set and invalid values are not reported.
+	                                          ///< Used when values are converted on access, see getopt_store.h and getopt_store_check().
+	GETOPT_FLAG_STRICT_TEXT         = 1 << 2  ///< Unknown option-names, non-options and arguments to string-options need to be valid UTF-8, see
+	                                          ///< <getopt_set_normalizer>.
+	                                          ///< getopt_next() returns '!' for invalid text with the offset of the first invalid byte in current_value.u64.
+} getopt_flags_t;
+
 /**
  * Helper-macro to define end-element in options-array.
  * Mostly helpful on higher warning-level where compiler would complain for { 0 }
  */
-#define GETOPT_OPTIONS_END { 0, 0, GETOPT_OPTION_TYPE_NO_ARG, 0, 0, 0, 0 }
+#define GETOPT_OPTIONS_END { 0, 0, GETOPT_OPTION_TYPE_NO_ARG, 0, 0, 0, 0, 0, 0 }
 
 /**
  * Option definition in system.
@@ -110,8 +214,339 @@ typedef struct getopt_option
 	int                  value;      ///< If option is of flag-type, this value will be set/and:ed/or:ed to the flag, else it will be returned from getopt_next when option is found.
 	const char*          desc;       ///< Description of option, used when generating help-text.
 	const char*          value_desc; ///< Short description of valid values to the option, will only be used when generating help-text. example: "--my_option=<value_desc>"
+	const char*          aliases;    ///< Other long names of the option separated by '|', i.e. "colour|color". Names starting with '~' are deprecated, using
+	                                 ///< them is reported to the callback set with getopt_set_deprecated_callback(). NULL if none.
+	int                  negatable;  ///< If set on an option of flag-type "--no-<name>" is accepted as well and undoes the flag-operation, FLAG_SET sets
+	                                 ///< flag to 0, FLAG_OR clears the bits in value and FLAG_AND sets the bits not in value.
+	                                 ///< aliases and negatable were added after the other fields, lists written before them need "0x0, 0" at the
+	                                 ///< end of each entry to build with -Wmissing-field-initializers.
 } getopt_option_t;
 
+/**
+ * One key in a lookup-index, a long name or an alias of an option.
+ */
+typedef struct getopt_index_entry
+{
+	const char*            name;       ///< Name of the key, ends with '\0' or '|' since aliases point into getopt_option_t.aliases.
+	const getopt_option_t* opt;        ///< Option that the key resolves to.
+	int                    deprecated; ///< Set if the key is a deprecated alias.
+} getopt_index_entry_t;
+
+/**
+ * Called by getopt_next() when an option is given by a deprecated alias.
+ *
+ * @param opt      Option the alias resolved to.
+ * @param token    Token from argv that used the alias, i.e. "--color=red".
+ * @param userdata userdata passed to getopt_set_deprecated_callback().
+ */
+typedef void (*getopt_deprecated_func)( const getopt_option_t* opt, const char* token, void* userdata );
+
+/**
+ * Called by getopt_next() with GETOPT_FLAG_STRICT_TEXT set to normalize, i.e. to NFC, an argument to a string-option
+ * that is valid UTF-8 and not only ascii.
+ *
+ * @param str      Argument to normalize, not NUL-terminated.
+ * @param len      Length of str in bytes.
+ * @param out      Buffer to write the normalized string to, NULL if there is no space left.
+ * @param out_size Size of out in bytes.
+ * @param userdata userdata passed to getopt_set_normalizer().
+ *
+ * @return length of the normalized string, without terminating NUL, even if it did not fit in out.
+ */
+typedef size_t (*getopt_normalize_func)( const char* str, size_t len, char* out, size_t out_size, void* userdata );
+
+/**
+ * Helper-macro to define end-element in subcommands-array.
+ */
+#define GETOPT_SUBCOMMANDS_END { 0, 0, 0, 0 }
+
+/**
+ * Subcommand definition, used for git-style command lines where global options are followed by a subcommand
+ * that has its own options, i.e. "tool --verbose build --target=x".
+ */
+typedef struct getopt_subcommand
+{
+	const char*            name;  ///< Name of subcommand, i.e. "build".
+	const getopt_option_t* opts;  ///< Options valid after the subcommand, ends with GETOPT_OPTIONS_END as for getopt_create_context().
+	int                    value; ///< Value to identify subcommand by, not used by getopt.
+	const char*            desc;  ///< Description of subcommand.
+} getopt_subcommand_t;
+
+/**
+ * Types of constraints between options, see <getopt_constraint_t>.
+ */
+typedef enum getopt_constraint_type
+{
+	GETOPT_CONSTRAINT_REQUIRED,  ///< All options in 'options' need to be given.
+	GETOPT_CONSTRAINT_EXCLUSIVE, ///< At most one of the options in 'options' can be given.
+	GETOPT_CONSTRAINT_REQUIRES,  ///< If any option in 'options' is given, all options in 'targets' need to be given.
+	GETOPT_CONSTRAINT_ONCE       ///< Each option in 'options' can be given at most once.
+} getopt_constraint_type_t;
+
+/**
+ * Helper-macro to define end-element in constraints-array.
+ */
+#define GETOPT_CONSTRAINTS_END { GETOPT_CONSTRAINT_REQUIRED, 0, 0 }
+
+/**
+ * Constraint between options, declared in an array next to the options-list.
+ *
+ * @example
+ *
+ *   const getopt_constraint_t constraints[] =
+ *   {
+ *       { GETOPT_CONSTRAINT_REQUIRED,  "input",     0x0 },
+ *       { GETOPT_CONSTRAINT_EXCLUSIVE, "fast|safe", 0x0 },
+ *       { GETOPT_CONSTRAINT_REQUIRES,  "tls-key",   "tls" },
+ *       GETOPT_CONSTRAINTS_END
+ *   };
+ */
+typedef struct getopt_constraint
+{
+	getopt_constraint_type_t type;    ///< Type of constraint.
+	const char*              options; ///< '|'-separated list of long option-names that the constraint apply to.
+	const char*              targets; ///< '|'-separated list of long option-names required by GETOPT_CONSTRAINT_REQUIRES, NULL for other types.
+} getopt_constraint_t;
+
+/**
+ * Number of 64-bit words needed by <getopt_create_constraints> for a context with num_opts options and
+ * num_constraints constraints.
+ */
+#define GETOPT_CONSTRAINT_WORDS( num_opts, num_constraints ) ( ( ( (num_opts) + 63 ) / 64 ) * ( 2 * (num_constraints) + 2 ) )
+
+/**
+ * Constraints compiled to bitmasks over the options in a context, created by <getopt_create_constraints>.
+ *
+ * @note: Do not modify data in this struct manually!
+ */
+typedef struct getopt_constraint_set
+{
+	const getopt_constraint_t* constraints;     ///< Internal variable, constraints passed to getopt_create_constraints().
+	int                        num_constraints; ///< Internal variable, number of constraints.
+	int                        num_words;       ///< Internal variable, number of 64-bit words per bitset.
+	unsigned long long*        masks;           ///< Internal variable, 'options'- and 'targets'-mask per constraint.
+	unsigned long long*        seen;            ///< Internal variable, bit per option that was found by getopt_next().
+	unsigned long long*        repeated;        ///< Internal variable, bit per option that was found more than once.
+} getopt_constraint_set_t;
+
+/**
+ * Constraint that was violated, reported by <getopt_check_constraints>.
+ */
+typedef struct getopt_violation
+{
+	const getopt_constraint_t* constraint; ///< Constraint that was violated.
+	const getopt_option_t*     opt;        ///< First option that was missing, given together with another exclusive option or given more than once.
+} getopt_violation_t;
+
+/**
+ * Limits on the work getopt_next() may do for one command line, used when parsing untrusted input.
+ * A limit set to 0 is not checked. See <getopt_set_limits>.
+ */
+typedef struct getopt_limits
+{
+	int           max_tokens;      ///< Max number of tokens in argv that will be parsed.
+	size_t        max_token_len;   ///< Max length of one token.
+	size_t        max_total_bytes; ///< Max sum of the length of all tokens.
+	unsigned long max_ops;         ///< Max number of operations, each char in a token and each option compared against is one operation.
+	                               ///< An abbreviation is charged by the names compared when it is looked up.
+} getopt_limits_t;
+
+/**
+ * Checks done on a path in a path-batch, see <getopt_create_path_batch>.
+ */
+typedef enum getopt_path_check
+{
+	GETOPT_PATH_CHECK_EXISTS   = 1 << 0, ///< The path has to exist.
+	GETOPT_PATH_CHECK_FILE     = 1 << 1, ///< The path has to be a regular file.
+	GETOPT_PATH_CHECK_DIR      = 1 << 2, ///< The path has to be a directory.
+	GETOPT_PATH_CHECK_READABLE = 1 << 3  ///< The path has to be readable by the process.
+} getopt_path_check_t;
+
+/**
+ * One path in a path-batch, added by getopt_next() for PATH options or by <getopt_add_path>.
+ */
+typedef struct getopt_path
+{
+	const char*            path;   ///< Path to check.
+	const getopt_option_t* opt;    ///< Option the path was given to, NULL for paths added with getopt_add_path().
+	unsigned int           checks; ///< GETOPT_PATH_CHECK_-flags to check.
+	unsigned int           failed; ///< Set by getopt_check_paths(), the GETOPT_PATH_CHECK_-flag that failed or 0 if all checks passed.
+	int                    error;  ///< Set by getopt_check_paths(), errno from stat() or access() if that failed, otherwise 0.
+} getopt_path_t;
+
+#if !defined(GETOPT_GLOB_MAX_DEPTH)
+#  define GETOPT_GLOB_MAX_DEPTH 32   ///< Max number of directory-levels below the start of a glob-pattern, one open directory per level.
+#endif
+#if !defined(GETOPT_GLOB_PATH_MAX)
+#  define GETOPT_GLOB_PATH_MAX  4096 ///< Max length of a path produced by glob-expansion.
+#endif
+
+/**
+ * One directory being traversed by glob-expansion.
+ */
+typedef struct getopt_glob_level
+{
+	int          fd;          ///< Internal variable, the open directory.
+	const char** entries;     ///< Internal variable, names in the directory sorted by strcmp(), each prefixed by a char for the type.
+	int          num_entries; ///< Internal variable, number of names in 'entries'.
+	int          pos;         ///< Internal variable, next entry to visit.
+	size_t       path_len;    ///< Internal variable, length of path up to the names in this directory.
+	char*        names_top;   ///< Internal variable, top of the name-stack before the directory was read.
+} getopt_glob_level_t;
+
+/**
+ * State of glob-expansion, see <getopt_create_glob>.
+ */
+typedef struct getopt_glob
+{
+	char*               names_top;   ///< Internal variable, names are stored upwards from the start of the buffer.
+	const char**        entries_top; ///< Internal variable, pointers to names are stored downwards from the end of the buffer.
+	const char**        entries_end; ///< Internal variable, end of the buffer.
+	const char*         token;       ///< Internal variable, token being expanded.
+	const char*         pattern;     ///< Internal variable, part of token after the directory expansion starts in.
+	size_t              root_len;    ///< Internal variable, length of the directory expansion starts in, in 'path'.
+	int                 follow;      ///< Internal variable, set if symlinks to directories are followed, when there is no "**".
+	int                 depth;       ///< Internal variable, number of open levels, 0 when no token is being expanded.
+	int                 num_matches; ///< Internal variable, paths produced for 'token' so far.
+	getopt_glob_level_t levels[GETOPT_GLOB_MAX_DEPTH]; ///< Internal variable, directories being traversed.
+	char                path[GETOPT_GLOB_PATH_MAX];    ///< Internal variable, current path, returned in current_opt_arg.
+} getopt_glob_t;
+
+#if !defined(GETOPT_PATTERN_MAX_STATES)
+#  define GETOPT_PATTERN_MAX_STATES 256 ///< Max number of states in the DFA of a pattern, see <getopt_create_patterns>.
+#endif
+
+/**
+ * Pattern of a PATTERN option compiled to a DFA by <getopt_create_patterns>.
+ *
+ * @note: Do not modify data in this struct manually!
+ */
+typedef struct getopt_pattern
+{
+	const getopt_option_t* opt;             ///< Option the pattern belongs to.
+	int                    num_states;      ///< Internal variable, number of states, 0 is the state that never match and 1 the start-state.
+	int                    num_classes;     ///< Internal variable, number of byte-classes, bytes that the pattern treat the same share a class.
+	int                    accepts_empty;   ///< Internal variable, 1 if the pattern matches "".
+	unsigned char          byte_class[256]; ///< Internal variable, class of each byte.
+	const unsigned short*  next;            ///< Internal variable, next state per state and class, high bit set if that state accepts. NULL if the pattern has to many states.
+} getopt_pattern_t;
+
+/**
+ * 128-bit fingerprint of a command line, see <getopt_fingerprint>.
+ */
+typedef struct getopt_fingerprint
+{
+	unsigned long long lo; ///< Low 64 bits, can be used alone as a 64-bit hash.
+	unsigned long long hi; ///< High 64 bits.
+} getopt_fingerprint_t;
+
+/**
+ * Occurrences of one option in argv, see <getopt_create_query_index>.
+ */
+typedef struct getopt_occurrence
+{
+	int         count;        ///< Number of times the option was found.
+	int         first;        ///< Index in argv of the first occurrence, -1 if option was not found.
+	int         last;         ///< Index in argv of the last occurrence, -1 if option was not found.
+	const char* first_arg;    ///< Argument to the first occurrence, NULL if there was none.
+	const char* last_arg;     ///< Argument to the last occurrence, NULL if there was none.
+	int         last_negated; ///< Index in argv of the last "--no-<name>" of a negatable option, -1 if there was none.
+} getopt_occurrence_t;
+
+/**
+ * Value of an option converted to the type of the option, see <getopt_convert_value>.
+ */
+typedef union getopt_typed_value
+{
+	/**
+	 * if the option is on type GETOPT_OPTION_TYPE_OPTIONAL_INT or GETOPT_OPTION_TYPE_REQUIRED_INT and it parsed
+	 * successfully the value will be stored here.
+	 * supported int formats are, decimal, hex and octal (123, 0x123, 0123)
+	 */
+	int   i32;
+
+	/**
+	 * if the option is on type GETOPT_OPTION_TYPE_OPTIONAL_FP32 or GETOPT_OPTION_TYPE_REQUIRED_FP32 and it parsed
+	 * successfully the value will be stored here.
+	 */
+	float fp32;
+
+	/**
+	 * if the option is on type GETOPT_OPTION_TYPE_REQUIRED_ENUM the index of the name in value_desc is stored in i32.
+	 * if the option is on type GETOPT_OPTION_TYPE_REQUIRED_BITMASK bit n is set here for each name with index n in
+	 * value_desc. Names are compared case-sensitive, on an invalid name the valid names are found in
+	 * current_opt->value_desc.
+	 */
+	unsigned int u32;
+
+	/**
+	 * if the option is on type GETOPT_OPTION_TYPE_REQUIRED_SIZE, GETOPT_OPTION_TYPE_REQUIRED_DURATION or
+	 * GETOPT_OPTION_TYPE_REQUIRED_RATE and it parsed successfully the value will be stored here, sizes in bytes,
+	 * durations in nanoseconds and rates in amount per second.
+	 * A value is a decimal number with an optional fraction followed by an optional unit. Valid units are:
+	 * - size and rate: B, k/K/kB/KB, M/MB, G/GB, T/TB, P/PB, E/EB as powers of 1000 and Ki/KiB, Mi/MiB, Gi/GiB,
+	 *   Ti/TiB, Pi/PiB, Ei/EiB as powers of 1024. A rate can end with "/s".
+	 * - duration: ns, us, ms, s, m, h, d.
+	 * Values that do not fit in 64 bits are invalid.
+	 *
+	 * if the option is on type GETOPT_OPTION_TYPE_REQUIRED_PATTERN and getopt_next() return '!' because the argument
+	 * do not match the offset of the first char that could not be matched is stored here. Nothing is stored for a
+	 * matching argument, the argument itself is the value.
+	 *
+	 * if the option is on type GETOPT_OPTION_TYPE_REQUIRED_HEX or GETOPT_OPTION_TYPE_REQUIRED_BASE64 the number of
+	 * decoded bytes is stored here, or when getopt_next() return '!' for an invalid value the offset in the
+	 * argument of the first invalid char.
+	 */
+	unsigned long long u64;
+} getopt_typed_value_t;
+
+/**
+ * One options-list registered in a <getopt_registry_t>.
+ */
+typedef struct getopt_registry_table
+{
+	const getopt_option_t* opts;     ///< Options-list passed to getopt_registry_add(), not copied.
+	int                    first;    ///< Position of the first option in the list among all options in the registry.
+	int                    num_opts; ///< Number of options in the list.
+} getopt_registry_table_t;
+
+/**
+ * Chains several options-lists, i.e. one per plugin, into one set of options without copying them. The lookup-index
+ * over long names is kept sorted as lists are added, see <getopt_registry_add>, and a context created with
+ * <getopt_create_context_registry> parses options from all lists.
+ *
+ * Options are numbered in registration-order, use <getopt_option_at> and <getopt_option_index> instead of
+ * indexing ctx->opts when working with a context created from a registry.
+ *
+ * @example
+ *
+ *   getopt_registry_table_t tables[MAX_PLUGINS];
+ *   getopt_index_entry_t    index[MAX_OPTIONS];
+ *   getopt_registry_t registry;
+ *   getopt_registry_init( &registry, tables, MAX_PLUGINS, index, MAX_OPTIONS );
+ *   getopt_registry_add( &registry, core_option_list, 0x0 );
+ *
+ *   const getopt_option_t* conflict;
+ *   if( getopt_registry_add( &registry, plugin->option_list, &conflict ) < 0 )
+ *       printf( "plugin %s: can't register --%s\n", plugin->name, conflict ? conflict->name : "" );
+ *
+ *   getopt_context_t ctx;
+ *   getopt_create_context_registry( &ctx, argc, argv, &registry );
+ *
+ * @note: Do not modify data in this struct manually!
+ */
+typedef struct getopt_registry
+{
+	getopt_registry_table_t* tables;          ///< Registered options-lists in registration-order.
+	int                      num_tables;      ///< Number of valid entries in 'tables'.
+	int                      tables_size;     ///< Internal variable, number of entries that fit in 'tables'.
+	getopt_index_entry_t*    index;           ///< Internal variable, long names and aliases of all lists sorted by name.
+	int                      index_count;     ///< Internal variable, number of valid entries in 'index'.
+	int                      index_size;      ///< Internal variable, number of entries that fit in 'index'.
+	int                      num_opts;        ///< Number of options in all lists.
+	const getopt_option_t*   short_opts[256]; ///< Internal variable, option per short name.
+} getopt_registry_t;
+
 /**
  * Context used while parsing options.
  * Need to be initialized by <getopt_create_context> before usage. If reused a re-initialization by <getopt_create_context> is needed.
@@ -120,11 +555,39 @@ typedef struct getopt_option
  */
 typedef struct getopt_context
 {
-	int                    argc;            ///< Internal variable
-	const char**           argv;            ///< Internal variable
-	const getopt_option_t* opts;            ///< pointer to 'opts' passed in getopt_create_context().
-	int                    num_opts;        ///< number of valid options in 'opts'
-	int                    current_index;   ///< Internal variable
+	int                      argc;            ///< Internal variable
+	const char**             argv;            ///< Internal variable
+	const getopt_option_t*   opts;            ///< pointer to 'opts' passed in getopt_create_context().
+	int                      num_opts;        ///< number of valid options in 'opts'
+	const getopt_registry_t* registry;        ///< Internal variable, registry passed to getopt_create_context_registry(), NULL if none.
+	unsigned short           short_index[256]; ///< Internal variable, index+1 in 'opts' of the first option per short name, 0 if none.
+	int                      current_index;   ///< Internal variable
+	unsigned int             flags;           ///< Internal variable, flags set with getopt_set_flags().
+	const getopt_index_entry_t* index;        ///< Internal variable, lookup-index created by getopt_create_index(), NULL if none.
+	int                      index_size;      ///< Internal variable, number of valid entries in 'index'.
+	getopt_deprecated_func   deprecated_func; ///< Internal variable, callback set with getopt_set_deprecated_callback(), NULL if none.
+	void*                    deprecated_userdata; ///< Internal variable, userdata to deprecated_func.
+	getopt_occurrence_t*     occurrences;     ///< Internal variable, query-index created by getopt_create_query_index(), NULL if none.
+	int                      query_index;     ///< Internal variable, index of first token in argv not yet recorded in 'occurrences'.
+	getopt_constraint_set_t* constraints;     ///< Internal variable, constraints created by getopt_create_constraints(), NULL if none.
+	const getopt_limits_t*   limits;          ///< Internal variable, limits set with getopt_set_limits(), NULL if none.
+	size_t                   used_bytes;      ///< Internal variable, bytes parsed, counted against limits->max_total_bytes.
+	unsigned long            used_ops;        ///< Internal variable, operations used, counted against limits->max_ops.
+	int                      token_base;      ///< Internal variable, tokens parsed by the parent of a subcommand-context, counted against limits->max_tokens.
+	getopt_path_t*           paths;           ///< Internal variable, path-batch created by getopt_create_path_batch(), NULL if none.
+	int                      paths_size;      ///< Internal variable, number of entries that fit in 'paths'.
+	int                      num_paths;       ///< Internal variable, number of paths added to the batch, might be more than paths_size.
+	getopt_glob_t*           glob;            ///< Internal variable, glob-state given to getopt_create_glob(), NULL if non-options are not expanded.
+	unsigned char*           blob_buffer;     ///< Internal variable, buffer set with getopt_set_blob_buffer(), NULL if none.
+	size_t                   blob_size;       ///< Internal variable, size of blob_buffer.
+	size_t                   blob_used;       ///< Internal variable, bytes of blob_buffer used by decoded values.
+	getopt_normalize_func    normalize_func;  ///< Internal variable, callback set with getopt_set_normalizer(), NULL if none.
+	void*                    normalize_userdata; ///< Internal variable, userdata to normalize_func.
+	char*                    text_buffer;     ///< Internal variable, buffer for normalized arguments set with getopt_set_normalizer().
+	size_t                   text_size;       ///< Internal variable, size of text_buffer.
+	size_t                   text_used;       ///< Internal variable, bytes of text_buffer used by normalized arguments.
+	const getopt_pattern_t*  patterns;        ///< Internal variable, patterns compiled by getopt_create_patterns(), NULL if none.
+	int                      num_patterns;    ///< Internal variable, number of entries in 'patterns'.
 
 	/**
 	 * Used to return values. Will point to a string that is the argument to the currently parsed option.
@@ -132,7 +595,13 @@ typedef struct getopt_context
 	 * 
 	 * If the option is of type GETOPT_OPTION_TYPE_OPTIONAL this will be set to NULL if there was no argument passed.
 	 */
-	const char*            current_opt_arg;
+	const char*              current_opt_arg;
+
+	/**
+	 * Option found by the last call to getopt_next(), also set when '!' is returned because of an invalid value
+	 * or missing argument. NULL if the token was no option or an unknown option.
+	 */
+	const getopt_option_t*   current_opt;
 
 	/**
 	 * Union storeing parsed values if that is requested by the option-type.
@@ -140,21 +609,13 @@ typedef struct getopt_context
 	 *       of the option that failed to parse.
 	 * @note if the option is 'optional' and there was no arg, current_opt_arg will be 0x0.
 	 */
-	union
-	{
-		/**
-		 * if the option is on type GETOPT_OPTION_TYPE_OPTIONAL_INT or GETOPT_OPTION_TYPE_REQUIRED_INT and it parsed
-		 * successfully the value will be stored here.
-		 * supported int formats are, decimal, hex and octal (123, 0x123, 0123)
-		 */
-		int   i32;
-
-		/**
-		 * if the option is on type GETOPT_OPTION_TYPE_OPTIONAL_FP32 or GETOPT_OPTION_TYPE_REQUIRED_FP32 and it parsed
-		 * successfully the value will be stored here.
-		 */
-		float fp32;
-	} current_value;
+	getopt_typed_value_t     current_value;
+
+	/**
+	 * Decoded bytes of a HEX or BASE64 option, current_value.u64 bytes long, stored in the buffer set with
+	 * getopt_set_blob_buffer(). NULL if there is no buffer or the bytes did not fit in it.
+	 */
+	const unsigned char*     current_blob;
 
 } getopt_context_t;
 
@@ -168,7 +629,201 @@ typedef struct getopt_context
  *
  * @return 0 on success, otherwise error-code.
  */
-int getopt_create_context( getopt_context_t* ctx, int argc, const char** argv, const getopt_option_t* opts );
+GETOPT_API int getopt_create_context( getopt_context_t* ctx, int argc, const char** argv, const getopt_option_t* opts );
+
+/**
+ * Initializes a registry without options.
+ *
+ * @param registry    Registry to initialize.
+ * @param tables      Memory to store registered options-lists in, need to be valid as long as the registry is used.
+ * @param tables_size Number of entries that fit in 'tables', max number of options-lists that can be added.
+ * @param index       Memory to store the lookup-index in, need to be valid as long as the registry is used. Need to
+ *                    fit all long names and aliases, with room for the names of the largest list on top of that a
+ *                    list is merged into the index in O(num_opts), otherwise the index is sorted again.
+ * @param index_size  Number of entries that fit in 'index'.
+ *
+ * @return 0 on success, otherwise error-code.
+ */
+GETOPT_API int getopt_registry_init( getopt_registry_t* registry, getopt_registry_table_t* tables, int tables_size, getopt_index_entry_t* index, int index_size );
+
+/**
+ * Add an options-list to registry. The list is not copied and need to be valid as long as the registry is used.
+ * Nothing is added if any option is invalid as for <getopt_create_context>, has a long or short name that is
+ * already used as long name or alias, by another list or in the same list, or if tables or index is full.
+ *
+ * @param registry Pointer to a initialized <getopt_registry_t>.
+ * @param opts     Options-list to add, ends with GETOPT_OPTIONS_END as for <getopt_create_context>.
+ * @param conflict Set to the option in opts that could not be added, NULL if the error was not caused by one
+ *                 option. Can be NULL.
+ *
+ * @return 0 on success, -1 on error.
+ */
+GETOPT_API int getopt_registry_add( getopt_registry_t* registry, const getopt_option_t* opts, const getopt_option_t** conflict );
+
+/**
+ * Initializes a context that parses the options of all options-lists added to registry. The registry need to be
+ * valid, and no lists added to it, as long as the context is used.
+ *
+ * @param ctx      Pointer to context to initialize.
+ * @param argc     argc from "int main(int argc, char** argv)" or equal.
+ * @param argv     argv from "int main(int argc, char** argv)" or equal.
+ * @param registry Pointer to a initialized <getopt_registry_t>.
+ *
+ * @return 0 on success, otherwise error-code.
+ */
+GETOPT_API int getopt_create_context_registry( getopt_context_t* ctx, int argc, const char** argv, const getopt_registry_t* registry );
+
+/**
+ * Get option by its position among all options in ctx, works for contexts created from a registry as well.
+ *
+ * @param ctx       Pointer to a initialized <getopt_context_t>
+ * @param opt_index Position of option, 0 to ctx->num_opts - 1.
+ *
+ * @return the option.
+ */
+GETOPT_API const getopt_option_t* getopt_option_at( const getopt_context_t* ctx, int opt_index );
+
+/**
+ * Get position of an option among all options in ctx, the inverse of <getopt_option_at>. Used to index per-option
+ * data such as the values of a value-store.
+ *
+ * @param ctx Pointer to a initialized <getopt_context_t>
+ * @param opt Option in ctx.
+ *
+ * @return position of opt, -1 if opt is not an option in ctx.
+ */
+GETOPT_API int getopt_option_index( const getopt_context_t* ctx, const getopt_option_t* opt );
+
+/**
+ * Set flags that changes how options are parsed, see <getopt_flags_t>.
+ *
+ * @param ctx   Pointer to a initialized <getopt_context_t>
+ * @param flags Flags to set, or:ed together values from <getopt_flags_t>.
+ */
+GETOPT_API void getopt_set_flags( getopt_context_t* ctx, unsigned int flags );
+
+/**
+ * Set callback to call when getopt_next() finds an option given by a deprecated alias, see getopt_option_t.aliases.
+ *
+ * @param ctx      Pointer to a initialized <getopt_context_t>
+ * @param func     Callback, NULL to remove it.
+ * @param userdata Passed to func.
+ */
+GETOPT_API void getopt_set_deprecated_callback( getopt_context_t* ctx, getopt_deprecated_func func, void* userdata );
+
+/**
+ * Limit the work that getopt_next() may do, when a limit is exceeded getopt_next() returns '#' and then -1.
+ * Each token is checked against the limits before it is parsed, so the work for a token is bounded by
+ * max_token_len even if the token is longer and the operations a lookup might need are counted before the
+ * lookup is done. Short options are found in a table and cost O(token length). With an index, see
+ * <getopt_create_index>, a long option cost O(token length * log(num_opts)) operations, without one the options-list
+ * is scanned and a long option cost O(token length + num_opts). Limits are only independent of the size of the
+ * options-list with an index, so parsing untrusted input with a large options-list need one. Abbreviations, see
+ * GETOPT_FLAG_ALLOW_ABBREVIATIONS, are charged by the names compared when they are looked up.
+ *
+ * @note: '#' was added as a return value with the limits, options with value '#' are rejected by
+ *        getopt_create_context() as '!', '?' and '+' always have been. This breaks options-lists that used '#' as
+ *        value of an option, i.e. for a "-#" progress-flag, give such an option another value.
+ *
+ * @param ctx    Pointer to a initialized <getopt_context_t>
+ * @param limits Limits to use, need to be valid as long as ctx is used. NULL to remove limits.
+ */
+GETOPT_API void getopt_set_limits( getopt_context_t* ctx, const getopt_limits_t* limits );
+
+/**
+ * Set callback used to normalize arguments to string-options when GETOPT_FLAG_STRICT_TEXT is set, getopt does not
+ * carry the unicode-tables needed for normalization itself. Only arguments that contain non-ascii chars are passed
+ * to func, ascii is already normalized, and an argument that func leaves unchanged is not copied. Normalized
+ * arguments are stored NUL-terminated in buffer and current_opt_arg points to the copy. If buffer is full
+ * getopt_next() returns '#', as for an exceeded limit.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param func        Callback, NULL to only validate.
+ * @param userdata    Passed to func.
+ * @param buffer      Buffer to store normalized arguments in.
+ * @param buffer_size Size of buffer in bytes.
+ */
+GETOPT_API void getopt_set_normalizer( getopt_context_t* ctx, getopt_normalize_func func, void* userdata, char* buffer, size_t buffer_size );
+
+/**
+ * Validate that str is UTF-8, overlong encodings, surrogates and code points above U+10FFFF are invalid.
+ * Ascii is checked 16 bytes at a time with SSE2 where available.
+ *
+ * @param str    String to validate.
+ * @param len    Length of str in bytes.
+ * @param offset Set to the offset of the first byte of the first invalid sequence if str is invalid.
+ *
+ * @return 0 if str is valid, -1 if not.
+ */
+GETOPT_API int getopt_validate_utf8( const char* str, size_t len, size_t* offset );
+
+#if !defined(GETOPT_NO_BLOB)
+/**
+ * Set buffer that getopt_next() decodes the arguments of HEX and BASE64 options into, values are stored one after
+ * the other and are valid as long as the buffer. Without a buffer, or if a value do not fit in what is left of it,
+ * the value is only validated and the caller can decode it with <getopt_decode_blob>.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param buffer      Buffer to decode into, NULL to only validate.
+ * @param buffer_size Size of buffer in bytes.
+ */
+GETOPT_API void getopt_set_blob_buffer( getopt_context_t* ctx, void* buffer, size_t buffer_size );
+
+/**
+ * Decode the argument of a HEX or BASE64 option. The decoded size is at most strlen(str) / 2 for HEX and
+ * strlen(str) / 4 * 3 + 2 for BASE64, with 'out' set to NULL str is only validated.
+ *
+ * @param opt      Option of type GETOPT_OPTION_TYPE_REQUIRED_HEX or GETOPT_OPTION_TYPE_REQUIRED_BASE64.
+ * @param str      Value to decode.
+ * @param out      Buffer to decode into, can be NULL.
+ * @param out_size Size of out in bytes.
+ * @param result   Set to the number of decoded bytes on success or if out is to small, and to the offset in str of
+ *                 the first invalid char if str is invalid.
+ *
+ * @return 0 on success, -1 if str is invalid or opt is of another type, -2 if str is valid but do not fit in out.
+ */
+GETOPT_API int getopt_decode_blob( const getopt_option_t* opt, const char* str, void* out, size_t out_size, size_t* result );
+#endif /* !defined(GETOPT_NO_BLOB) */
+
+/**
+ * Creates an index over all long option-names and aliases in ctx, sorted by name, that will be used to find long
+ * options when parsing. With an index lookup of an option cost O(log(num_opts)) string-compares instead of a linear
+ * scan over all options and all options sharing a prefix will be stored next to each other.
+ *
+ * @param ctx        Pointer to a initialized <getopt_context_t>
+ * @param index      Memory to store index in, need to be valid as long as ctx is used. Need to fit one entry per long
+ *                   name and alias.
+ * @param index_size Number of entries that fit in 'index'.
+ *
+ * @return 0 on success, -1 if index is to small or if two options share the same long name or alias.
+ */
+GETOPT_API int getopt_create_index( getopt_context_t* ctx, getopt_index_entry_t* index, int index_size );
+
+/**
+ * Find the option with long name or alias 'name'. Name is compared case-insensitive.
+ *
+ * @param ctx      Pointer to a initialized <getopt_context_t>
+ * @param name     Name to search for, without leading "--".
+ * @param name_len Number of chars in name to use.
+ *
+ * @return found option or NULL if there is no option with that name.
+ */
+GETOPT_API const getopt_option_t* getopt_lookup_long( const getopt_context_t* ctx, const char* name, size_t name_len );
+
+/**
+ * Find all options where the long name or an alias starts with 'prefix'. This can be used to list the candidates when
+ * an abbreviated option was ambiguous, in that case getopt_next() will return '?'.
+ *
+ * @param ctx        Pointer to a initialized <getopt_context_t>
+ * @param prefix     Prefix to search for, without leading "--".
+ * @param prefix_len Number of chars in prefix to use.
+ * @param matches    Array to store found options in, can be NULL if matches_size is 0. If ctx has an index
+ *                   matches will be sorted by name, otherwise they are returned in the order in the options-list.
+ * @param matches_size Number of entries that fit in 'matches'.
+ *
+ * @return total number of options matching prefix, this might be more than matches_size.
+ */
+GETOPT_API int getopt_lookup_prefix( const getopt_context_t* ctx, const char* prefix, size_t prefix_len, const getopt_option_t** matches, int matches_size );
 
 /**
  * Used to parse argc/argv with the help of a getopt_context_t.
@@ -179,13 +834,302 @@ int getopt_create_context( getopt_context_t* ctx, int argc, const char** argv, c
  * @return '!' on error. ctx->current_opt_arg will be set to flag-name! Errors that can occur,
  *             Argument missing if argument is required or Argument found when there should be none.
  *         '?' if item was an unrecognized option, ctx->current_opt_arg will be set to item!
+ *             This is also returned if GETOPT_FLAG_ALLOW_ABBREVIATIONS is set and item was an ambiguous abbreviation.
  *         '+' if item was no option, ctx->current_opt_arg will be set to item!
  *         '0' if the opt was a flag and it was set. ctx->current_opt_arg will be set to flag-name!
  *             the value stored is value in the found option.
+ *         '#' if a limit set with getopt_set_limits() was exceeded, ctx->current_opt_arg will be set to the token
+ *             that exceeded it. Also returned when the buffer set with getopt_set_normalizer() is full, with
+ *             current_opt_arg set to the argument. The rest of argv is not parsed. As '#' is returned options
+ *             can not have '#' as value, see <getopt_set_limits>.
  *         -1 no more options to parse!
 */
-int getopt_next( getopt_context_t* ctx );
+GETOPT_API int getopt_next( getopt_context_t* ctx );
+
+/**
+ * Give ctx memory for an index over the options in argv, used by <getopt_find>, <getopt_last> and <getopt_count>.
+ * The index is built lazily by the queries, each token in argv is parsed at most once and a query only parses
+ * as many tokens as it needs to be answered, after that the same query is a lookup. Without an index each
+ * query parses argv from the start.
+ *
+ * @param ctx              Pointer to a initialized <getopt_context_t>
+ * @param occurrences      Memory to store index in, need to be valid as long as ctx is used.
+ * @param occurrences_size Number of entries that fit in 'occurrences', need to be at least ctx->num_opts.
+ *
+ * @return 0 on success, -1 if occurrences is to small.
+ */
+GETOPT_API int getopt_create_query_index( getopt_context_t* ctx, getopt_occurrence_t* occurrences, int occurrences_size );
+
+/**
+ * Find the first occurrence of an option in argv without a getopt_next()-loop. argv is parsed with the same rules
+ * as getopt_next(), but no flags are written and no values are converted. Parsing stops at the first occurrence.
+ *
+ * @example
+ *
+ *   const char* config;
+ *   if( getopt_find( &ctx, "--config", &config ) >= 0 )
+ *       load_config( config );
+ *
+ * @param ctx  Pointer to a initialized <getopt_context_t>
+ * @param name Option to find, "--long-name" or "-s" for a short name.
+ * @param arg  Set to the argument of the found occurrence or NULL if it had none, can be NULL.
+ *
+ * @return index in argv of the found occurrence, -1 if option is not in argv or if name is not a valid option.
+ */
+GETOPT_API int getopt_find( getopt_context_t* ctx, const char* name, const char** arg );
+
+/**
+ * Find the last occurrence of an option in argv, as <getopt_find> but argv is always parsed to the end.
+ */
+GETOPT_API int getopt_last( getopt_context_t* ctx, const char* name, const char** arg );
+
+/**
+ * Count occurrences of an option in argv, i.e. to get the level of "-v -v -v".
+ *
+ * @param ctx  Pointer to a initialized <getopt_context_t>
+ * @param name Option to count, "--long-name" or "-s" for a short name.
+ *
+ * @return number of times option is found in argv, 0 if name is not a valid option.
+ */
+GETOPT_API int getopt_count( getopt_context_t* ctx, const char* name );
+
+/**
+ * Compile constraints between the options in ctx to bitmasks. While parsing with getopt_next() the options that are
+ * found are recorded in a bitset and when all options are parsed all constraints are checked with a few bitwise
+ * operations per constraint by <getopt_check_constraints>. A negatable flag negated by "--no-<name>" after it was
+ * given counts as not given.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param set         Constraint-set to initialize, need to be valid as long as ctx is used.
+ * @param constraints Array of constraints, ending with GETOPT_CONSTRAINTS_END. Need to be valid as long as ctx is used.
+ * @param words       Memory for bitsets, need to be valid as long as ctx is used.
+ * @param num_words   Number of words in 'words', need to be at least GETOPT_CONSTRAINT_WORDS( ctx->num_opts, num_constraints ).
+ *
+ * @return 0 on success, -1 if 'words' is to small or if a constraint names an option that is not in ctx.
+ */
+GETOPT_API int getopt_create_constraints( getopt_context_t* ctx, getopt_constraint_set_t* set, const getopt_constraint_t* constraints, unsigned long long* words, size_t num_words );
+
+/**
+ * Check all constraints created by <getopt_create_constraints> against the options found so far by getopt_next(),
+ * should be called when getopt_next() has returned -1.
+ *
+ * @param ctx             Pointer to a initialized <getopt_context_t>
+ * @param violations      Array to store violations in, one per violated constraint.
+ * @param violations_size Number of entries that fit in 'violations'.
+ *
+ * @return total number of violated constraints, this might be more than violations_size.
+ */
+GETOPT_API int getopt_check_constraints( const getopt_context_t* ctx, getopt_violation_t* violations, int violations_size );
+
+#if !defined(GETOPT_NO_PATH)
+/**
+ * Defer the checks of PATH options to the end of the parse. Without a path-batch getopt_next() checks the path of
+ * a PATH option with stat() when the option is found and returns '!' if it is invalid, with a batch the path is
+ * added to it and all paths are checked together by <getopt_check_paths>, concurrently on POSIX so that a command
+ * line with many paths on a network filesystem cost about one round-trip instead of one per path.
+ *
+ * @param ctx        Pointer to a initialized <getopt_context_t>
+ * @param paths      Memory for the batch, need to be valid as long as ctx is used. Each path in argv use at least one
+ *                   token so argc entries fit all paths given in argv.
+ * @param paths_size Number of entries that fit in 'paths'.
+ *
+ * @return 0 on success, -1 if paths_size is negative.
+ */
+GETOPT_API int getopt_create_path_batch( getopt_context_t* ctx, getopt_path_t* paths, int paths_size );
+
+/**
+ * Add a path that is not the argument of a PATH option to the path-batch, i.e. a non-option returned as '+'.
+ *
+ * @param ctx    Pointer to a initialized <getopt_context_t> with a path-batch.
+ * @param path   Path to check, need to be valid until getopt_check_paths() is called.
+ * @param checks GETOPT_PATH_CHECK_-flags to check.
+ *
+ * @return 0 on success, -1 if ctx has no path-batch or if it is full.
+ */
+GETOPT_API int getopt_add_path( getopt_context_t* ctx, const char* path, unsigned int checks );
+
+/**
+ * Check all paths in the path-batch, should be called when getopt_next() has returned -1. The result of each path
+ * is stored in its getopt_path_t and the paths that failed are reported in 'failed', in the order they were added.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t> with a path-batch.
+ * @param failed      Array to store the paths that failed any check in.
+ * @param failed_size Number of entries that fit in 'failed'.
+ *
+ * @return total number of paths that failed, this might be more than failed_size. -1 if ctx has no path-batch or
+ *         if more PATH options were found than fit in the batch.
+ */
+GETOPT_API int getopt_check_paths( getopt_context_t* ctx, const getopt_path_t** failed, int failed_size );
+#endif /* !defined(GETOPT_NO_PATH) */
+
+#if !defined(GETOPT_NO_GLOB)
+/**
+ * Expand non-options that are glob-patterns, for programs that are not started by a shell. A non-option containing
+ * '*', '?' or '[' is returned by getopt_next() as one '+' per matching path, in a deterministic order: the entries
+ * of each directory sorted by strcmp(), a directory directly followed by its matching descendants. "**" as a whole
+ * path-component matches any number of directories, '*' and '?' never match a leading '.'. A pattern without
+ * matches is returned as is.
+ *
+ * Memory use is bounded by 'buffer' and 'glob' however large the tree is, only the names of the directories on the
+ * path currently traversed are stored and at most GETOPT_GLOB_MAX_DEPTH directories are open.
+ *
+ * getopt_next() returns '!' with current_opt_arg set to the pattern if a directory do not fit in buffer, a path is
+ * longer than GETOPT_GLOB_PATH_MAX or the tree is deeper than GETOPT_GLOB_MAX_DEPTH, paths produced before that
+ * have already been returned.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param glob        State of the expansion, need to be valid as long as ctx is used.
+ * @param buffer      Memory for the names of directories being traversed, need to be valid as long as ctx is used.
+ * @param buffer_size Size of buffer in bytes.
+ *
+ * @return 0 on success, -1 if buffer is to small to be used.
+ */
+GETOPT_API int getopt_create_glob( getopt_context_t* ctx, getopt_glob_t* glob, void* buffer, size_t buffer_size );
+
+/**
+ * Close the directories of an unfinished glob-expansion, only needed if parsing stops before getopt_next() has
+ * returned -1.
+ *
+ * @param ctx Pointer to a initialized <getopt_context_t> with a glob-state.
+ */
+GETOPT_API void getopt_release_glob( getopt_context_t* ctx );
+#endif /* !defined(GETOPT_NO_GLOB) */
+
+#if !defined(GETOPT_NO_PATTERN)
+/**
+ * Compile the patterns of all PATTERN options in ctx to DFAs, matching an argument is then one table-lookup per
+ * char. Without compiled patterns getopt_next() and getopt_convert_value() match by simulating the automaton of the
+ * pattern, also linear in the length of the argument but with a loop over the pattern per char. Patterns are
+ * validated by getopt_create_context() so errors in them are found when the options are created.
+ *
+ * Patterns always match the whole argument and support:
+ * - literal chars, '.' for any char and '\' to escape one of ".[]()|*+?{}\".
+ * - "\d", "\w" and "\s" for digits, word-chars and whitespace.
+ * - classes as "[a-z_]" and "[^,]".
+ * - groups "( )", alternation '|' and the quantifiers '*', '+' and '?'.
+ * A pattern can have at most 64 chars and classes. A pattern whose DFA would have more than
+ * GETOPT_PATTERN_MAX_STATES states is not compiled and is matched by simulation.
+ *
+ * @param ctx           Pointer to a initialized <getopt_context_t>
+ * @param patterns      Array with one entry per PATTERN option, need to be valid as long as ctx is used.
+ * @param patterns_size Number of entries that fit in 'patterns'.
+ * @param table         Memory for the transition-tables, need to be valid as long as ctx is used. NULL to only get
+ *                      the number of entries needed, ctx is then not changed.
+ * @param table_size    Number of entries that fit in 'table'.
+ *
+ * @return number of entries in table needed by the DFAs, -1 if patterns or table is to small.
+ */
+GETOPT_API int getopt_create_patterns( getopt_context_t* ctx, getopt_pattern_t* patterns, int patterns_size, unsigned short* table, size_t table_size );
+#endif /* !defined(GETOPT_NO_PATTERN) */
+
+/**
+ * Compute a fingerprint of the command line in ctx that is equal for command lines that has the same meaning,
+ * i.e. to use as key in a build-cache. The fingerprint is computed from a canonical form of the command line
+ * that is hashed while it is produced, the canonical form is never built as a string. In the canonical form:
+ * - options are ordered as in the options-list, not as in argv, and short and long names are the same option.
+ * - only the last value of an option with argument is used, as that is the value that the program uses, unless the
+ *   option is in 'accumulate'. All values of such an option are used in the order they are given in, as for
+ *   "-I a -I b" where the program uses all of them.
+ * - int-, float-, enum-, bitmask-, size-, duration- and rate-values are used converted, so "0x10" and "16" or
+ *   "1k" and "1000" are the same value. Hex- and base64-values are used decoded. Values that can not be converted
+ *   are used as is.
+ * - flags are only used as given or not, NO_ARG-options by the number of times they are given. A negatable flag
+ *   is used as on, off or not given, by the last of "--<name>" and "--no-<name>".
+ * - non-options and unknown options are used in the order they are given in.
+ *
+ * A query-index is needed, see <getopt_create_query_index>, it will be rebuilt by this call.
+ * The state of getopt_next() is not changed.
+ *
+ * argv is parsed once, values of accumulating options are hashed as they are found.
+ *
+ * @param ctx        Pointer to a initialized <getopt_context_t> with a query-index.
+ * @param accumulate '|'-separated list of long option-names, as in the options-list, of options where the program
+ *                   uses all values, i.e. "include|define". NULL if the program uses the last value of all options.
+ * @param out        Fingerprint of ctx.
+ *
+ * @return 0 on success, -1 if ctx has no query-index.
+ */
+GETOPT_API int getopt_fingerprint( getopt_context_t* ctx, const char* accumulate, getopt_fingerprint_t* out );
+
+/**
+ * Convert a string to the type of an option with the same rules as getopt_next(), i.e. for values read from
+ * somewhere else than argv.
+ *
+ * @param opt Option that the value belongs to.
+ * @param str Value to convert.
+ * @param out Converted value, see <getopt_typed_value_t> for what member that is set for each option-type.
+ *
+ * @return 0 on success, -1 if str is not a valid value for opt or if opt is not of a type that is converted.
+ */
+GETOPT_API int getopt_convert_value( const getopt_option_t* opt, const char* str, getopt_typed_value_t* out );
+
+/**
+ * Convert the 'len' first chars of str as <getopt_convert_value>, for values that are not NUL-terminated, i.e. values
+ * in a file read to memory. Only int- and float-values are copied, and are invalid if longer than 63 chars, values of
+ * other types are converted in place whatever their length.
+ *
+ * @param opt Option that the value belongs to.
+ * @param str Value to convert, does not need to be NUL-terminated.
+ * @param len Length of str in chars.
+ * @param out Converted value, see <getopt_typed_value_t> for what member that is set for each option-type.
+ *
+ * @return 0 on success, -1 if str is not a valid value for opt or if opt is not of a type that is converted.
+ */
+GETOPT_API int getopt_convert_value_len( const getopt_option_t* opt, const char* str, size_t len, getopt_typed_value_t* out );
+
+/**
+ * Find subcommand with name 'name', usually called with ctx->current_opt_arg when getopt_next() returned '+'.
+ * Names are compared case-sensitive.
+ *
+ * @param subcommands Array of subcommands, ending with GETOPT_SUBCOMMANDS_END.
+ * @param name        Name to search for.
+ *
+ * @return found subcommand or NULL if there is no subcommand with that name.
+ */
+GETOPT_API const getopt_subcommand_t* getopt_find_subcommand( const getopt_subcommand_t* subcommands, const char* name );
+
+/**
+ * Initializes sub_ctx to parse the tokens after the subcommand that was just returned as '+' by getopt_next( ctx ).
+ * The rest of the tokens in ctx is handed over to sub_ctx, the next call to getopt_next( ctx ) will return -1.
+ * Only the option-list of 'subcommand' is validated, so the cost of this is independent of the number of subcommands.
+ * Flags and limits set on ctx are also set on sub_ctx, the work done by ctx is counted against the limits of sub_ctx
+ * so the limits hold for the whole command line.
+ *
+ * @example
+ *
+ *   case '+':
+ *   {
+ *       const getopt_subcommand_t* sub = getopt_find_subcommand( subcommands, ctx.current_opt_arg );
+ *       if( sub && getopt_create_subcommand_context( &ctx, &sub_ctx, sub ) == 0 )
+ *           parse_subcommand( sub->value, &sub_ctx );
+ *   }
+ *
+ * @param ctx        Pointer to a <getopt_context_t> where getopt_next() just returned the subcommand.
+ * @param sub_ctx    Pointer to context to initialize.
+ * @param subcommand Subcommand to parse options for.
+ *
+ * @return 0 on success, otherwise error-code.
+ */
+GETOPT_API int getopt_create_subcommand_context( getopt_context_t* ctx, getopt_context_t* sub_ctx, const getopt_subcommand_t* subcommand );
+
+#if !defined(GETOPT_NO_SUGGEST)
+/**
+ * Find the long options closest to an unrecognized token, i.e. to be able to print "did you mean --verbose?"
+ * when getopt_next() returned '?'. Options are compared case-insensitive by edit-distance, only the first
+ * 64 chars of token is used.
+ *
+ * @param ctx              Pointer to a initialized <getopt_context_t>
+ * @param token            Token to find suggestions for, leading '-' and everything from the first '=' is ignored.
+ * @param max_distance     Max edit-distance between token and an option-name for it to be suggested.
+ * @param suggestions      Array to store suggestions in, sorted with the closest match first.
+ * @param suggestions_size Number of entries that fit in 'suggestions'.
+ *
+ * @return number of suggestions stored in 'suggestions'.
+ */
+GETOPT_API int getopt_suggest( const getopt_context_t* ctx, const char* token, int max_distance, const getopt_option_t** suggestions, int suggestions_size );
+#endif
 
+#if !defined(GETOPT_NO_HELP)
 /**
  * Builds a string that describes all options for use with the --help-flag etc.
  *
@@ -195,7 +1139,69 @@ int getopt_next( getopt_context_t* ctx );
  *
  * @return buffer filled with a help-string.
  */
-const char* getopt_create_help_string( getopt_context_t* ctx, char* buffer, size_t buffer_size );
+GETOPT_API const char* getopt_create_help_string( getopt_context_t* ctx, char* buffer, size_t buffer_size );
+#endif
+
+/**
+ * Argument used by completion-scripts generated by <getopt_create_completion_script> to query completions, see <getopt_complete>.
+ */
+#define GETOPT_COMPLETE_ARG "--getopt-complete"
+
+/**
+ * Shells that completion-scripts can be generated for.
+ */
+typedef enum getopt_shell
+{
+	GETOPT_SHELL_BASH,
+	GETOPT_SHELL_ZSH,
+	GETOPT_SHELL_FISH
+} getopt_shell_t;
+
+#if !defined(GETOPT_NO_COMPLETION)
+/**
+ * Answer a completion-query from a script generated by <getopt_create_completion_script>. Should be called before
+ * parsing options with <getopt_next>. A completion-query is a command line on the form
+ * "prog --getopt-complete=<word_index> <words...>" where word_index is the index of the word under the cursor.
+ *
+ * Option-names are completed as well as values of options of type GETOPT_OPTION_TYPE_REQUIRED_ENUM and
+ * GETOPT_OPTION_TYPE_REQUIRED_BITMASK, with the names in value_desc, both after "--opt=" and "--opt ". For a bitmask
+ * the name after the last ',' is completed.
+ *
+ * Only the word under the cursor and the words just before it is looked at, so answering a query cost the same as a
+ * lookup of an option and a ctx with an index, see <getopt_create_index>, will answer fast even with many options.
+ *
+ * @example
+ *
+ *   if( getopt_complete( &ctx, buffer, sizeof( buffer ) ) >= 0 )
+ *   {
+ *       printf( "%s", buffer );
+ *       return 0;
+ *   }
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param buffer      Pointer to buffer to write completions to, one completion per line. No completions means that
+ *                    the word under the cursor is not an option or a name of a value and the shell should complete
+ *                    it as a file.
+ * @param buffer_size Size of buffer.
+ *
+ * @return -1 if the command line in ctx is not a completion-query, otherwise the number of completions in buffer.
+ */
+GETOPT_API int getopt_complete( getopt_context_t* ctx, char* buffer, size_t buffer_size );
+
+/**
+ * Builds a completion-script for 'shell' completing the options in ctx for 'prog_name'. The bash- and zsh-scripts
+ * query the program itself via <getopt_complete>, the fish-script list all options statically.
+ *
+ * @param ctx         Pointer to a initialized <getopt_context_t>
+ * @param shell       Shell to generate script for.
+ * @param prog_name   Name of the program to complete, as typed in the shell.
+ * @param buffer      Pointer to buffer to build script in.
+ * @param buffer_size Size of buffer.
+ *
+ * @return buffer filled with a completion-script.
+ */
+GETOPT_API const char* getopt_create_completion_script( getopt_context_t* ctx, getopt_shell_t shell, const char* prog_name, char* buffer, size_t buffer_size );
+#endif
 
 #if defined (__cplusplus)
 }
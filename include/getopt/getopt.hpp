@@ -0,0 +1,280 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+#ifndef GETOPT_GETOPT_HPP_INCLUDED
+#define GETOPT_GETOPT_HPP_INCLUDED
+
+#if !( __cplusplus >= 201703L || ( defined(_MSVC_LANG) && _MSVC_LANG >= 201703L ) )
+#  error "getopt.hpp needs C++17, use getopt.h from older versions of C++"
+#endif
+
+#include <getopt/getopt.h>
+
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file getopt.hpp
+ *
+ * Header-only C++17 layer over getopt.h. Everything is inline and only wraps a getopt_context_t and the value
+ * returned by getopt_next(), a loop over a getopt_cpp::context compiles to the same code as the getopt_next()-loop
+ * written in C, see the "next_cpp" phase in bench/getopt_bench.cpp.
+ *
+ * - the context is move-only so it can not be copied by mistake.
+ * - parsing is a range of events, arguments are std::string_view and typed accessors return std::optional.
+ * - option-ids can be an enum class instead of int, the values in the options-list are then the enum-values.
+ *
+ * @example
+ *
+ *   enum class opt : int { help = 'h', input = 'i', threads = 't' };
+ *
+ *   auto ctx = getopt_cpp::basic_context<opt>::create( argc, argv, option_list );
+ *   if( !ctx )
+ *       return 1;
+ *
+ *   for( auto ev : *ctx )
+ *   {
+ *       switch( ev.kind() )
+ *       {
+ *           case getopt_cpp::event_kind::option:
+ *               switch( ev.id() )
+ *               {
+ *                   case opt::input:   open_input( ev.arg() ); break;
+ *                   case opt::threads: threads = ev.arg_as<int>().value_or( 1 ); break;
+ *                   ...
+ *               }
+ *               break;
+ *           case getopt_cpp::event_kind::non_option: add_file( ev.arg() ); break;
+ *           default: report_error( ev.arg() ); break;
+ *       }
+ *   }
+ */
+
+namespace getopt_cpp
+{
+
+/**
+ * What getopt_next() found, from the value it returned.
+ */
+enum class event_kind
+{
+	option,     ///< An option, event::id() is the value of the option.
+	flag,       ///< A flag was set, or an option with value 0 was found.
+	non_option, ///< '+', event::arg() is the token.
+	unknown,    ///< '?', event::arg() is the token.
+	invalid,    ///< '!', event::arg() is the name of the option.
+	limit       ///< '#', a limit was exceeded and the rest of argv is not parsed.
+};
+
+/**
+ * Value to put in getopt_option_t.value for an id of type Id.
+ */
+template <typename Id>
+constexpr int option_value( Id id ) noexcept
+{
+	return static_cast<int>( id );
+}
+
+/**
+ * One result of getopt_next(), only valid until the next event is parsed.
+ */
+template <typename Id = int>
+class event
+{
+public:
+	constexpr event( const getopt_context_t* ctx, int res ) noexcept
+		: m_ctx( ctx )
+		, m_res( res )
+	{}
+
+	constexpr event_kind kind() const noexcept
+	{
+		switch( m_res )
+		{
+			case 0:   return event_kind::flag;
+			case '+': return event_kind::non_option;
+			case '?': return event_kind::unknown;
+			case '!': return event_kind::invalid;
+			case '#': return event_kind::limit;
+			default:  return event_kind::option;
+		}
+	}
+
+	/// value returned by getopt_next() as Id.
+	constexpr Id id() const noexcept { return static_cast<Id>( m_res ); }
+
+	/// value returned by getopt_next().
+	constexpr int raw() const noexcept { return m_res; }
+
+	/// option found, also set for event_kind::invalid when the option is known. NULL otherwise.
+	const getopt_option_t* option() const noexcept { return m_ctx->current_opt; }
+
+	bool has_arg() const noexcept { return m_ctx->current_opt_arg != nullptr; }
+
+	/// current_opt_arg, empty if there is none.
+	std::string_view arg() const noexcept
+	{
+		return m_ctx->current_opt_arg ? std::string_view( m_ctx->current_opt_arg ) : std::string_view();
+	}
+
+	/// current_opt_arg as NUL-terminated string, NULL if there is none.
+	const char* c_str() const noexcept { return m_ctx->current_opt_arg; }
+
+	/// value converted by getopt_next(), see getopt_typed_value_t for what member is set for each option-type.
+	const getopt_typed_value_t& value() const noexcept { return m_ctx->current_value; }
+
+	/**
+	 * Argument converted with std::from_chars(), T is an integer- or floating-point-type. Empty if there is no
+	 * argument or if all of it could not be converted to T.
+	 */
+	template <typename T>
+	std::optional<T> arg_as() const noexcept
+	{
+		static_assert( std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "arg_as() converts to integer- and floating-point-types" );
+
+		std::string_view str = arg();
+		if( str.empty() )
+			return std::nullopt;
+
+		T value{};
+		const char* end = str.data() + str.size();
+		std::from_chars_result res = std::from_chars( str.data(), end, value );
+		if( res.ec != std::errc() || res.ptr != end )
+			return std::nullopt;
+		return value;
+	}
+
+private:
+	const getopt_context_t* m_ctx;
+	int                     m_res;
+};
+
+/**
+ * End of a range of events, reached when getopt_next() returns -1.
+ */
+struct event_sentinel {};
+
+/**
+ * Input-iterator calling getopt_next() on increment.
+ */
+template <typename Id = int>
+class event_iterator
+{
+public:
+	using iterator_category = std::input_iterator_tag;
+	using value_type        = event<Id>;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = void;
+	using reference         = event<Id>;
+
+	event_iterator( getopt_context_t* ctx, int res ) noexcept
+		: m_ctx( ctx )
+		, m_res( res )
+	{}
+
+	event<Id> operator*() const noexcept { return event<Id>( m_ctx, m_res ); }
+
+	event_iterator& operator++() noexcept
+	{
+		m_res = getopt_next( m_ctx );
+		return *this;
+	}
+
+	void operator++( int ) noexcept { ++*this; }
+
+	friend bool operator==( const event_iterator& it, event_sentinel ) noexcept { return it.m_res == -1; }
+	friend bool operator!=( const event_iterator& it, event_sentinel ) noexcept { return it.m_res != -1; }
+	friend bool operator==( event_sentinel, const event_iterator& it ) noexcept { return it.m_res == -1; }
+	friend bool operator!=( event_sentinel, const event_iterator& it ) noexcept { return it.m_res != -1; }
+
+private:
+	getopt_context_t* m_ctx;
+	int               m_res;
+};
+
+/**
+ * Move-only owner of a getopt_context_t, iterating over it parses argv. The context only holds pointers to memory
+ * owned by the caller, options-list, argv and anything given to the getopt_create_*()-functions, so moving it is
+ * cheap and does not invalidate them.
+ */
+template <typename Id = int>
+class basic_context
+{
+public:
+	/**
+	 * @return the context or std::nullopt if getopt_create_context() failed, i.e. on an invalid options-list.
+	 */
+	static std::optional<basic_context> create( int argc, const char** argv, const getopt_option_t* opts ) noexcept
+	{
+		basic_context ctx;
+		if( getopt_create_context( &ctx.m_ctx, argc, argv, opts ) < 0 )
+			return std::nullopt;
+		return std::optional<basic_context>( std::move( ctx ) );
+	}
+
+	basic_context( basic_context&& ) noexcept            = default;
+	basic_context& operator=( basic_context&& ) noexcept = default;
+	basic_context( const basic_context& )                = delete;
+	basic_context& operator=( const basic_context& )     = delete;
+
+	/// the wrapped context, to use with the rest of the C API.
+	getopt_context_t*       get() noexcept       { return &m_ctx; }
+	const getopt_context_t* get() const noexcept { return &m_ctx; }
+
+	/// parse the next token, same as getopt_next().
+	event<Id> next() noexcept { return event<Id>( &m_ctx, getopt_next( &m_ctx ) ); }
+
+	/// parse the rest of argv, one event per call to getopt_next().
+	event_iterator<Id> begin() noexcept { return event_iterator<Id>( &m_ctx, getopt_next( &m_ctx ) ); }
+	event_sentinel     end() const noexcept { return event_sentinel(); }
+
+	void set_flags( unsigned int flags ) noexcept { getopt_set_flags( &m_ctx, flags ); }
+
+#if !defined(GETOPT_NO_HELP)
+	/// help-string written to buffer, see getopt_create_help_string().
+	std::string_view help( char* buffer, size_t buffer_size ) noexcept
+	{
+		return std::string_view( getopt_create_help_string( &m_ctx, buffer, buffer_size ) );
+	}
+#endif
+
+private:
+	basic_context() noexcept = default;
+
+	getopt_context_t m_ctx;
+};
+
+using context = basic_context<int>;
+
+} // namespace getopt_cpp
+
+#endif // GETOPT_GETOPT_HPP_INCLUDED
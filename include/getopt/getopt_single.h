@@ -0,0 +1,63 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+#ifndef GETOPT_GETOPT_SINGLE_H_INCLUDED
+#define GETOPT_GETOPT_SINGLE_H_INCLUDED
+
+/**
+ * @file getopt_single.h
+ *
+ * Single-header build of getopt, declares the full api and, in the one file that defines GETOPT_IMPLEMENTATION
+ * before including it, compiles the implementation as well. With the parser in the same translation unit as the
+ * caller the compiler can inline getopt_next() and the lookups into the parse-loop and specialize them against
+ * a static options-list.
+ *
+ * Define GETOPT_STATIC as well to give all functions internal linkage, each file including this header then gets
+ * a private copy that the compiler is free to inline, specialize and strip.
+ *
+ * Running 'bam amalgamate=<path>' writes this header with all includes of getopt resolved to one self-contained
+ * file that can be copied into other projects.
+ *
+ * @example
+ *
+ *   #define GETOPT_IMPLEMENTATION
+ *   #include <getopt/getopt_single.h>
+ */
+
+#if defined(GETOPT_STATIC) && !defined(GETOPT_IMPLEMENTATION)
+#  define GETOPT_IMPLEMENTATION
+#endif
+
+#include <getopt/getopt.h>
+#include <getopt/getopt_store.h>
+
+#endif /* GETOPT_GETOPT_SINGLE_H_INCLUDED */
+
+#if defined(GETOPT_IMPLEMENTATION) && !defined(GETOPT_IMPLEMENTATION_INCLUDED)
+#define GETOPT_IMPLEMENTATION_INCLUDED
+#include "../../src/getopt.c"
+#include "../../src/getopt_store.c"
+#endif /* defined(GETOPT_IMPLEMENTATION) */
@@ -0,0 +1,436 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+#ifndef GETOPT_GETOPT_STORE_H_INCLUDED
+#define GETOPT_GETOPT_STORE_H_INCLUDED
+
+#include <getopt/getopt.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @file getopt_store.h
+ *
+ * Resolves option-values from several sources, defaults, config-file, environment and argv, against the
+ * option-list of one getopt_context_t into one value-store. If an option is set by more than one source the
+ * value from the source with the highest precedence is kept, argv > environment > config-file > default,
+ * independent of the order the sources are read in.
+ *
+ * Values are stored as the raw string found in the source and converted when requested, the converted value is
+ * cached in the store so it is only converted once. Set GETOPT_FLAG_LAZY_VALUES on the context to also skip the
+ * conversion getopt_next() does for every typed argument in argv, values that has to be valid can then be marked
+ * with getopt_store_set_strict() and checked once after all sources are read with getopt_store_check().
+ *
+ * @example
+ *
+ *   getopt_value_t values[ARRAY_LENGTH( option_list )];
+ *   getopt_store_t store;
+ *   getopt_store_init( &store, &ctx, values, ARRAY_LENGTH( values ) );
+ *   getopt_set_flags( &ctx, GETOPT_FLAG_LAZY_VALUES );
+ *   getopt_store_set_strict( &store, getopt_lookup_long( &ctx, "threads", 7 ), 1 );
+ *
+ *   getopt_store_read_config_file( &store, "my_app.cfg" );  // ... "output-dir = /tmp" ...
+ *   getopt_store_read_env( &store, "MY_APP_", 0x0 );          // ... "MY_APP_OUTPUT_DIR=/tmp" ...
+ *
+ *   int opt;
+ *   while( ( opt = getopt_store_next( &store ) ) != -1 )     // ... "--output-dir=/tmp" ...
+ *   {
+ *       ...
+ *   }
+ *
+ *   const getopt_option_t* invalid;
+ *   if( getopt_store_check( &store, &invalid ) < 0 )
+ *       printf( "invalid value to --%s\n", invalid->name );
+ *
+ *   const getopt_value_t* out_dir = getopt_store_get( &store, getopt_lookup_long( &ctx, "output-dir", 10 ) );
+ *
+ *   getopt_store_release( &store );
+ */
+
+/**
+ * Sources that values can be read from, in order of precedence.
+ */
+typedef enum getopt_source
+{
+	GETOPT_SOURCE_NONE,        ///< Value is not set.
+	GETOPT_SOURCE_DEFAULT,     ///< Value set with getopt_store_set() as a default.
+	GETOPT_SOURCE_CONFIG_FILE, ///< Value read by getopt_store_read_config() or getopt_store_read_config_file().
+	GETOPT_SOURCE_ENV,         ///< Value read by getopt_store_read_env().
+	GETOPT_SOURCE_ARGV         ///< Value read by getopt_store_next().
+} getopt_source_t;
+
+/**
+ * Value of one option in a <getopt_store_t>.
+ */
+typedef struct getopt_value
+{
+	const char*     str;     ///< Raw value, NOT zero-terminated since it might point into a config-file. Empty for options without argument.
+	size_t          str_len; ///< Length of str.
+	getopt_source_t source;  ///< Source that value was read from, GETOPT_SOURCE_NONE if value is not set.
+	unsigned int    state;   ///< Internal variable, strict-mark and which conversions that are cached.
+	int             i32;     ///< Internal variable, cached result of getopt_store_get_int32().
+	float           fp32;    ///< Internal variable, cached result of getopt_store_get_fp32().
+} getopt_value_t;
+
+/**
+ * Value-store for all options in a context.
+ *
+ * @note: Do not modify data in this struct manually!
+ */
+typedef struct getopt_store
+{
+	getopt_context_t* ctx;         ///< Context that store values for, options are indexed by their position in ctx->opts.
+	getopt_value_t*   values;      ///< One value per option in ctx->opts.
+	void*             mapped;      ///< Internal variable, config-file mapped by getopt_store_read_config_file().
+	size_t            mapped_size; ///< Internal variable
+} getopt_store_t;
+
+/**
+ * Initializes a value-store with no values set.
+ *
+ * @param store      Store to initialize.
+ * @param ctx        Pointer to a initialized <getopt_context_t>, need to be valid as long as the store is used.
+ * @param values     Memory to store values in, need to be valid as long as the store is used.
+ * @param num_values Number of entries that fit in 'values', need to be at least ctx->num_opts.
+ *
+ * @return 0 on success, otherwise error-code.
+ */
+GETOPT_API int getopt_store_init( getopt_store_t* store, getopt_context_t* ctx, getopt_value_t* values, int num_values );
+
+/**
+ * Release resources held by store, i.e. a mapped config-file. Values read from a config-file is not valid after this.
+ */
+GETOPT_API void getopt_store_release( getopt_store_t* store );
+
+/**
+ * Set the value of an option if no source with higher precedence has set it already.
+ *
+ * @param store   Store to set value in.
+ * @param opt     Option to set, need to be an option in store->ctx->opts.
+ * @param str     Value to set, need to be valid as long as the store is used.
+ * @param str_len Length of str.
+ * @param source  Source of the value, GETOPT_SOURCE_DEFAULT when setting defaults.
+ *
+ * @return 1 if value was set, 0 if a value with higher precedence was already set.
+ */
+GETOPT_API int getopt_store_set( getopt_store_t* store, const getopt_option_t* opt, const char* str, size_t str_len, getopt_source_t source );
+
+/**
+ * Read values from config-file data with lines on the form "option-name = value". Leading and trailing whitespace
+ * is ignored as well as empty lines and lines starting with '#' or ';'. Options without argument can be given
+ * without '='. All values will point into 'data'.
+ *
+ * @param store Store to read values into.
+ * @param data  Config-file data, need to be valid as long as the store is used.
+ * @param size  Size of data.
+ *
+ * @return 0 on success, otherwise the line-number of the first line that was not a valid option. Lines after an
+ *         invalid line will still be read.
+ */
+GETOPT_API int getopt_store_read_config( getopt_store_t* store, const char* data, size_t size );
+
+/**
+ * Map a config-file in memory and read it with getopt_store_read_config(). The file is read in one pass
+ * directly from the mapping and stays mapped until getopt_store_release() is called. Only one config-file can
+ * be mapped per store.
+ *
+ * @param store Store to read values into.
+ * @param path  Path to config-file.
+ *
+ * @return 0 on success, -1 if the file could not be mapped, otherwise as getopt_store_read_config().
+ */
+GETOPT_API int getopt_store_read_config_file( getopt_store_t* store, const char* path );
+
+/**
+ * Read values from environment-variables on the form "<prefix><OPTION_NAME>=value" where OPTION_NAME is the
+ * long option-name in any case with '-' replaced by '_', i.e. "MY_APP_OUTPUT_DIR" for option "output-dir" with
+ * prefix "MY_APP_". The environment is scanned once, not queried once per option.
+ *
+ * @param store  Store to read values into.
+ * @param prefix Prefix that all variables should start with.
+ * @param env    NULL-terminated array of "NAME=value"-strings to read, NULL to read the environment of the process.
+ *
+ * @return number of values read.
+ */
+GETOPT_API int getopt_store_read_env( getopt_store_t* store, const char* prefix, const char* const* env );
+
+/**
+ * Parse the next token in store->ctx with getopt_next() and store the value of any found option.
+ *
+ * @return same as getopt_next().
+ */
+GETOPT_API int getopt_store_next( getopt_store_t* store );
+
+/**
+ * Get value of option.
+ *
+ * @return value of opt or NULL if opt was not set by any source.
+ */
+GETOPT_API const getopt_value_t* getopt_store_get( const getopt_store_t* store, const getopt_option_t* opt );
+
+/**
+ * Get value of option converted to int, supported int formats are, decimal, hex and octal (123, 0x123, 0123).
+ * The value is converted on the first call and the result is cached in the store, so the first call should not
+ * be made from several threads at once on a shared store, call getopt_store_check() before sharing the store.
+ * Stores of a <getopt_store_watch_t> have all values converted before readers get them.
+ *
+ * @return 0 on success, -1 if the option was not set or the value could not be converted.
+ */
+GETOPT_API int getopt_store_get_int32( const getopt_store_t* store, const getopt_option_t* opt, int* out );
+
+/**
+ * Get value of option converted to float, the result is cached as by getopt_store_get_int32().
+ *
+ * @return 0 on success, -1 if the option was not set or the value could not be converted.
+ */
+GETOPT_API int getopt_store_get_fp32( const getopt_store_t* store, const getopt_option_t* opt, float* out );
+
+/**
+ * Mark an option as strict, the value of a strict option is checked by getopt_store_check(). Values of options
+ * with a typed value are checked as getopt_convert_value() would check them, int, float, enum, bitmask, size,
+ * duration, rate, hex, base64 and pattern. Values of string-, path- and flag-options are not checked.
+ *
+ * @param store  Store to mark option in.
+ * @param opt    Option to mark, need to be an option in store->ctx->opts.
+ * @param strict 1 to mark option as strict, 0 to unmark.
+ */
+GETOPT_API void getopt_store_set_strict( getopt_store_t* store, const getopt_option_t* opt, int strict );
+
+/**
+ * Convert all set values of strict options, should be called when all sources have been read. Values of options
+ * that are not strict are only converted when requested.
+ *
+ * @param store  Store to check.
+ * @param failed Set to the first strict option that had a value that could not be converted, can be NULL.
+ *
+ * @return 0 if all strict values are valid, otherwise -1.
+ */
+GETOPT_API int getopt_store_check( getopt_store_t* store, const getopt_option_t** failed );
+
+/**
+ * Snapshot of all values in a store serialized into one block of memory that do not contain any pointers, so that
+ * it can be placed in shared memory and used as is by other processes, i.e. by workers forked from a pre-fork
+ * server or by processes started later that map the same shared memory. Each value is stored both as its raw
+ * string and converted to the type of its option. Equal strings are only stored once.
+ *
+ * A snapshot can only be read by a process built for the same architecture with the same options-list, this
+ * is checked by getopt_snapshot_open().
+ *
+ * @example
+ *
+ *   // ... parent, after all sources are read into store ...
+ *   int size = getopt_snapshot_write( &store, 0x0, 0 );
+ *   void* shared = mmap( 0x0, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+ *   getopt_snapshot_write( &store, shared, (size_t)size );
+ *
+ *   // ... in each worker ...
+ *   const getopt_snapshot_t* snapshot = getopt_snapshot_open( shared, (size_t)size, &ctx );
+ *   const getopt_snapshot_value_t* threads = getopt_snapshot_get( snapshot, &ctx, threads_opt );
+ *   if( threads && threads->valid )
+ *       use_threads( threads->value.i32 );
+ */
+typedef struct getopt_snapshot
+{
+	unsigned int       magic;       ///< Internal variable, identifies a snapshot.
+	unsigned int       version;     ///< Internal variable, version of the snapshot-format.
+	unsigned int       size;        ///< Size of the snapshot in bytes.
+	unsigned int       num_values;  ///< Number of values, one per option in the options-list.
+	unsigned long long schema_hash; ///< Internal variable, hash of the options-list the snapshot was written for.
+} getopt_snapshot_t;
+
+/**
+ * Value of one option in a <getopt_snapshot_t>.
+ */
+typedef struct getopt_snapshot_value
+{
+	getopt_typed_value_t value;      ///< Value converted to the type of the option, only valid if 'valid' is set.
+	unsigned int         source;     ///< <getopt_source_t> the value was read from, GETOPT_SOURCE_NONE if not set.
+	unsigned int         valid;      ///< 1 if the value could be converted to the type of the option.
+	unsigned int         str_offset; ///< Internal variable, offset of the raw value from the start of the snapshot.
+	unsigned int         str_len;    ///< Length of the raw value.
+} getopt_snapshot_value_t;
+
+/**
+ * Write a snapshot of all values in store to buffer.
+ *
+ * @param store       Store to write snapshot of.
+ * @param buffer      Memory to write snapshot to, need to be aligned to 8 bytes. Can be NULL if buffer_size is 0.
+ * @param buffer_size Size of buffer.
+ *
+ * @return size of the snapshot, if this is larger than buffer_size nothing was written. -1 on error.
+ */
+GETOPT_API int getopt_snapshot_write( const getopt_store_t* store, void* buffer, size_t buffer_size );
+
+/**
+ * Check that 'data' is a snapshot written for the options in ctx.
+ *
+ * @param data Snapshot written by getopt_snapshot_write().
+ * @param size Size of data.
+ * @param ctx  Context with the same options-list as the store the snapshot was written from.
+ *
+ * @return data as a snapshot or NULL if it is not a valid snapshot for ctx.
+ */
+GETOPT_API const getopt_snapshot_t* getopt_snapshot_open( const void* data, size_t size, const getopt_context_t* ctx );
+
+/**
+ * Get value of option from a snapshot opened with getopt_snapshot_open().
+ *
+ * @return value of opt or NULL if opt was not set.
+ */
+GETOPT_API const getopt_snapshot_value_t* getopt_snapshot_get( const getopt_snapshot_t* snapshot, const getopt_context_t* ctx, const getopt_option_t* opt );
+
+/**
+ * Get the raw string of a value in a snapshot, it is zero-terminated.
+ */
+GETOPT_API const char* getopt_snapshot_str( const getopt_snapshot_t* snapshot, const getopt_snapshot_value_t* value );
+
+/**
+ * Callback called for each option that changed value when a watched config-file is reloaded.
+ *
+ * @param opt       Option that changed.
+ * @param old_value Value before reload, NULL if it was not set.
+ * @param new_value Value after reload, NULL if it is no longer set.
+ * @param userdata  Userdata passed to getopt_store_watch_poll()/getopt_store_watch_reload().
+ */
+typedef void (*getopt_store_change_func)( const getopt_option_t* opt, const getopt_value_t* old_value, const getopt_value_t* new_value, void* userdata );
+
+/**
+ * What is compared to find changes to a file when inotify is not used, see <getopt_store_watch_t>.
+ */
+typedef struct getopt_store_file_stamp
+{
+	long long          mtime;      ///< Modification-time in seconds, -1 if the file could not be stat:ed.
+	long               mtime_nsec; ///< Nanoseconds of the modification-time, 0 on platforms without them.
+	long long          size;       ///< Size of the file in bytes.
+	unsigned long long ino;        ///< Inode of the file, changes when an editor replaces the file.
+} getopt_store_file_stamp_t;
+
+/**
+ * Watches the config-file that a store was read from and reloads it when changed.
+ *
+ * Two stores are used, readers use the current one while a reload builds the next version in the other one and
+ * then switch them, readers never block on a reload. A reader that gets the store with getopt_store_watch_acquire()
+ * is counted until getopt_store_watch_done() and a reload never rewrites a store that is counted, so such a reader
+ * never sees torn data however long it holds on to the store. A store returned by getopt_store_watch_current() is
+ * not counted and is only valid until the reload after the one that replaced it, a reader slower than two reloads
+ * then reads a store that is being rewritten. All values are converted by getopt_store_watch_init() and by each
+ * reload before the stores are switched so readers never write to a cached conversion, values from other sources
+ * should therefore be read into the store before getopt_store_watch_init().
+ *
+ * On reload only the lines between the first and last changed byte of the file are parsed again, values from
+ * the rest of the file are kept. Options that were set by a line that is removed from the file becomes unset,
+ * values from other sources with higher precedence than the config-file are never touched by a reload.
+ *
+ * Changes are detected with inotify on linux and otherwise by comparing the modification-time, with nanoseconds where
+ * the platform has them, size and inode of the file with the ones from the last reload. Without inotify a rewrite
+ * that keeps the size of the file within the timestamp-resolution of the filesystem can not be seen.
+ *
+ * The file is read into caller-provided buffers, one per store, instead of being mapped since a mapping would
+ * change under the readers when the file is rewritten in place.
+ *
+ * @note: Do not modify data in this struct manually!
+ */
+typedef struct getopt_store_watch
+{
+	getopt_store_t* stores[2];    ///< Internal variable, the two stores that is switched between.
+	char*           buffers[2];   ///< Internal variable, config-file data for each store.
+	size_t          data_size[2]; ///< Internal variable, size of config-file data in each buffer.
+	size_t          buffer_size;  ///< Internal variable, size of each buffer.
+	volatile long   current;      ///< Internal variable, index in stores of the store readers should use.
+	volatile long   readers[2];   ///< Internal variable, readers that acquired each store and are not done with it.
+	const char*     path;         ///< Internal variable, path to watched config-file.
+	int             fd;           ///< Internal variable, inotify-fd or -1.
+	int             wd;           ///< Internal variable, inotify watch or -1.
+	getopt_store_file_stamp_t stamp; ///< Internal variable, stamp of the file when it was last read.
+} getopt_store_watch_t;
+
+/**
+ * Start watching config-file 'path' and read it into 'store'. Other sources should be read into store before this.
+ *
+ * @param watch       Watch to initialize.
+ * @param store       Store initialized with getopt_store_init(), no config-file should have been read into it.
+ * @param back_store  Store initialized with getopt_store_init() on the same context as store, but with its own values.
+ * @param path        Path to config-file, need to be valid as long as watch is used.
+ * @param buffers     Two buffers to read the config-file into, need to be valid as long as the watch is used.
+ * @param buffer_size Size of each buffer, the config-file can not grow larger than this.
+ *
+ * @return 0 on success, -1 on error, otherwise as getopt_store_read_config().
+ */
+GETOPT_API int getopt_store_watch_init( getopt_store_watch_t* watch, getopt_store_t* store, getopt_store_t* back_store, const char* path, char* buffers[2], size_t buffer_size );
+
+/**
+ * Stop watching config-file with inotify. Both stores keep their values until the buffers are reused,
+ * getopt_store_watch_poll() can still be used and then compares the stamp of the file as without inotify.
+ */
+GETOPT_API void getopt_store_watch_release( getopt_store_watch_t* watch );
+
+/**
+ * Get the store that readers should use, this is safe to call from any thread. The store is not counted as used
+ * and is only valid until the reload after the one that replaces it, see <getopt_store_watch_acquire> for readers
+ * that might hold on to it longer.
+ */
+GETOPT_API const getopt_store_t* getopt_store_watch_current( const getopt_store_watch_t* watch );
+
+/**
+ * Get the store that readers should use and count it as used until getopt_store_watch_done() is called with it,
+ * a reload will not rewrite it until then. Safe to call from any thread and never blocks on a reload.
+ */
+GETOPT_API const getopt_store_t* getopt_store_watch_acquire( getopt_store_watch_t* watch );
+
+/**
+ * Stop using a store returned by getopt_store_watch_acquire().
+ */
+GETOPT_API void getopt_store_watch_done( getopt_store_watch_t* watch, const getopt_store_t* store );
+
+/**
+ * Check if the watched config-file has changed and reload it if so, never blocks waiting for a change.
+ * Options of flag-type that changed will have their flag written atomically, a flag that is no longer set is undone
+ * as by "--no-<name>", FLAG_SET writes 0, FLAG_OR clears the bits in value and FLAG_AND sets the bits not in value.
+ *
+ * @param watch    Watch to check.
+ * @param changed  Callback to call for each option that changed value, can be NULL.
+ * @param userdata Passed to 'changed'.
+ *
+ * @return 1 if file was reloaded, 0 if there was no change and -1 if reload failed. 0 is also returned while a
+ *         reader still uses the store that the reload would rewrite, the change is then found by a later poll.
+ */
+GETOPT_API int getopt_store_watch_poll( getopt_store_watch_t* watch, getopt_store_change_func changed, void* userdata );
+
+/**
+ * Reload the watched config-file even if no change has been detected, see getopt_store_watch_poll().
+ *
+ * @return 0 on success, -1 if reload failed and -2 if a reader that got the store with getopt_store_watch_acquire()
+ *         still uses the store that the reload would rewrite, nothing is changed then.
+ */
+GETOPT_API int getopt_store_watch_reload( getopt_store_watch_t* watch, getopt_store_change_func changed, void* userdata );
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
@@ -26,19 +26,70 @@
 
 #include <getopt/getopt.h>
 
-#include <stdio.h>  /* for vsnprintf */
-#include <stdarg.h> /* for va_list */
-#include <stdlib.h> /* atoi */
+#if !defined(GETOPT_NO_HELP) || !defined(GETOPT_NO_COMPLETION)
+#   include <stdio.h>  /* for vsnprintf */
+#   include <stdarg.h> /* for va_list */
+#endif
+#include <stdlib.h> /* strtol, strtof, qsort */
 #include <string.h>
-#if !defined(_MSC_VER)
+#include <stdint.h> /* uint64_t */
+#if defined(GETOPT_NO_CASE_INSENSITIVE)
+	/* strncmp from string.h */
+#elif !defined(_MSC_VER)
 #   include <strings.h> /* for strncasecmp */
 #else
 #   include <ctype.h> /* tolower */
 #endif
 
+#if !defined(GETOPT_NO_PATH)
+#   include <errno.h>
+#   include <sys/stat.h> /* stat */
+#   if defined(_MSC_VER)
+#       include <io.h> /* _access */
+#       if !defined(GETOPT_NO_PATH_THREADS)
+#           define GETOPT_NO_PATH_THREADS /* no pthreads, paths are checked on the calling thread */
+#       endif
+#   else
+#       include <unistd.h> /* access */
+#   endif
+#   if !defined(GETOPT_NO_PATH_THREADS)
+#       include <pthread.h>
+#   endif
+#   if !defined(S_ISREG)
+#       define S_ISREG( mode ) ( ( ( mode ) & S_IFMT ) == S_IFREG )
+#       define S_ISDIR( mode ) ( ( ( mode ) & S_IFMT ) == S_IFDIR )
+#   endif
+#endif
+
+#if !defined(GETOPT_NO_GLOB)
+#   include <errno.h>
+#   include <fcntl.h>    /* openat */
+#   include <unistd.h>   /* close */
+#   include <sys/stat.h> /* fstatat */
+#   if defined(__linux__)
+#       include <sys/syscall.h> /* SYS_getdents64 */
+#   else
+#       include <dirent.h>
+#   endif
+#endif
+
+#if !defined(GETOPT_NO_SIMD) && ( defined(__SSE2__) || defined(_M_X64) )
+#   include <emmintrin.h>
+#   define GETOPT_SSE2
+#endif
+
+/* hint for the functions on the getopt_next()-path, getopt_single.h lets the compiler inline them into the caller */
+#if defined(_MSC_VER) && !defined(__cplusplus)
+#   define GETOPT_INLINE __inline
+#else
+#   define GETOPT_INLINE inline
+#endif
+
 static int str_case_cmp_len(const char* s1, const char* s2, unsigned int len)
 {
-#if defined (_MSC_VER)
+#if defined(GETOPT_NO_CASE_INSENSITIVE)
+	return strncmp(s1, s2, len);
+#elif defined (_MSC_VER)
 	for(unsigned int i = 0; i < len; i++)
 	{
 		int c1 = tolower(s1[i]);
@@ -53,6 +104,7 @@ static int str_case_cmp_len(const char* s1, const char* s2, unsigned int len)
 #endif /* defined (_MSC_VER) */
 }
 
+#if !defined(GETOPT_NO_HELP)
 static int str_format(char* buf, size_t buf_size, const char* fmt, ...)
 {
 	va_list args;
@@ -64,293 +116,3924 @@ static int str_format(char* buf, size_t buf_size, const char* fmt, ...)
 	va_end( args );
 	return ret;
 }
+#endif
 
-int getopt_create_context( getopt_context_t* ctx, int argc, const char** argv, const getopt_option_t* opts )
+/* number of chars in the name starting at 'key', names in getopt_option_t.aliases end at '|' */
+static size_t getopt_key_len( const char* key )
 {
-	ctx->argc            = (argc > 1) ? (argc - 1) : 0; /* stripping away file-name! */
-	ctx->argv            = (argc > 1) ? (argv + 1) : argv; /* stripping away file-name! */
-	ctx->opts            = opts;
-	ctx->current_index   = 0;
-	ctx->current_opt_arg = 0x0;
+	size_t len = 0;
+	while( key[len] != '\0' && key[len] != '|' )
+		++len;
+	return len;
+}
 
-	/* count opts */
-	ctx->num_opts = 0;
-	const getopt_option_t* opt = opts;
-	while( !(opt->name == 0x0 && opt->name_short == 0) )
+/* step *alias past the next name in a list of aliases, returns 0 when there are no more names */
+static int getopt_next_alias( const char** alias, const char** key, int* deprecated )
+{
+	const char* pos = *alias;
+	if( pos == 0x0 || *pos == '\0' )
+		return 0;
+
+	*deprecated = *pos == '~';
+	*key        = pos + *deprecated;
+	pos = *key + getopt_key_len( *key );
+	*alias = *pos == '|' ? pos + 1 : pos;
+	return 1;
+}
+
+/* find index of 'value' in the '|'-separated list 'names', -1 if not found */
+static int getopt_find_choice( const char* names, const char* value, size_t value_len )
+{
+	int index = 0;
+	while( 1 )
 	{
-		if( opt->value == '!' || 
-			opt->value == '?' || 
-			opt->value == '+' || 
-			opt->value == -1)
-			return -1;
+		const char* name_end = names;
+		while( *name_end != '\0' && *name_end != '|' )
+			++name_end;
 
-		if( opt->name )
-		{
-			if( opt->name[0] == '-' )
-				return -1;
-		}
+		if( (size_t)( name_end - names ) == value_len && memcmp( names, value, value_len ) == 0 )
+			return index;
+		if( *name_end == '\0' )
+			return -1;
 
-		ctx->num_opts++; opt++;
+		names = name_end + 1;
+		++index;
 	}
-
-	return 0;
 }
 
-static int getopt_opt_might_have_arg( const getopt_option_t* opt )
+/* check that the list of names of an enum- or bitmask-option is valid, no empty names, no duplicates */
+static int getopt_validate_choices( const getopt_option_t* opt )
 {
-	switch(opt->type)
+	const char* names = opt->value_desc;
+	if( names == 0x0 || names[0] == '\0' )
+		return -1;
+
+	int num_names = 0;
+	const char* name = names;
+	while( 1 )
 	{
-		case GETOPT_OPTION_TYPE_OPTIONAL:
-		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
-		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
-		case GETOPT_OPTION_TYPE_REQUIRED:
-		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
-		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
-			return 1;
-		default:
-			return 0;
+		const char* name_end = name;
+		while( *name_end != '\0' && *name_end != '|' )
+			++name_end;
+
+		size_t name_len = (size_t)( name_end - name );
+		if( name_len == 0 || memchr( name, ',', name_len ) != 0x0 )
+			return -1;
+
+		/* a duplicate is found at an earlier index than its own */
+		if( getopt_find_choice( names, name, name_len ) != num_names )
+			return -1;
+		++num_names;
+
+		if( *name_end == '\0' )
+			break;
+		name = name_end + 1;
 	}
+
+	if( opt->type == GETOPT_OPTION_TYPE_REQUIRED_BITMASK && num_names > 32 )
+		return -1;
 	return 0;
 }
 
-static int getopt_read_value(getopt_context_t* ctx, const getopt_option_t* found_opt)
+#if !defined(GETOPT_NO_PATTERN)
+/* max number of chars and classes in a pattern, each one is a position in the automaton */
+#define GETOPT_PATTERN_MAX_POSITIONS 64
+/* max nesting of groups in a pattern */
+#define GETOPT_PATTERN_MAX_DEPTH 16
+
+/*
+	glushkov-automaton of a pattern, one state per char or class in the pattern and no epsilon-transitions.
+	a value is matched in one pass that keeps the set of positions that the last char could have matched.
+*/
+typedef struct getopt_glushkov
+{
+	int      num_positions;
+	int      nullable;
+	uint64_t first;                                     /* positions that can match the first char */
+	uint64_t last;                                      /* positions that can match the last char */
+	uint64_t follow[GETOPT_PATTERN_MAX_POSITIONS];      /* positions that can match the char after each position */
+	uint32_t chars[GETOPT_PATTERN_MAX_POSITIONS][8];    /* bitset of the bytes each position matches */
+} getopt_glushkov_t;
+
+/* first, last and nullable of a sub-expression */
+typedef struct getopt_glushkov_expr
+{
+	uint64_t first;
+	uint64_t last;
+	int      nullable;
+} getopt_glushkov_expr_t;
+
+typedef struct getopt_pattern_parser
+{
+	const char*        str;
+	getopt_glushkov_t* g;
+	int                depth;
+} getopt_pattern_parser_t;
+
+static void getopt_chars_add_range( uint32_t* chars, unsigned int from, unsigned int to )
+{
+	for( ; from <= to; ++from )
+		chars[from >> 5] |= 1u << ( from & 31 );
+}
+
+static int getopt_chars_has( const uint32_t* chars, unsigned char c )
+{
+	return ( chars[c >> 5] >> ( c & 31 ) ) & 1;
+}
+
+/* add the bytes matched by the escape "\c" to chars */
+static void getopt_pattern_escape( uint32_t* chars, unsigned char c )
 {
-	char* end = 0x0;
-	switch(found_opt->type)
+	switch( c )
 	{
-		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
-		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
-			ctx->current_value.i32 = (int)strtol(ctx->current_opt_arg, &end, 0);
+		case 'd':
+			getopt_chars_add_range( chars, '0', '9' );
 			break;
-		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
-		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
-			ctx->current_value.fp32 = strtof(ctx->current_opt_arg, &end);
+		case 'w':
+			getopt_chars_add_range( chars, '0', '9' );
+			getopt_chars_add_range( chars, 'a', 'z' );
+			getopt_chars_add_range( chars, 'A', 'Z' );
+			getopt_chars_add_range( chars, '_', '_' );
+			break;
+		case 's':
+			getopt_chars_add_range( chars, ' ', ' ' );
+			getopt_chars_add_range( chars, '\t', '\r' );
 			break;
 		default:
+			getopt_chars_add_range( chars, c, c );
 			break;
 	}
+}
 
-	if(*end != '\0')
-	{
-		ctx->current_opt_arg = found_opt->name;
-		return '!';
-	}
-	return found_opt->value;
+/* positions in 'from' can be followed by the positions in 'to' */
+static void getopt_glushkov_follow( getopt_glushkov_t* g, uint64_t from, uint64_t to )
+{
+	int pos = 0;
+	for( ; from != 0; ++pos, from >>= 1 )
+		if( from & 1 )
+			g->follow[pos] |= to;
 }
 
-int getopt_next( getopt_context_t* ctx )
+/* the rest of a class after '[' */
+static int getopt_pattern_class( getopt_pattern_parser_t* p, uint32_t* chars )
 {
-	/* are all options processed? */
-	if(ctx->current_index == ctx->argc )
+	int negate = *p->str == '^';
+	if( negate )
+		++p->str;
+
+	const char* start = p->str;
+	while( *p->str != ']' )
+	{
+		unsigned char c = (unsigned char)*p->str++;
+		if( c == '\0' )
+			return -1;
+
+		if( c == '\\' )
+		{
+			if( *p->str == '\0' )
+				return -1;
+			getopt_pattern_escape( chars, (unsigned char)*p->str++ );
+		}
+		else if( p->str[0] == '-' && p->str[1] != ']' && p->str[1] != '\0' )
+		{
+			unsigned char to = (unsigned char)p->str[1];
+			if( to < c )
+				return -1;
+			getopt_chars_add_range( chars, c, to );
+			p->str += 2;
+		}
+		else
+			getopt_chars_add_range( chars, c, c );
+	}
+	if( p->str == start )
 		return -1;
+	++p->str;
 
-	/* reset opt-arg */
-	ctx->current_opt_arg = 0x0;
+	if( negate )
+	{
+		int i = 0;
+		for( ; i < 8; ++i )
+			chars[i] = ~chars[i];
+		chars[0] &= ~1u; /* values never contain '\0' */
+	}
+	return 0;
+}
 
-	const char* curr_token = ctx->argv[ ctx->current_index ];
-	
-	/* this token has been processed! */
-	ctx->current_index++;
+static int getopt_pattern_alt( getopt_pattern_parser_t* p, getopt_glushkov_expr_t* e );
 
-	/* check if item is no option */
-	if( curr_token[0] && curr_token[0] != '-' )
+/* one char, class or group */
+static int getopt_pattern_atom( getopt_pattern_parser_t* p, getopt_glushkov_expr_t* e )
+{
+	unsigned char c = (unsigned char)*p->str++;
+	switch( c )
 	{
-		ctx->current_opt_arg = curr_token;
-		return '+'; /* return '+' as identifier for no option! */
+		case '(':
+			if( ++p->depth > GETOPT_PATTERN_MAX_DEPTH || getopt_pattern_alt( p, e ) < 0 || *p->str != ')' )
+				return -1;
+			--p->depth;
+			++p->str;
+			return 0;
+		case '*':
+		case '+':
+		case '?':
+		case ']':
+		case '{':
+		case '}':
+			return -1;
+		default:
+			break;
 	}
-	
-	const getopt_option_t* found_opt = 0x0;
-	const char* found_arg = 0x0;
 
-	/* short opt */
-	if( curr_token[1] != '\0' && curr_token[1] != '-' && curr_token[2] == '\0' )
+	getopt_glushkov_t* g = p->g;
+	if( g->num_positions == GETOPT_PATTERN_MAX_POSITIONS )
+		return -1;
+	int pos = g->num_positions++;
+	uint32_t* chars = g->chars[pos];
+	memset( chars, 0, sizeof( g->chars[pos] ) );
+	g->follow[pos] = 0;
+	e->first    = 1ull << pos;
+	e->last     = 1ull << pos;
+	e->nullable = 0;
+
+	switch( c )
 	{
-		int i = 0;
-		for( ; i < ctx->num_opts; i++ )
-		{
-			const getopt_option_t* opt = ctx->opts + i;
+		case '[':
+			return getopt_pattern_class( p, chars );
+		case '.':
+			getopt_chars_add_range( chars, 1, 255 );
+			return 0;
+		case '\\':
+			if( *p->str == '\0' )
+				return -1;
+			getopt_pattern_escape( chars, (unsigned char)*p->str++ );
+			return 0;
+		default:
+			getopt_chars_add_range( chars, c, c );
+			return 0;
+	}
+}
 
-			if( opt->name_short == curr_token[1] )
-			{
-				found_opt = opt;
+/* atoms, with quantifiers, one after the other */
+static int getopt_pattern_concat( getopt_pattern_parser_t* p, getopt_glushkov_expr_t* e )
+{
+	e->first    = 0;
+	e->last     = 0;
+	e->nullable = 1;
+	while( *p->str != '\0' && *p->str != '|' && *p->str != ')' )
+	{
+		getopt_glushkov_expr_t item;
+		if( getopt_pattern_atom( p, &item ) < 0 )
+			return -1;
 
-				/* if there is an value when: - current_index < argc and value in argv[current_index] do not start with '-' */
-				if( ( ( ctx->current_index != ctx->argc) && ( ctx->argv[ctx->current_index][0] != '-' ) ) && 
-					  getopt_opt_might_have_arg(opt) )
-				{
-					found_arg = ctx->argv[ctx->current_index];
-					ctx->current_index++; /* next token has been processed aswell! */
-				}
-				break;
-			}
+		/* a repeated item can be followed by itself */
+		while( *p->str == '*' || *p->str == '+' || *p->str == '?' )
+		{
+			char quantifier = *p->str++;
+			if( quantifier != '?' )
+				getopt_glushkov_follow( p->g, item.last, item.first );
+			if( quantifier != '+' )
+				item.nullable = 1;
 		}
+
+		getopt_glushkov_follow( p->g, e->last, item.first );
+		if( e->nullable )
+			e->first |= item.first;
+		e->last      = item.nullable ? ( e->last | item.last ) : item.last;
+		e->nullable &= item.nullable;
 	}
-	/* long opt */
-	else if(curr_token[1] == '-' && curr_token[2] != '\0')
+	return 0;
+}
+
+static int getopt_pattern_alt( getopt_pattern_parser_t* p, getopt_glushkov_expr_t* e )
+{
+	if( getopt_pattern_concat( p, e ) < 0 )
+		return -1;
+
+	while( *p->str == '|' )
 	{
-		int i = 0;
-		for( ; i < ctx->num_opts; i++ )
-		{
-			const char* check_option = curr_token + 2;
+		++p->str;
+		getopt_glushkov_expr_t rhs;
+		if( getopt_pattern_concat( p, &rhs ) < 0 )
+			return -1;
+		e->first    |= rhs.first;
+		e->last     |= rhs.last;
+		e->nullable |= rhs.nullable;
+	}
+	return 0;
+}
 
-			const getopt_option_t* opt = ctx->opts + i;
+static int getopt_pattern_compile( const char* pattern, getopt_glushkov_t* g )
+{
+	getopt_pattern_parser_t p;
+	p.str   = pattern;
+	p.g     = g;
+	p.depth = 0;
+	g->num_positions = 0;
 
-			if(!opt->name)
-				continue;
+	getopt_glushkov_expr_t e;
+	if( getopt_pattern_alt( &p, &e ) < 0 || *p.str != '\0' )
+		return -1;
 
-			unsigned int name_len = (unsigned int)strlen( opt->name );
+	g->first    = e.first;
+	g->last     = e.last;
+	g->nullable = e.nullable;
+	return 0;
+}
 
-			if( str_case_cmp_len( opt->name, check_option, name_len ) == 0 )
-			{
-				check_option += name_len;
+/* positions that can match c after the positions in state, at_start is set before the first char */
+static uint64_t getopt_glushkov_step( const getopt_glushkov_t* g, uint64_t state, int at_start, unsigned char c )
+{
+	uint64_t next = at_start ? g->first : 0;
+	int pos = 0;
+	for( ; state != 0; ++pos, state >>= 1 )
+		if( state & 1 )
+			next |= g->follow[pos];
 
-				/* find arg if there is any */
-				if(getopt_opt_might_have_arg(opt))
-				{
-					switch( *check_option )
-					{
-						case '\0':
-						{
-							if( ctx->current_index < ctx->argc ) /* are there more tokens that can contain the '='? */
-							{
-								const char* next_token = ctx->argv[ ctx->current_index ];
-								if( next_token[0] == '=' )
-								{
-									ctx->current_index++; /* next token has been processed aswell! */
-
-									if( next_token[1] != '\0' ) /* does this token contain the arg-value? */
-										found_arg = next_token + 1;
-									else if( ctx->current_index < ctx->argc )
-										found_arg = ctx->argv[ ctx->current_index++ ]; /* next token has been processed aswell! */
-								}
-								else if( next_token[0] != '-' )
-								{
-									ctx->current_index++; /* next token has been processed aswell! */
-									found_arg = next_token;
-								}
-							}
-						}
-						break;
-						case '=':
-							if( check_option[1] != '\0' )
-								found_arg = check_option + 1;
-							else if( ctx->current_index < ctx->argc )
-								found_arg = ctx->argv[ ctx->current_index++ ]; /* next token has been processed aswell! */
-						break;
-						default:
-							/* not found, matched for example --test but it was --testing*/
-							continue;
-					}
-				}
+	uint64_t matched = 0;
+	for( pos = 0; next != 0; ++pos, next >>= 1 )
+		if( ( next & 1 ) && getopt_chars_has( g->chars[pos], c ) )
+			matched |= 1ull << pos;
+	return matched;
+}
 
-				found_opt = opt;
-				break;
-			}
+/* match the 'len' first chars of str against pattern without a DFA, on mismatch offset is set to the first char that could not be matched */
+static int getopt_pattern_match( const char* pattern, const char* str, size_t len, size_t* offset )
+{
+	getopt_glushkov_t g;
+	if( getopt_pattern_compile( pattern, &g ) < 0 )
+	{
+		*offset = 0;
+		return -1;
+	}
+
+	uint64_t state = 0;
+	size_t i = 0;
+	for( ; i < len; ++i )
+	{
+		state = getopt_glushkov_step( &g, state, i == 0, (unsigned char)str[i] );
+		if( state == 0 )
+		{
+			*offset = i;
+			return -1;
 		}
 	}
-	/* malformed opt "-", "-xyz" or "--" */
-	else
+
+	if( i == 0 ? !g.nullable : ( state & g.last ) == 0 )
 	{
-		ctx->current_opt_arg = curr_token;
-		return '!';
+		*offset = i;
+		return -1;
+	}
+	return 0;
+}
+
+static int getopt_pattern_match_dfa( const getopt_pattern_t* pattern, const char* str, size_t* offset )
+{
+	const unsigned char* s = (const unsigned char*)str;
+	unsigned int state  = 1;
+	unsigned int accept = (unsigned int)pattern->accepts_empty;
+	size_t i = 0;
+	for( ; s[i] != '\0'; ++i )
+	{
+		unsigned int next = pattern->next[state * (unsigned int)pattern->num_classes + pattern->byte_class[s[i]]];
+		state  = next & 0x7fff;
+		accept = next >> 15;
+		if( state == 0 )
+		{
+			*offset = i;
+			return -1;
+		}
 	}
 
-	/* found no matching option! */
-	if(found_opt == 0x0)
+	if( !accept )
 	{
-		ctx->current_opt_arg = curr_token;
-		return '?';
+		*offset = i;
+		return -1;
 	}
+	return 0;
+}
 
-	if(found_arg != 0x0)
+/*
+	build the DFA of g into pattern with subset-construction, bytes that all positions treat the same share a
+	column in the table. returns number of table-entries used, 0 if the DFA would have to many states and -1 if
+	table is to small. with table NULL only the size is computed.
+*/
+static int getopt_pattern_build_dfa( const getopt_glushkov_t* g, getopt_pattern_t* pattern, unsigned short* table, size_t table_size )
+{
+	/* the positions each byte is matched by decides its class */
+	uint64_t class_masks[256];
+	unsigned char class_bytes[256];
+	int num_classes = 0;
+	int c = 0;
+	for( ; c < 256; ++c )
 	{
-		ctx->current_opt_arg = found_arg;
+		uint64_t mask = 0;
+		int pos = 0;
+		for( ; pos < g->num_positions; ++pos )
+			if( getopt_chars_has( g->chars[pos], (unsigned char)c ) )
+				mask |= 1ull << pos;
 
-		switch(found_opt->type)
+		int cls = 0;
+		while( cls < num_classes && class_masks[cls] != mask )
+			++cls;
+		if( cls == num_classes )
 		{
-			case GETOPT_OPTION_TYPE_FLAG_SET:
-			case GETOPT_OPTION_TYPE_FLAG_AND:
-			case GETOPT_OPTION_TYPE_FLAG_OR:
-			case GETOPT_OPTION_TYPE_NO_ARG:
-				/* these types should have no argument, usage error! */
-				ctx->current_opt_arg = 0x0;
-				return '+';
-
-			case GETOPT_OPTION_TYPE_OPTIONAL:
-			case GETOPT_OPTION_TYPE_REQUIRED:
-				return found_opt->value;
-			case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
-			case GETOPT_OPTION_TYPE_REQUIRED_INT32:
-			case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
-			case GETOPT_OPTION_TYPE_REQUIRED_FP32:
-				return getopt_read_value(ctx, found_opt);
+			class_masks[num_classes]   = mask;
+			class_bytes[num_classes++] = (unsigned char)c;
 		}
+		pattern->byte_class[c] = (unsigned char)cls;
 	}
-	/* no argument found */
-	else
+
+	/* state 0 never matches and state 1 is the start, the others are sets of positions */
+	uint64_t states[GETOPT_PATTERN_MAX_STATES];
+	int num_states = 2;
+	states[0] = 0;
+	states[1] = 0;
+
+	int state = 1;
+	for( ; state < num_states; ++state )
 	{
-		switch(found_opt->type)
+		size_t row = (size_t)state * (size_t)num_classes;
+		if( table && row + (size_t)num_classes > table_size )
+			return -1;
+
+		int cls = 0;
+		for( ; cls < num_classes; ++cls )
 		{
-			case GETOPT_OPTION_TYPE_FLAG_SET: *found_opt->flag  = found_opt->value; return 0;
-			case GETOPT_OPTION_TYPE_FLAG_AND: *found_opt->flag &= found_opt->value; return 0;
-			case GETOPT_OPTION_TYPE_FLAG_OR:  *found_opt->flag |= found_opt->value; return 0; /* zero is "a flag was set!" */
-			
-			case GETOPT_OPTION_TYPE_NO_ARG:
-			case GETOPT_OPTION_TYPE_OPTIONAL:
-			case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
-			case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
-				return found_opt->value;
+			uint64_t next = getopt_glushkov_step( g, states[state], state == 1, class_bytes[cls] );
+			int next_state = 0;
+			if( next != 0 )
+			{
+				next_state = 2;
+				while( next_state < num_states && states[next_state] != next )
+					++next_state;
+				if( next_state == num_states )
+				{
+					if( num_states == GETOPT_PATTERN_MAX_STATES )
+						return 0;
+					states[num_states++] = next;
+				}
+			}
 
-			/* the option requires an argument! (--option=arg, -o arg) */
-			case GETOPT_OPTION_TYPE_REQUIRED:
-			case GETOPT_OPTION_TYPE_REQUIRED_INT32:
-			case GETOPT_OPTION_TYPE_REQUIRED_FP32:
-				ctx->current_opt_arg = found_opt->name;
-				return '!';
+			if( table )
+				table[row + (size_t)cls] = (unsigned short)( next_state | ( ( next & g->last ) != 0 ? 0x8000 : 0 ) );
 		}
 	}
 
- 	return -1;
+	pattern->num_states    = num_states;
+	pattern->num_classes   = num_classes;
+	pattern->accepts_empty = g->nullable;
+	pattern->next          = table;
+	return num_states * num_classes;
 }
+#endif /* !defined(GETOPT_NO_PATTERN) */
 
-const char* getopt_create_help_string( getopt_context_t* ctx, char* buffer, size_t buffer_size )
+/* types that need a conversion left out by GETOPT_NO_INT, GETOPT_NO_FLOAT or GETOPT_NO_UNITS are not supported */
+static int getopt_type_supported( getopt_option_type_t type )
 {
-	size_t buffer_pos = 0;
-	int    opt_index  = 0;
+	switch( type )
+	{
+#if defined(GETOPT_NO_INT)
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			return 0;
+#endif
+#if defined(GETOPT_NO_FLOAT)
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+			return 0;
+#endif
+#if defined(GETOPT_NO_UNITS)
+		case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+		case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+		case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+			return 0;
+#endif
+#if defined(GETOPT_NO_BLOB)
+		case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+		case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+			return 0;
+#endif
+#if defined(GETOPT_NO_PATTERN)
+		case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+			return 0;
+#endif
+#if defined(GETOPT_NO_PATH)
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+			return 0;
+#endif
+		default:
+			return 1;
+	}
+}
+
+/* check the parts of an option that do not depend on other options, returns -1 if opt is invalid */
+static int getopt_validate_option( const getopt_option_t* opt )
+{
+	if( opt->value == '!' || 
+		opt->value == '?' || 
+		opt->value == '+' || 
+		opt->value == '#' || 
+		opt->value == -1)
+		return -1;
+
+	if( opt->name )
+	{
+		if( opt->name[0] == '-' )
+			return -1;
+	}
+
+	if( !getopt_type_supported( opt->type ) )
+		return -1;
+
+	/* aliases are looked up as long names so they follow the same rules */
+	if( opt->aliases )
+	{
+		if( opt->name == 0x0 )
+			return -1;
+
+		const char* alias = opt->aliases;
+		const char* key;
+		int deprecated;
+		while( getopt_next_alias( &alias, &key, &deprecated ) )
+			if( getopt_key_len( key ) == 0 || key[0] == '-' )
+				return -1;
+	}
+
+	if( opt->negatable )
+	{
+		if( opt->name == 0x0 )
+			return -1;
+		if( opt->type != GETOPT_OPTION_TYPE_FLAG_SET && opt->type != GETOPT_OPTION_TYPE_FLAG_AND && opt->type != GETOPT_OPTION_TYPE_FLAG_OR )
+			return -1;
+	}
+
+	if( ( opt->type == GETOPT_OPTION_TYPE_REQUIRED_ENUM || opt->type == GETOPT_OPTION_TYPE_REQUIRED_BITMASK ) &&
+		getopt_validate_choices( opt ) < 0 )
+		return -1;
+
+#if !defined(GETOPT_NO_PATTERN)
+	getopt_glushkov_t g;
+	if( opt->type == GETOPT_OPTION_TYPE_REQUIRED_PATTERN &&
+		( opt->value_desc == 0x0 || getopt_pattern_compile( opt->value_desc, &g ) < 0 ) )
+		return -1;
+#endif
+	return 0;
+}
+
+/* entry in getopt_context_t.short_index for an option too far into the list to point to, it is found by a scan from there */
+#define GETOPT_SHORT_INDEX_SCAN 0xffff
+
+int getopt_create_context( getopt_context_t* ctx, int argc, const char** argv, const getopt_option_t* opts )
+{
+	ctx->argc            = (argc > 1) ? (argc - 1) : 0; /* stripping away file-name! */
+	ctx->argv            = (argc > 1) ? (argv + 1) : argv; /* stripping away file-name! */
+	ctx->opts            = opts;
+	ctx->registry        = 0x0;
+	ctx->current_index   = 0;
+	ctx->current_opt_arg = 0x0;
+	ctx->current_opt     = 0x0;
+	ctx->flags           = GETOPT_FLAG_NONE;
+	ctx->index           = 0x0;
+	ctx->index_size      = 0;
+	ctx->occurrences     = 0x0;
+	ctx->query_index     = 0;
+	ctx->constraints     = 0x0;
+	ctx->limits          = 0x0;
+	ctx->used_bytes      = 0;
+	ctx->token_base      = 0;
+	ctx->used_ops        = 0;
+	ctx->deprecated_func     = 0x0;
+	ctx->deprecated_userdata = 0x0;
+	ctx->paths           = 0x0;
+	ctx->paths_size      = 0;
+	ctx->num_paths       = 0;
+	ctx->glob            = 0x0;
+	ctx->blob_buffer     = 0x0;
+	ctx->blob_size       = 0;
+	ctx->blob_used       = 0;
+	ctx->current_blob    = 0x0;
+	ctx->normalize_func     = 0x0;
+	ctx->normalize_userdata = 0x0;
+	ctx->text_buffer     = 0x0;
+	ctx->text_size       = 0;
+	ctx->text_used       = 0;
+	ctx->patterns        = 0x0;
+	ctx->num_patterns    = 0;
+
+	/* count opts */
+	ctx->num_opts = 0;
+	const getopt_option_t* opt = opts;
+	while( !(opt->name == 0x0 && opt->name_short == 0) )
+	{
+		if( getopt_validate_option( opt ) < 0 )
+			return -1;
+
+		ctx->num_opts++; opt++;
+	}
+
+	/*
+		short names are found in a table so that a short option cost the same whatever the number of options. the
+		table is filled from the back so that the first option with a name wins, as with a scan of the list.
+	*/
+	memset( ctx->short_index, 0x0, sizeof( ctx->short_index ) );
+	int i = ctx->num_opts;
+	while( i-- > 0 )
+	{
+		int name_short = opts[i].name_short;
+		if( name_short != 0 && name_short >= -128 && name_short <= 255 )
+			ctx->short_index[name_short & 0xff] = i < GETOPT_SHORT_INDEX_SCAN ? (unsigned short)( i + 1 ) : GETOPT_SHORT_INDEX_SCAN;
+	}
+
+	return 0;
+}
+
+void getopt_set_flags( getopt_context_t* ctx, unsigned int flags )
+{
+	ctx->flags = flags;
+}
+
+void getopt_set_deprecated_callback( getopt_context_t* ctx, getopt_deprecated_func func, void* userdata )
+{
+	ctx->deprecated_func     = func;
+	ctx->deprecated_userdata = userdata;
+}
+
+void getopt_set_normalizer( getopt_context_t* ctx, getopt_normalize_func func, void* userdata, char* buffer, size_t buffer_size )
+{
+	ctx->normalize_func     = func;
+	ctx->normalize_userdata = userdata;
+	ctx->text_buffer        = buffer;
+	ctx->text_size          = buffer ? buffer_size : 0;
+	ctx->text_used          = 0;
+}
+
+void getopt_set_limits( getopt_context_t* ctx, const getopt_limits_t* limits )
+{
+	ctx->limits     = limits;
+	ctx->used_bytes = 0;
+	ctx->used_ops   = 0;
+}
+
+const getopt_option_t* getopt_option_at( const getopt_context_t* ctx, int opt_index )
+{
+	if( ctx->registry == 0x0 )
+		return ctx->opts + opt_index;
+
+	/* last table starting at or before opt_index */
+	const getopt_registry_table_t* tables = ctx->registry->tables;
+	int lo = 0;
+	int hi = ctx->registry->num_tables - 1;
+	while( lo < hi )
+	{
+		int mid = lo + ( hi - lo + 1 ) / 2;
+		if( tables[mid].first <= opt_index )
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return tables[lo].opts + ( opt_index - tables[lo].first );
+}
+
+int getopt_option_index( const getopt_context_t* ctx, const getopt_option_t* opt )
+{
+	if( ctx->registry == 0x0 )
+		return ( opt >= ctx->opts && opt < ctx->opts + ctx->num_opts ) ? (int)( opt - ctx->opts ) : -1;
+
+	int i = 0;
+	for( ; i < ctx->registry->num_tables; ++i )
+	{
+		const getopt_registry_table_t* table = ctx->registry->tables + i;
+		if( opt >= table->opts && opt < table->opts + table->num_opts )
+			return table->first + (int)( opt - table->opts );
+	}
+	return -1;
+}
+
+static GETOPT_INLINE int getopt_to_lower( int c )
+{
+#if defined(GETOPT_NO_CASE_INSENSITIVE)
+	return c;
+#else
+	return ( c >= 'A' && c <= 'Z' ) ? c - 'A' + 'a' : c;
+#endif
+}
+
+/* compare name with the first key_len chars of key, <0 if name sorts before key, >0 if after and 0 if equal */
+static GETOPT_INLINE int getopt_name_cmp( const char* name, const char* key, size_t key_len )
+{
+	size_t i = 0;
+	for( ; i < key_len; ++i )
+	{
+		if( name[i] == key[i] && name[i] != '|' )
+			continue;
+
+		/* '|' ends an alias and sorts as the end of the name */
+		int c1 = name[i] == '|' ? '\0' : getopt_to_lower( (unsigned char)name[i] );
+		int c2 = getopt_to_lower( (unsigned char)key[i] );
+		if( c1 != c2 )
+			return c1 - c2; /* name ending before key will be caught here since key[i] != '\0' */
+	}
+	return ( name[key_len] == '\0' || name[key_len] == '|' ) ? 0 : 1;
+}
+
+static int getopt_name_starts_with( const char* name, const char* prefix, size_t prefix_len )
+{
+	size_t i = 0;
+	for( ; i < prefix_len; ++i )
+	{
+		if( name[i] == '\0' || name[i] == '|' || getopt_to_lower( (unsigned char)name[i] ) != getopt_to_lower( (unsigned char)prefix[i] ) )
+			return 0;
+	}
+	return 1;
+}
+
+/* compare two names in index-order, names in getopt_option_t.aliases end at '|' */
+static int getopt_key_cmp( const char* name_a, const char* name_b )
+{
+	for( ;; ++name_a, ++name_b )
+	{
+		int c1 = *name_a == '|' ? '\0' : getopt_to_lower( (unsigned char)*name_a );
+		int c2 = *name_b == '|' ? '\0' : getopt_to_lower( (unsigned char)*name_b );
+		if( c1 != c2 || c1 == '\0' )
+			return c1 - c2;
+	}
+}
+
+static int getopt_index_sort_cmp( const void* a, const void* b )
+{
+	return getopt_key_cmp( ( (const getopt_index_entry_t*)a )->name, ( (const getopt_index_entry_t*)b )->name );
+}
+
+/* store the long name and all aliases of opt in index, returns number of entries stored or -1 if they do not fit */
+static int getopt_index_add_keys( getopt_index_entry_t* index, int index_size, const getopt_option_t* opt )
+{
+	if( !opt->name )
+		return 0;
+	if( index_size < 1 )
+		return -1;
+
+	index[0].name       = opt->name;
+	index[0].opt        = opt;
+	index[0].deprecated = 0;
+
+	int num_keys = 1;
+	const char* alias = opt->aliases;
+	const char* key;
+	int deprecated;
+	while( getopt_next_alias( &alias, &key, &deprecated ) )
+	{
+		if( num_keys == index_size )
+			return -1;
+		index[num_keys].name       = key;
+		index[num_keys].opt        = opt;
+		index[num_keys].deprecated = deprecated;
+		++num_keys;
+	}
+	return num_keys;
+}
+
+int getopt_create_index( getopt_context_t* ctx, getopt_index_entry_t* index, int index_size )
+{
+	int num_index = 0;
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		int num_keys = getopt_index_add_keys( index + num_index, index_size - num_index, getopt_option_at( ctx, i ) );
+		if( num_keys < 0 )
+			return -1;
+		num_index += num_keys;
+	}
+
+	qsort( (void*)index, (size_t)num_index, sizeof( getopt_index_entry_t ), getopt_index_sort_cmp );
+
+	/* duplicate names would make lookup ambiguous */
+	for( i = 1; i < num_index; ++i )
+		if( getopt_index_sort_cmp( &index[i - 1], &index[i] ) == 0 )
+			return -1;
+
+	ctx->index      = index;
+	ctx->index_size = num_index;
+	return 0;
+}
+
+/* integer log2 rounded up, number of compares a binary search over n entries might need */
+static unsigned long getopt_log2_ceil( int n )
+{
+	unsigned long steps = 0;
+	while( ( 1ull << steps ) < (unsigned long long)n )
+		++steps;
+	return steps + 1;
+}
+
+/* first entry in index that do not sort before key */
+static GETOPT_INLINE int getopt_index_lower_bound( const getopt_index_entry_t* index, int index_size, const char* key, size_t key_len )
+{
+	int lo = 0;
+	int hi = index_size;
+	while( lo < hi )
+	{
+		int mid = lo + ( hi - lo ) / 2;
+		if( getopt_name_cmp( index[mid].name, key, key_len ) < 0 )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* option with long name or alias 'name', *deprecated is set if it was found by a deprecated alias */
+static GETOPT_INLINE const getopt_option_t* getopt_lookup_key( const getopt_context_t* ctx, const char* name, size_t name_len, int* deprecated )
+{
+	*deprecated = 0;
+	if( ctx->index )
+	{
+		int found = getopt_index_lower_bound( ctx->index, ctx->index_size, name, name_len );
+		if( found < ctx->index_size && getopt_name_cmp( ctx->index[found].name, name, name_len ) == 0 )
+		{
+			*deprecated = ctx->index[found].deprecated;
+			return ctx->index[found].opt;
+		}
+		return 0x0;
+	}
+
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, i );
+		if( !opt->name )
+			continue;
+		if( str_case_cmp_len( opt->name, name, (unsigned int)name_len ) == 0 && opt->name[name_len] == '\0' )
+			return opt;
+
+		const char* alias = opt->aliases;
+		const char* key;
+		while( getopt_next_alias( &alias, &key, deprecated ) )
+			if( getopt_name_cmp( key, name, name_len ) == 0 )
+				return opt;
+		*deprecated = 0;
+	}
+	return 0x0;
+}
+
+const getopt_option_t* getopt_lookup_long( const getopt_context_t* ctx, const char* name, size_t name_len )
+{
+	int deprecated;
+	return getopt_lookup_key( ctx, name, name_len, &deprecated );
+}
+
+/* does the long name or any alias of opt start with prefix, each name compared is one operation */
+static int getopt_option_starts_with( const getopt_option_t* opt, const char* prefix, size_t prefix_len, unsigned long* ops )
+{
+	if( !opt->name )
+		return 0;
+	++*ops;
+	if( getopt_name_starts_with( opt->name, prefix, prefix_len ) )
+		return 1;
+
+	const char* alias = opt->aliases;
+	const char* key;
+	int deprecated;
+	while( getopt_next_alias( &alias, &key, &deprecated ) )
+	{
+		++*ops;
+		if( getopt_name_starts_with( key, prefix, prefix_len ) )
+			return 1;
+	}
+	return 0;
+}
+
+/* is 'key' the first name of opt in index-order that starts with prefix, an option matching by several names is counted by that one */
+static int getopt_is_first_match( const getopt_option_t* opt, const char* key, const char* prefix, size_t prefix_len, unsigned long* ops )
+{
+	const char* other = opt->name;
+	const char* alias = opt->aliases;
+	int deprecated;
+	do
+	{
+		++*ops;
+		if( other != key && getopt_name_starts_with( other, prefix, prefix_len ) && getopt_key_cmp( other, key ) < 0 )
+			return 0;
+	}
+	while( getopt_next_alias( &alias, &other, &deprecated ) );
+	return 1;
+}
+
+/*
+	has the option of entry already been found, compared against the found options while they all fit in matches,
+	that is always the case when looking up an abbreviation.
+*/
+static int getopt_is_found( const getopt_index_entry_t* entry, const getopt_option_t** matches, int matches_size, int num_matches, const char* prefix, size_t prefix_len, unsigned long* ops )
+{
+	if( num_matches > matches_size )
+		return !getopt_is_first_match( entry->opt, entry->name, prefix, prefix_len, ops );
+
+	int i = 0;
+	for( ; i < num_matches; ++i )
+	{
+		++*ops;
+		if( matches[i] == entry->opt )
+			return 1;
+	}
+	return 0;
+}
+
+/*
+	find options starting with prefix as getopt_lookup_prefix(), but stop when max_matches options has been found,
+	-1 for no limit. the number of names compared is added to *ops.
+*/
+static int getopt_find_prefix( const getopt_context_t* ctx, const char* prefix, size_t prefix_len, const getopt_option_t** matches, int matches_size, int max_matches, unsigned long* ops )
+{
+	int num_matches = 0;
+
+	if( ctx->index )
+	{
+		/* all names starting with prefix are sorted right after it */
+		int index_pos = getopt_index_lower_bound( ctx->index, ctx->index_size, prefix, prefix_len );
+		*ops += getopt_log2_ceil( ctx->index_size );
+		for( ; num_matches != max_matches && index_pos < ctx->index_size; ++index_pos )
+		{
+			const getopt_index_entry_t* entry = ctx->index + index_pos;
+			++*ops;
+			if( !getopt_name_starts_with( entry->name, prefix, prefix_len ) )
+				break;
+			if( entry->opt->aliases && getopt_is_found( entry, matches, matches_size, num_matches, prefix, prefix_len, ops ) )
+				continue;
+
+			if( num_matches < matches_size )
+				matches[num_matches] = entry->opt;
+			++num_matches;
+		}
+		return num_matches;
+	}
+
+	int i = 0;
+	for( ; num_matches != max_matches && i < ctx->num_opts; ++i )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, i );
+		if( !getopt_option_starts_with( opt, prefix, prefix_len, ops ) )
+			continue;
+
+		if( num_matches < matches_size )
+			matches[num_matches] = opt;
+		++num_matches;
+	}
+	return num_matches;
+}
+
+int getopt_lookup_prefix( const getopt_context_t* ctx, const char* prefix, size_t prefix_len, const getopt_option_t** matches, int matches_size )
+{
+	unsigned long ops = 0;
+	return getopt_find_prefix( ctx, prefix, prefix_len, matches, matches_size, -1, &ops );
+}
+
+int getopt_registry_init( getopt_registry_t* registry, getopt_registry_table_t* tables, int tables_size, getopt_index_entry_t* index, int index_size )
+{
+	if( tables_size < 0 || index_size < 0 )
+		return -1;
+
+	registry->tables      = tables;
+	registry->num_tables  = 0;
+	registry->tables_size = tables_size;
+	registry->index       = index;
+	registry->index_count = 0;
+	registry->index_size  = index_size;
+	registry->num_opts    = 0;
+	memset( (void*)registry->short_opts, 0x0, sizeof( registry->short_opts ) );
+	return 0;
+}
+
+/* merge the sorted run of 'num_new' entries at index[num_old] into the sorted run before it */
+static void getopt_registry_merge( getopt_index_entry_t* index, int index_size, int num_old, int num_new )
+{
+	int num_total = num_old + num_new;
+	if( index_size - num_total < num_new )
+	{
+		/* no room to move the new run out of the way */
+		qsort( (void*)index, (size_t)num_total, sizeof( getopt_index_entry_t ), getopt_index_sort_cmp );
+		return;
+	}
+
+	/* move the new run to the end of index and merge from the back, all writes stay below the moved run */
+	getopt_index_entry_t* new_run = index + index_size - num_new;
+	memmove( (void*)new_run, (const void*)( index + num_old ), sizeof( getopt_index_entry_t ) * (size_t)num_new );
+
+	int old_pos = num_old - 1;
+	int new_pos = num_new - 1;
+	int out_pos = num_total - 1;
+	while( new_pos >= 0 )
+	{
+		if( old_pos >= 0 && getopt_index_sort_cmp( &index[old_pos], &new_run[new_pos] ) > 0 )
+			index[out_pos--] = index[old_pos--];
+		else
+			index[out_pos--] = new_run[new_pos--];
+	}
+}
+
+int getopt_registry_add( getopt_registry_t* registry, const getopt_option_t* opts, const getopt_option_t** conflict )
+{
+	const getopt_option_t* dummy;
+	if( conflict == 0x0 )
+		conflict = &dummy;
+	*conflict = 0x0;
+
+	if( registry->num_tables == registry->tables_size )
+		return -1;
+
+	/* validate all options and collect long names and aliases after the index before anything is changed */
+	getopt_index_entry_t*   new_run = registry->index + registry->index_count;
+	unsigned long long      short_seen[4] = { 0, 0, 0, 0 };
+	int num_opts = 0;
+	int num_long = 0;
+	const getopt_option_t* opt = opts;
+	for( ; !(opt->name == 0x0 && opt->name_short == 0); ++opt, ++num_opts )
+	{
+		*conflict = opt;
+		if( getopt_validate_option( opt ) < 0 || opt->name_short < 0 || opt->name_short > 255 )
+			return -1;
+
+		if( opt->name_short != 0 )
+		{
+			unsigned long long bit = 1ull << ( opt->name_short & 63 );
+			if( registry->short_opts[opt->name_short] != 0x0 || ( short_seen[opt->name_short >> 6] & bit ) )
+				return -1;
+			short_seen[opt->name_short >> 6] |= bit;
+		}
+
+		int num_keys = getopt_index_add_keys( new_run + num_long, registry->index_size - registry->index_count - num_long, opt );
+		if( num_keys < 0 )
+		{
+			*conflict = 0x0;
+			return -1;
+		}
+
+		int key_pos = num_long;
+		for( ; key_pos < num_long + num_keys; ++key_pos )
+		{
+			const char* key     = new_run[key_pos].name;
+			size_t      key_len = getopt_key_len( key );
+			int         found   = getopt_index_lower_bound( registry->index, registry->index_count, key, key_len );
+			if( found < registry->index_count && getopt_name_cmp( registry->index[found].name, key, key_len ) == 0 )
+				return -1;
+		}
+		num_long += num_keys;
+	}
+	*conflict = 0x0;
+
+	/* duplicates within the list end up next to each other */
+	qsort( (void*)new_run, (size_t)num_long, sizeof( getopt_index_entry_t ), getopt_index_sort_cmp );
+	int i = 1;
+	for( ; i < num_long; ++i )
+	{
+		if( getopt_index_sort_cmp( &new_run[i - 1], &new_run[i] ) == 0 )
+		{
+			*conflict = new_run[i].opt;
+			return -1;
+		}
+	}
+
+	getopt_registry_merge( registry->index, registry->index_size, registry->index_count, num_long );
+	registry->index_count += num_long;
+
+	for( opt = opts; opt < opts + num_opts; ++opt )
+		if( opt->name_short != 0 )
+			registry->short_opts[opt->name_short] = opt;
+
+	getopt_registry_table_t* table = registry->tables + registry->num_tables++;
+	table->opts     = opts;
+	table->first    = registry->num_opts;
+	table->num_opts = num_opts;
+	registry->num_opts += num_opts;
+	return 0;
+}
+
+int getopt_create_context_registry( getopt_context_t* ctx, int argc, const char** argv, const getopt_registry_t* registry )
+{
+	static const getopt_option_t no_opts[] = { GETOPT_OPTIONS_END };
+	if( getopt_create_context( ctx, argc, argv, no_opts ) < 0 )
+		return -1;
+
+	ctx->opts       = registry->num_tables > 0 ? registry->tables[0].opts : no_opts;
+	ctx->num_opts   = registry->num_opts;
+	ctx->registry   = registry;
+	ctx->index      = registry->index;
+	ctx->index_size = registry->index_count;
+	return 0;
+}
+
+/* bits in the match-mask of getopt_find_long_opt(), how the option was given */
+#define GETOPT_MATCH_DEPRECATED 0x1u /* by a deprecated alias */
+#define GETOPT_MATCH_NEGATED    0x2u /* as "--no-<name>" */
+
+static GETOPT_INLINE const getopt_option_t* getopt_find_long_opt( getopt_context_t* ctx, const char* name, size_t name_len, unsigned int* match )
+{
+	int deprecated;
+	const getopt_option_t* found = getopt_lookup_key( ctx, name, name_len, &deprecated );
+	*match = 0;
+
+	/* an option really called "no-<name>" is found above and takes precedence */
+	if( found == 0x0 && name_len > 3 && str_case_cmp_len( name, "no-", 3 ) == 0 )
+	{
+		found = getopt_lookup_key( ctx, name + 3, name_len - 3, &deprecated );
+		if( found != 0x0 && !found->negatable )
+			found = 0x0;
+		*match = GETOPT_MATCH_NEGATED;
+	}
+
+	if( found )
+	{
+		if( deprecated )
+			*match |= GETOPT_MATCH_DEPRECATED;
+		return found;
+	}
+
+	*match = 0;
+	if( !( ctx->flags & GETOPT_FLAG_ALLOW_ABBREVIATIONS ) )
+		return 0x0;
+
+	/* only use the abbreviation if it is unique, no need to look further than a second option */
+	unsigned long ops = 0;
+	int num_matches = getopt_find_prefix( ctx, name, name_len, &found, 1, 2, &ops );
+	ctx->used_ops += ops; /* checked against the limit by getopt_next() */
+	return num_matches == 1 ? found : 0x0;
+}
+
+static GETOPT_INLINE const getopt_option_t* getopt_find_short_opt( const getopt_context_t* ctx, int name_short )
+{
+	/* chars in argv might be signed, short names are looked up as unsigned chars */
+	if( name_short == 0 || name_short < -128 || name_short > 255 )
+		return 0x0;
+	name_short &= 0xff;
+
+	if( ctx->registry )
+		return ctx->registry->short_opts[name_short];
+
+	int i = ctx->short_index[name_short];
+	if( i != GETOPT_SHORT_INDEX_SCAN )
+		return i != 0 ? ctx->opts + i - 1 : 0x0;
+
+	/* first option with the name is further into a very large list than the table can point */
+	for( i = GETOPT_SHORT_INDEX_SCAN - 1; i < ctx->num_opts; ++i )
+		if( ctx->opts[i].name_short >= -128 && ctx->opts[i].name_short <= 255 && ( ctx->opts[i].name_short & 0xff ) == name_short )
+			return ctx->opts + i;
+	return 0x0;
+}
+
+static GETOPT_INLINE int getopt_opt_might_have_arg( const getopt_option_t* opt )
+{
+	switch(opt->type)
+	{
+		case GETOPT_OPTION_TYPE_OPTIONAL:
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+		case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+		case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+		case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+		case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+		case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+		case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+			return 1;
+		default:
+			return 0;
+	}
+	return 0;
+}
+
+/* read ','-separated list of names in the 'value_len' first chars of 'value' to a mask, returns -1 if any name is not valid */
+static int getopt_read_bitmask( const char* names, const char* value, size_t value_len, unsigned int* out )
+{
+	const char* end = value + value_len;
+	unsigned int mask = 0;
+	while( 1 )
+	{
+		const char* value_end = value;
+		while( value_end < end && *value_end != ',' )
+			++value_end;
+
+		int index = getopt_find_choice( names, value, (size_t)( value_end - value ) );
+		if( index < 0 )
+			return -1;
+		mask |= 1u << index;
+
+		if( value_end == end )
+			break;
+		value = value_end + 1;
+	}
+	*out = mask;
+	return 0;
+}
+
+#if !defined(GETOPT_NO_UNITS)
+typedef struct getopt_unit
+{
+	const char* name;
+	uint64_t    multiplier;
+} getopt_unit_t;
+
+#define GETOPT_KILO 1000ull
+#define GETOPT_KIBI 1024ull
+
+static const getopt_unit_t GETOPT_SIZE_UNITS[] =
+{
+	{ "",    1 },
+	{ "B",   1 },
+	{ "k",   GETOPT_KILO },
+	{ "K",   GETOPT_KILO },
+	{ "kB",  GETOPT_KILO },
+	{ "KB",  GETOPT_KILO },
+	{ "M",   GETOPT_KILO * GETOPT_KILO },
+	{ "MB",  GETOPT_KILO * GETOPT_KILO },
+	{ "G",   GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "GB",  GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "T",   GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "TB",  GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "P",   GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "PB",  GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "E",   GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "EB",  GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO * GETOPT_KILO },
+	{ "Ki",  GETOPT_KIBI },
+	{ "KiB", GETOPT_KIBI },
+	{ "Mi",  GETOPT_KIBI * GETOPT_KIBI },
+	{ "MiB", GETOPT_KIBI * GETOPT_KIBI },
+	{ "Gi",  GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "GiB", GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "Ti",  GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "TiB", GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "Pi",  GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "PiB", GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "Ei",  GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ "EiB", GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI * GETOPT_KIBI },
+	{ 0x0,   0 }
+};
+
+/* durations are stored in nanoseconds */
+static const getopt_unit_t GETOPT_DURATION_UNITS[] =
+{
+	{ "",   1000000000ull },
+	{ "ns", 1ull },
+	{ "us", 1000ull },
+	{ "ms", 1000000ull },
+	{ "s",  1000000000ull },
+	{ "m",  60ull * 1000000000ull },
+	{ "h",  60ull * 60ull * 1000000000ull },
+	{ "d",  24ull * 60ull * 60ull * 1000000000ull },
+	{ 0x0,  0 }
+};
+
+/*
+	parse "<digits>[.<digits>]<unit>" where unit is one of 'units', only the 'str_len' first chars of str is used.
+	only the first 9 digits of the fraction is used so that the fraction can be scaled without overflow.
+	returns -1 on invalid number, unknown unit or overflow.
+*/
+static int getopt_parse_unit_value( const char* str, size_t str_len, const getopt_unit_t* units, uint64_t* out )
+{
+	const char* end = str + str_len;
+	const char* pos = str;
+
+	uint64_t whole = 0;
+	for( ; pos < end && *pos >= '0' && *pos <= '9'; ++pos )
+	{
+		uint64_t digit = (uint64_t)( *pos - '0' );
+		if( whole > ( UINT64_MAX - digit ) / 10 )
+			return -1;
+		whole = whole * 10 + digit;
+	}
+	int num_digits = (int)( pos - str );
+
+	uint64_t frac       = 0;
+	uint64_t frac_scale = 1;
+	if( pos < end && *pos == '.' )
+	{
+		for( ++pos; pos < end && *pos >= '0' && *pos <= '9'; ++pos, ++num_digits )
+		{
+			if( frac_scale < 1000000000ull )
+			{
+				frac = frac * 10 + (uint64_t)( *pos - '0' );
+				frac_scale *= 10;
+			}
+		}
+	}
+
+	if( num_digits == 0 )
+		return -1;
+
+	size_t unit_len = (size_t)( end - pos );
+	const getopt_unit_t* unit = units;
+	for( ; unit->name != 0x0; ++unit )
+		if( strlen( unit->name ) == unit_len && memcmp( unit->name, pos, unit_len ) == 0 )
+			break;
+	if( unit->name == 0x0 )
+		return -1;
+
+	uint64_t mult = unit->multiplier;
+	if( whole > UINT64_MAX / mult )
+		return -1;
+	whole *= mult;
+
+	/* frac < frac_scale <= 10^9, split mult so that no product overflow */
+	uint64_t frac_value = ( mult / frac_scale ) * frac + ( mult % frac_scale ) * frac / frac_scale;
+	if( whole > UINT64_MAX - frac_value )
+		return -1;
+
+	*out = whole + frac_value;
+	return 0;
+}
+
+static int getopt_read_unit_value( const getopt_option_t* opt, const char* str, size_t str_len, unsigned long long* out )
+{
+	uint64_t value   = 0;
+	int      res     = -1;
+	switch( opt->type )
+	{
+		case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+			res = getopt_parse_unit_value( str, str_len, GETOPT_SIZE_UNITS, &value );
+			break;
+		case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+			res = getopt_parse_unit_value( str, str_len, GETOPT_DURATION_UNITS, &value );
+			break;
+		case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+			/* "10k/s" or just "10k", the amount is always per second */
+			if( str_len >= 2 && str[str_len - 2] == '/' && str[str_len - 1] == 's' )
+				str_len -= 2;
+			res = getopt_parse_unit_value( str, str_len, GETOPT_SIZE_UNITS, &value );
+			break;
+		default:
+			break;
+	}
+
+	if( res < 0 )
+		return -1;
+	*out = (unsigned long long)value;
+	return 0;
+}
+#endif /* !defined(GETOPT_NO_UNITS) */
+
+/* length of the UTF-8 sequence starting with the non-ascii byte at s[i], 0 if it is invalid */
+static size_t getopt_utf8_sequence( const unsigned char* s, size_t i, size_t len )
+{
+	unsigned char c  = s[i];
+	unsigned char lo = 0x80;
+	unsigned char hi = 0xbf;
+	size_t n;
+	if( c >= 0xc2 && c <= 0xdf )
+		n = 2;
+	else if( c >= 0xe0 && c <= 0xef )
+	{
+		/* no overlongs and no surrogates */
+		n = 3;
+		if( c == 0xe0 ) lo = 0xa0;
+		if( c == 0xed ) hi = 0x9f;
+	}
+	else if( c >= 0xf0 && c <= 0xf4 )
+	{
+		/* no overlongs and nothing above U+10FFFF */
+		n = 4;
+		if( c == 0xf0 ) lo = 0x90;
+		if( c == 0xf4 ) hi = 0x8f;
+	}
+	else
+		return 0;
+
+	if( len - i < n || s[i + 1] < lo || s[i + 1] > hi )
+		return 0;
+	size_t k = 2;
+	for( ; k < n; ++k )
+		if( ( s[i + k] & 0xc0 ) != 0x80 )
+			return 0;
+	return n;
+}
+
+/* returns -1 if str is invalid, 0 if it is only ascii and 1 if it is valid and contains non-ascii chars */
+static int getopt_check_utf8( const char* str, size_t len, size_t* offset )
+{
+	const unsigned char* s = (const unsigned char*)str;
+	int non_ascii = 0;
+	size_t i = 0;
+	while( i < len )
+	{
+		/* whole blocks of ascii are skipped, only blocks with high bits set are decoded */
+#if defined(GETOPT_SSE2)
+		if( len - i >= 16 && _mm_movemask_epi8( _mm_loadu_si128( (const __m128i*)( s + i ) ) ) == 0 )
+		{
+			i += 16;
+			continue;
+		}
+#else
+		uint64_t block;
+		if( len - i >= 8 && ( memcpy( &block, s + i, 8 ), ( block & 0x8080808080808080ull ) == 0 ) )
+		{
+			i += 8;
+			continue;
+		}
+#endif
+		if( s[i] < 0x80 )
+		{
+			++i;
+			continue;
+		}
+
+		size_t n = getopt_utf8_sequence( s, i, len );
+		if( n == 0 )
+		{
+			*offset = i;
+			return -1;
+		}
+		non_ascii = 1;
+		i += n;
+	}
+	return non_ascii;
+}
+
+int getopt_validate_utf8( const char* str, size_t len, size_t* offset )
+{
+	return getopt_check_utf8( str, len, offset ) < 0 ? -1 : 0;
+}
+
+#if !defined(GETOPT_NO_BLOB)
+static int getopt_hex_nibble( unsigned char c )
+{
+	if( c >= '0' && c <= '9' )
+		return c - '0';
+	c = (unsigned char)( c | 0x20 );
+	if( c >= 'a' && c <= 'f' )
+		return c - 'a' + 10;
+	return -1;
+}
+
+#if defined(GETOPT_SSE2)
+/* decode 16 hex-digits to 8 bytes per step, returns number of chars decoded, stops at the first block with an invalid char */
+static size_t getopt_decode_hex_sse2( const char* str, size_t len, unsigned char* out )
+{
+	const __m128i before_0 = _mm_set1_epi8( '0' - 1 );
+	const __m128i after_9  = _mm_set1_epi8( '9' + 1 );
+	const __m128i before_a = _mm_set1_epi8( 'a' - 1 );
+	const __m128i after_f  = _mm_set1_epi8( 'f' + 1 );
+	const __m128i to_lower = _mm_set1_epi8( 0x20 );
+	const __m128i digit_0  = _mm_set1_epi8( '0' );
+	const __m128i alpha_0  = _mm_set1_epi8( 'a' - 10 );
+	const __m128i low_byte = _mm_set1_epi16( 0xff );
+
+	size_t i = 0;
+	for( ; i + 16 <= len; i += 16 )
+	{
+		/* bytes >= 0x80 are negative and fail both range-checks */
+		__m128i chars    = _mm_loadu_si128( (const __m128i*)( str + i ) );
+		__m128i lower    = _mm_or_si128( chars, to_lower );
+		__m128i is_digit = _mm_and_si128( _mm_cmpgt_epi8( chars, before_0 ), _mm_cmplt_epi8( chars, after_9 ) );
+		__m128i is_alpha = _mm_and_si128( _mm_cmpgt_epi8( lower, before_a ), _mm_cmplt_epi8( lower, after_f ) );
+		if( _mm_movemask_epi8( _mm_or_si128( is_digit, is_alpha ) ) != 0xffff )
+			break;
+
+		__m128i nibbles = _mm_or_si128( _mm_and_si128( is_digit, _mm_sub_epi8( chars, digit_0 ) ),
+		                                _mm_and_si128( is_alpha, _mm_sub_epi8( lower, alpha_0 ) ) );
+
+		/* the first digit of each pair is the low byte of a 16-bit lane and the high nibble of the result */
+		__m128i bytes = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( nibbles, low_byte ), 4 ), _mm_srli_epi16( nibbles, 8 ) );
+		if( out )
+			_mm_storel_epi64( (__m128i*)( out + i / 2 ), _mm_packus_epi16( bytes, bytes ) );
+	}
+	return i;
+}
+#endif
+
+static int getopt_decode_hex( const char* str, size_t len, unsigned char* out, size_t* result )
+{
+	size_t i = 0;
+#if defined(GETOPT_SSE2)
+	i = getopt_decode_hex_sse2( str, len & ~(size_t)1, out );
+#endif
+	for( ; i + 1 < len; i += 2 )
+	{
+		int high = getopt_hex_nibble( (unsigned char)str[i] );
+		int low  = getopt_hex_nibble( (unsigned char)str[i + 1] );
+		if( ( high | low ) < 0 )
+		{
+			*result = high < 0 ? i : i + 1;
+			return -1;
+		}
+		if( out )
+			out[i / 2] = (unsigned char)( ( high << 4 ) | low );
+	}
+
+	/* the digit that is missing in a odd-length value */
+	if( i < len )
+	{
+		*result = getopt_hex_nibble( (unsigned char)str[i] ) < 0 ? i : len;
+		return -1;
+	}
+	*result = len / 2;
+	return 0;
+}
+
+/* value of each char in base64, -1 if it is not in the alphabet */
+static const signed char getopt_base64_table[256] =
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+	-1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+	-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/*
+	stays scalar, sse2 has no byte-shuffle to pack 4 chars of 6 bits to 3 bytes and the table-lookup is one load
+	per char. Hex is the common format for keys and digests, that one is decoded with sse2.
+*/
+static int getopt_decode_base64( const char* str, size_t len, unsigned char* out, size_t* result )
+{
+	/* padding is optional, but if it is there the length has to be a multiple of 4 */
+	size_t data_len = len;
+	while( data_len > 0 && len - data_len < 2 && str[data_len - 1] == '=' )
+		--data_len;
+	if( data_len != len && len % 4 != 0 )
+	{
+		*result = data_len;
+		return -1;
+	}
+
+	size_t i = 0;
+	size_t o = 0;
+	for( ; i + 4 <= data_len; i += 4, o += 3 )
+	{
+		int a = getopt_base64_table[(unsigned char)str[i]];
+		int b = getopt_base64_table[(unsigned char)str[i + 1]];
+		int c = getopt_base64_table[(unsigned char)str[i + 2]];
+		int d = getopt_base64_table[(unsigned char)str[i + 3]];
+		if( ( a | b | c | d ) < 0 )
+			break;
+
+		if( out )
+		{
+			unsigned int bits = ( (unsigned int)a << 18 ) | ( (unsigned int)b << 12 ) | ( (unsigned int)c << 6 ) | (unsigned int)d;
+			out[o]     = (unsigned char)( bits >> 16 );
+			out[o + 1] = (unsigned char)( bits >> 8 );
+			out[o + 2] = (unsigned char)bits;
+		}
+	}
+
+	/* 2 or 3 chars left gives 1 or 2 bytes, an invalid char in the block that stopped the loop is found here */
+	unsigned int bits = 0;
+	size_t rest = 0;
+	for( ; i + rest < data_len && rest < 4; ++rest )
+	{
+		int v = getopt_base64_table[(unsigned char)str[i + rest]];
+		if( v < 0 )
+		{
+			*result = i + rest;
+			return -1;
+		}
+		bits = ( bits << 6 ) | (unsigned int)v;
+	}
+	if( rest == 1 )
+	{
+		*result = data_len;
+		return -1;
+	}
+	if( rest > 1 )
+	{
+		bits <<= 6 * ( 4 - rest );
+		if( out )
+		{
+			out[o] = (unsigned char)( bits >> 16 );
+			if( rest == 3 )
+				out[o + 1] = (unsigned char)( bits >> 8 );
+		}
+		o += rest - 1;
+	}
+
+	*result = o;
+	return 0;
+}
+
+static int getopt_decode_blob_len( getopt_option_type_t type, const char* str, size_t len, unsigned char* out, size_t* result )
+{
+	return type == GETOPT_OPTION_TYPE_REQUIRED_HEX ? getopt_decode_hex( str, len, out, result ) : getopt_decode_base64( str, len, out, result );
+}
+
+int getopt_decode_blob( const getopt_option_t* opt, const char* str, void* out, size_t out_size, size_t* result )
+{
+	if( opt->type != GETOPT_OPTION_TYPE_REQUIRED_HEX && opt->type != GETOPT_OPTION_TYPE_REQUIRED_BASE64 )
+		return -1;
+
+	size_t len      = strlen( str );
+	size_t max_size = opt->type == GETOPT_OPTION_TYPE_REQUIRED_HEX ? len / 2 : len / 4 * 3 + 2;
+	if( out == 0x0 || out_size >= max_size )
+		return getopt_decode_blob_len( opt->type, str, len, (unsigned char*)out, result );
+
+	/* might not fit, validate and get the exact size first */
+	if( getopt_decode_blob_len( opt->type, str, len, 0x0, result ) < 0 )
+		return -1;
+	if( *result > out_size )
+		return -2;
+	return getopt_decode_blob_len( opt->type, str, len, (unsigned char*)out, result );
+}
+
+#endif /* !defined(GETOPT_NO_BLOB) */
+
+#if !defined(GETOPT_NO_PATTERN)
+int getopt_create_patterns( getopt_context_t* ctx, getopt_pattern_t* patterns, int patterns_size, unsigned short* table, size_t table_size )
+{
+	getopt_glushkov_t g;
+	int num_patterns = 0;
+	size_t used = 0;
+	int opt_index = 0;
+	for( ; opt_index < ctx->num_opts; ++opt_index )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, opt_index );
+		if( opt->type != GETOPT_OPTION_TYPE_REQUIRED_PATTERN )
+			continue;
+		if( num_patterns == patterns_size )
+			return -1;
+
+		/* patterns are validated by getopt_create_context() */
+		getopt_pattern_t* pattern = patterns + num_patterns++;
+		pattern->opt  = opt;
+		pattern->next = 0x0;
+		getopt_pattern_compile( opt->value_desc, &g );
+
+		int res = getopt_pattern_build_dfa( &g, pattern, table ? table + used : 0x0, table_size - used );
+		if( res < 0 )
+			return -1;
+		used += (size_t)res;
+	}
+
+	if( table )
+	{
+		ctx->patterns     = patterns;
+		ctx->num_patterns = num_patterns;
+	}
+	return (int)used;
+}
+#endif /* !defined(GETOPT_NO_PATTERN) */
+
+#if !defined(GETOPT_NO_BLOB)
+void getopt_set_blob_buffer( getopt_context_t* ctx, void* buffer, size_t buffer_size )
+{
+	ctx->blob_buffer = (unsigned char*)buffer;
+	ctx->blob_size   = buffer ? buffer_size : 0;
+	ctx->blob_used   = 0;
+}
+#endif /* !defined(GETOPT_NO_BLOB) */
+
+int getopt_convert_value_len( const getopt_option_t* opt, const char* str, size_t len, getopt_typed_value_t* out )
+{
+	switch(opt->type)
+	{
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+		{
+			/* strtol() and strtof() need a NUL-terminated string */
+			char number[64];
+			if( len >= sizeof( number ) )
+				return -1;
+			memcpy( number, str, len );
+			number[len] = '\0';
+			return getopt_convert_value( opt, number, out );
+		}
+		case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+			out->i32 = getopt_find_choice( opt->value_desc, str, len );
+			return out->i32 >= 0 ? 0 : -1;
+		case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+			return getopt_read_bitmask( opt->value_desc, str, len, &out->u32 );
+#if !defined(GETOPT_NO_UNITS)
+		case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+		case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+		case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+			return getopt_read_unit_value( opt, str, len, &out->u64 );
+#endif
+#if !defined(GETOPT_NO_PATTERN)
+		case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+		{
+			size_t offset;
+			return getopt_pattern_match( opt->value_desc, str, len, &offset );
+		}
+#endif
+#if !defined(GETOPT_NO_BLOB)
+		case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+		case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+		{
+			size_t size;
+			if( getopt_decode_blob_len( opt->type, str, len, 0x0, &size ) < 0 )
+				return -1;
+			out->u64 = (unsigned long long)size;
+			return 0;
+		}
+#endif
+		default:
+			return -1;
+	}
+}
+
+int getopt_convert_value( const getopt_option_t* opt, const char* str, getopt_typed_value_t* out )
+{
+	switch(opt->type)
+	{
+#if !defined(GETOPT_NO_INT)
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+		{
+			char* end = 0x0;
+			out->i32 = (int)strtol(str, &end, 0);
+			return *end == '\0' ? 0 : -1;
+		}
+#else
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			return -1;
+#endif
+#if !defined(GETOPT_NO_FLOAT)
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+		{
+			char* end = 0x0;
+			out->fp32 = strtof(str, &end);
+			return *end == '\0' ? 0 : -1;
+		}
+#else
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+			return -1;
+#endif
+		default:
+			return getopt_convert_value_len( opt, str, strlen( str ), out );
+	}
+}
+
+static GETOPT_INLINE int getopt_read_value(getopt_context_t* ctx, const getopt_option_t* found_opt)
+{
+	if( getopt_convert_value( found_opt, ctx->current_opt_arg, &ctx->current_value ) < 0 )
+	{
+		ctx->current_opt_arg = found_opt->name;
+		return '!';
+	}
+	return found_opt->value;
+}
+
+#if !defined(GETOPT_NO_PATH)
+#if !defined(GETOPT_PATH_MAX_THREADS)
+#   define GETOPT_PATH_MAX_THREADS 32 /* max number of threads started by getopt_check_paths() */
+#endif
+#define GETOPT_PATH_PER_THREAD 8 /* a thread is not started for fewer paths than this */
+
+static unsigned int getopt_path_checks( getopt_option_type_t type )
+{
+	switch( type )
+	{
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:     return GETOPT_PATH_CHECK_EXISTS | GETOPT_PATH_CHECK_FILE;
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:      return GETOPT_PATH_CHECK_EXISTS | GETOPT_PATH_CHECK_DIR;
+		case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE: return GETOPT_PATH_CHECK_EXISTS | GETOPT_PATH_CHECK_READABLE;
+		default:                                        return GETOPT_PATH_CHECK_EXISTS;
+	}
+}
+
+/* run the checks of one path and store the result in it */
+static void getopt_check_path( getopt_path_t* path )
+{
+	path->failed = 0;
+	path->error  = 0;
+	if( path->checks == 0 )
+		return;
+
+#if defined(_MSC_VER)
+	struct _stat st;
+	int err = _stat( path->path, &st );
+#else
+	struct stat st;
+	int err = stat( path->path, &st );
+#endif
+	if( err != 0 )
+	{
+		path->failed = GETOPT_PATH_CHECK_EXISTS;
+		path->error  = errno;
+		return;
+	}
+
+	if( ( path->checks & GETOPT_PATH_CHECK_FILE ) && !S_ISREG( st.st_mode ) )
+		path->failed = GETOPT_PATH_CHECK_FILE;
+	else if( ( path->checks & GETOPT_PATH_CHECK_DIR ) && !S_ISDIR( st.st_mode ) )
+		path->failed = GETOPT_PATH_CHECK_DIR;
+	else if( path->checks & GETOPT_PATH_CHECK_READABLE )
+	{
+#if defined(_MSC_VER)
+		err = _access( path->path, 4 );
+#else
+		err = access( path->path, R_OK );
+#endif
+		if( err != 0 )
+		{
+			path->failed = GETOPT_PATH_CHECK_READABLE;
+			path->error  = errno;
+		}
+	}
+}
+
+/* the paths checked by one thread, every step:th path starting at first */
+typedef struct getopt_path_worker
+{
+	getopt_path_t* paths;
+	int            num_paths;
+	int            first;
+	int            step;
+} getopt_path_worker_t;
+
+static void getopt_path_run_worker( const getopt_path_worker_t* worker )
+{
+	int i = worker->first;
+	for( ; i < worker->num_paths; i += worker->step )
+		getopt_check_path( worker->paths + i );
+}
+
+#if !defined(GETOPT_NO_PATH_THREADS)
+static void* getopt_path_thread( void* worker )
+{
+	getopt_path_run_worker( (const getopt_path_worker_t*)worker );
+	return 0x0;
+}
+#endif
+
+int getopt_create_path_batch( getopt_context_t* ctx, getopt_path_t* paths, int paths_size )
+{
+	if( paths_size < 0 )
+		return -1;
+
+	ctx->paths      = paths;
+	ctx->paths_size = paths_size;
+	ctx->num_paths  = 0;
+	return 0;
+}
+
+int getopt_add_path( getopt_context_t* ctx, const char* path, unsigned int checks )
+{
+	if( ctx->paths == 0x0 || ctx->num_paths >= ctx->paths_size )
+		return -1;
+
+	getopt_path_t* entry = ctx->paths + ctx->num_paths++;
+	entry->path   = path;
+	entry->opt    = 0x0;
+	entry->checks = checks;
+	entry->failed = 0;
+	entry->error  = 0;
+	return 0;
+}
+
+int getopt_check_paths( getopt_context_t* ctx, const getopt_path_t** failed, int failed_size )
+{
+	if( ctx->paths == 0x0 || ctx->num_paths > ctx->paths_size )
+		return -1;
+
+	/* the checks are latency-bound, not cpu-bound, so more threads than cores is fine */
+	getopt_path_worker_t workers[GETOPT_PATH_MAX_THREADS + 1];
+	int num_workers = ctx->num_paths / GETOPT_PATH_PER_THREAD;
+#if defined(GETOPT_NO_PATH_THREADS)
+	num_workers = 1;
+#endif
+	if( num_workers < 1 )
+		num_workers = 1;
+	if( num_workers > GETOPT_PATH_MAX_THREADS + 1 )
+		num_workers = GETOPT_PATH_MAX_THREADS + 1;
+
+	int i = 0;
+	for( ; i < num_workers; ++i )
+	{
+		workers[i].paths     = ctx->paths;
+		workers[i].num_paths = ctx->num_paths;
+		workers[i].first     = i;
+		workers[i].step      = num_workers;
+	}
+
+#if !defined(GETOPT_NO_PATH_THREADS)
+	/* worker 0 runs on the calling thread, as do workers that no thread could be started for */
+	pthread_t threads[GETOPT_PATH_MAX_THREADS];
+	int num_threads = 0;
+	while( num_threads < num_workers - 1 && pthread_create( &threads[num_threads], 0x0, getopt_path_thread, &workers[num_threads + 1] ) == 0 )
+		++num_threads;
+
+	getopt_path_run_worker( &workers[0] );
+	for( i = num_threads + 1; i < num_workers; ++i )
+		getopt_path_run_worker( &workers[i] );
+	for( i = 0; i < num_threads; ++i )
+		pthread_join( threads[i], 0x0 );
+#else
+	getopt_path_run_worker( &workers[0] );
+#endif
+
+	int num_failed = 0;
+	for( i = 0; i < ctx->num_paths; ++i )
+	{
+		if( ctx->paths[i].failed == 0 )
+			continue;
+		if( num_failed < failed_size )
+			failed[num_failed] = ctx->paths + i;
+		++num_failed;
+	}
+	return num_failed;
+}
+#endif /* !defined(GETOPT_NO_PATH) */
+
+/* validate, and normalize if there is a normalizer, the argument to a string-option */
+static GETOPT_INLINE int getopt_read_text( getopt_context_t* ctx, const getopt_option_t* found_opt )
+{
+	const char* arg = ctx->current_opt_arg;
+	size_t len = strlen( arg );
+	size_t offset;
+	int res = getopt_check_utf8( arg, len, &offset );
+	if( res < 0 )
+	{
+		ctx->current_value.u64 = (unsigned long long)offset;
+		ctx->current_opt_arg   = found_opt->name;
+		return '!';
+	}
+
+	if( res > 0 && ctx->normalize_func )
+	{
+		char*  out      = ctx->text_buffer ? ctx->text_buffer + ctx->text_used : 0x0;
+		size_t out_size = ctx->text_size - ctx->text_used;
+		size_t out_len  = ctx->normalize_func( arg, len, out, out_size, ctx->normalize_userdata );
+		if( out_len >= out_size )
+		{
+			ctx->current_index = ctx->argc;
+			return '#';
+		}
+
+		/* unchanged arguments are not kept in the buffer */
+		if( out_len != len || memcmp( out, arg, len ) != 0 )
+		{
+			out[out_len] = '\0';
+			ctx->current_opt_arg = out;
+			ctx->text_used      += out_len + 1;
+		}
+	}
+	return found_opt->value;
+}
+
+/* match the argument of a PATTERN option with its DFA if it is compiled, otherwise by simulation */
+static GETOPT_INLINE int getopt_read_pattern( getopt_context_t* ctx, const getopt_option_t* found_opt )
+{
+#if !defined(GETOPT_NO_PATTERN)
+	const getopt_pattern_t* pattern = 0x0;
+	int i = 0;
+	for( ; i < ctx->num_patterns; ++i )
+	{
+		if( ctx->patterns[i].opt == found_opt )
+		{
+			pattern = ctx->patterns + i;
+			break;
+		}
+	}
+
+	size_t offset;
+	int res = pattern && pattern->next ? getopt_pattern_match_dfa( pattern, ctx->current_opt_arg, &offset )
+	                                   : getopt_pattern_match( found_opt->value_desc, ctx->current_opt_arg, strlen( ctx->current_opt_arg ), &offset );
+	if( res < 0 )
+	{
+		ctx->current_value.u64 = (unsigned long long)offset;
+		ctx->current_opt_arg   = found_opt->name;
+		return '!';
+	}
+#else
+	(void)ctx;
+#endif
+	return found_opt->value;
+}
+
+/* decode the argument of a HEX or BASE64 option into the blob-buffer if it fits, otherwise only validate it */
+static GETOPT_INLINE int getopt_read_blob( getopt_context_t* ctx, const getopt_option_t* found_opt )
+{
+#if !defined(GETOPT_NO_BLOB)
+	unsigned char* out = ctx->blob_buffer ? ctx->blob_buffer + ctx->blob_used : 0x0;
+	size_t result;
+	int res = getopt_decode_blob( found_opt, ctx->current_opt_arg, out, ctx->blob_size - ctx->blob_used, &result );
+	ctx->current_value.u64 = (unsigned long long)result;
+	if( res == -1 )
+	{
+		ctx->current_opt_arg = found_opt->name;
+		return '!';
+	}
+
+	if( res == 0 && out != 0x0 )
+	{
+		ctx->current_blob = out;
+		ctx->blob_used   += result;
+	}
+#else
+	(void)ctx;
+#endif
+	return found_opt->value;
+}
+
+/* add the argument of a PATH option to the path-batch, or check it right away if there is none */
+static GETOPT_INLINE int getopt_read_path( getopt_context_t* ctx, const getopt_option_t* found_opt )
+{
+#if !defined(GETOPT_NO_PATH)
+	getopt_path_t  tmp;
+	getopt_path_t* path = &tmp;
+	if( ctx->paths )
+	{
+		/* an overflow is counted and reported by getopt_check_paths() */
+		if( ctx->num_paths++ >= ctx->paths_size )
+			return found_opt->value;
+		path = ctx->paths + ctx->num_paths - 1;
+	}
+
+	path->path   = ctx->current_opt_arg;
+	path->opt    = found_opt;
+	path->checks = getopt_path_checks( found_opt->type );
+	path->failed = 0;
+	path->error  = 0;
+	if( ctx->paths )
+		return found_opt->value; /* checked by getopt_check_paths() */
+
+	getopt_check_path( path );
+	if( path->failed != 0 )
+	{
+		ctx->current_opt_arg = found_opt->name;
+		return '!';
+	}
+#else
+	(void)ctx;
+#endif
+	return found_opt->value;
+}
+
+/*
+	find the option and argument of the next token in ctx and advance ctx->current_index past it, without acting on it.
+	returns 0 if an option was found, otherwise what getopt_next() should return with *out_arg set to the token.
+	*out_match is set to the GETOPT_MATCH_-bits for how the option was given.
+*/
+static GETOPT_INLINE int getopt_parse_token( getopt_context_t* ctx, const getopt_option_t** out_opt, const char** out_arg, unsigned int* out_match )
+{
+	*out_match = 0;
+
+	/* are all options processed? */
+	if(ctx->current_index == ctx->argc )
+		return -1;
+
+	const char* curr_token = ctx->argv[ ctx->current_index ];
+	
+	/* this token has been processed! */
+	ctx->current_index++;
+
+	/* check if item is no option */
+	if( curr_token[0] && curr_token[0] != '-' )
+	{
+		*out_arg = curr_token;
+		return '+'; /* return '+' as identifier for no option! */
+	}
+	
+	const getopt_option_t* found_opt = 0x0;
+	const char* found_arg = 0x0;
+
+	/* short opt */
+	if( curr_token[1] != '\0' && curr_token[1] != '-' && curr_token[2] == '\0' )
+	{
+		found_opt = getopt_find_short_opt( ctx, curr_token[1] );
+
+		/* if there is an value when: - current_index < argc and value in argv[current_index] do not start with '-' */
+		if( found_opt != 0x0 &&
+			( ( ctx->current_index != ctx->argc) && ( ctx->argv[ctx->current_index][0] != '-' ) ) && 
+			  getopt_opt_might_have_arg(found_opt) )
+		{
+			found_arg = ctx->argv[ctx->current_index];
+			ctx->current_index++; /* next token has been processed aswell! */
+		}
+	}
+	/* long opt */
+	else if(curr_token[1] == '-' && curr_token[2] != '\0')
+	{
+		const char* check_option = curr_token + 2;
+
+		/* the option-name is everything up to an '=' */
+		size_t name_len = 0;
+		while( check_option[name_len] != '\0' && check_option[name_len] != '=' )
+			++name_len;
+
+		found_opt = getopt_find_long_opt( ctx, check_option, name_len, out_match );
+
+		/* find arg if there is any */
+		if( found_opt != 0x0 && getopt_opt_might_have_arg(found_opt) )
+		{
+			check_option += name_len;
+
+			switch( *check_option )
+			{
+				case '\0':
+				{
+					if( ctx->current_index < ctx->argc ) /* are there more tokens that can contain the '='? */
+					{
+						const char* next_token = ctx->argv[ ctx->current_index ];
+						if( next_token[0] == '=' )
+						{
+							ctx->current_index++; /* next token has been processed aswell! */
+
+							if( next_token[1] != '\0' ) /* does this token contain the arg-value? */
+								found_arg = next_token + 1;
+							else if( ctx->current_index < ctx->argc )
+								found_arg = ctx->argv[ ctx->current_index++ ]; /* next token has been processed aswell! */
+						}
+						else if( next_token[0] != '-' )
+						{
+							ctx->current_index++; /* next token has been processed aswell! */
+							found_arg = next_token;
+						}
+					}
+				}
+				break;
+				case '=':
+					if( check_option[1] != '\0' )
+						found_arg = check_option + 1;
+					else if( ctx->current_index < ctx->argc )
+						found_arg = ctx->argv[ ctx->current_index++ ]; /* next token has been processed aswell! */
+				break;
+			}
+		}
+	}
+	/* malformed opt "-", "-xyz" or "--" */
+	else
+	{
+		*out_arg = curr_token;
+		return '!';
+	}
+
+	/* found no matching option! */
+	if(found_opt == 0x0)
+	{
+		*out_arg = curr_token;
+		return '?';
+	}
+
+	*out_opt = found_opt;
+	*out_arg = found_arg;
+	return 0;
+}
+
+/*
+	count 'token' against the limits in ctx, 'lookup' is set if the token will be looked up as an option.
+	the token is never scanned further than max_token_len and the operations are counted before any work is done,
+	except for abbreviations where the names compared are counted by the lookup.
+	returns -1 if a limit is exceeded.
+*/
+static GETOPT_INLINE int getopt_charge_token( getopt_context_t* ctx, const char* token, int lookup )
+{
+	const getopt_limits_t* limits = ctx->limits;
+
+	size_t token_len = 0;
+	while( token[token_len] != '\0' && ( limits->max_token_len == 0 || token_len <= limits->max_token_len ) )
+		++token_len;
+	if( limits->max_token_len != 0 && token_len > limits->max_token_len )
+		return -1;
+
+	ctx->used_bytes += token_len;
+	if( limits->max_total_bytes != 0 && ctx->used_bytes > limits->max_total_bytes )
+		return -1;
+
+	/*
+		worst case for the lookup of a long option, every char in the token is compared against every candidate.
+		short options are found in a table, one lookup per char.
+	*/
+	unsigned long ops = (unsigned long)token_len;
+	if( lookup && token[0] == '-' && token[1] == '-' )
+	{
+		if( ctx->index != 0x0 )
+			ops += getopt_log2_ceil( ctx->index_size ) * (unsigned long)( token_len + 1 );
+		else
+			ops += (unsigned long)ctx->num_opts;
+	}
+
+	ctx->used_ops += ops;
+	if( limits->max_ops != 0 && ctx->used_ops > limits->max_ops )
+		return -1;
+	return 0;
+}
+
+#if !defined(GETOPT_NO_GLOB)
+/* length of the '/'-separated component at str */
+static size_t getopt_glob_part_len( const char* str )
+{
+	size_t len = 0;
+	while( str[len] != '\0' && str[len] != '/' )
+		++len;
+	return len;
+}
+
+static int getopt_glob_has_magic( const char* str )
+{
+	for( ; *str != '\0'; ++str )
+		if( *str == '*' || *str == '?' || *str == '[' )
+			return 1;
+	return 0;
+}
+
+static int getopt_glob_is_globstar( const char* pat )
+{
+	return pat[0] == '*' && pat[1] == '*' && ( pat[2] == '\0' || pat[2] == '/' );
+}
+
+/* match c against the class starting with '[' at pat, returns length of the class or 0 if it is not closed */
+static size_t getopt_glob_match_class( const char* pat, size_t pat_len, char c, int* match )
+{
+	size_t i      = 1;
+	int    negate = i < pat_len && ( pat[i] == '!' || pat[i] == '^' );
+	i += (size_t)negate;
+
+	/* a ']' first in the class is part of it */
+	size_t first = i;
+	*match = 0;
+	for( ; i < pat_len && ( pat[i] != ']' || i == first ); ++i )
+	{
+		if( i + 2 < pat_len && pat[i + 1] == '-' && pat[i + 2] != ']' )
+		{
+			if( (unsigned char)c >= (unsigned char)pat[i] && (unsigned char)c <= (unsigned char)pat[i + 2] )
+				*match = 1;
+			i += 2;
+		}
+		else if( pat[i] == c )
+			*match = 1;
+	}
+	if( i >= pat_len )
+		return 0;
+
+	*match ^= negate;
+	return i + 1;
+}
+
+/* match one path-component against one pattern-component with '*', '?' and '[...]' */
+static int getopt_glob_match_part( const char* pat, size_t pat_len, const char* name, size_t name_len )
+{
+	/* hidden files are only matched by a pattern starting with '.' */
+	if( name_len > 0 && name[0] == '.' && ( pat_len == 0 || pat[0] != '.' ) )
+		return 0;
+
+	/* on mismatch, retry from the last '*' with it matching one more char */
+	size_t p = 0;
+	size_t n = 0;
+	size_t star_p = pat_len + 1;
+	size_t star_n = 0;
+	while( n < name_len )
+	{
+		if( p < pat_len && pat[p] == '*' )
+		{
+			star_p = ++p;
+			star_n = n;
+			continue;
+		}
+
+		if( p < pat_len )
+		{
+			int    match     = 0;
+			size_t class_len = pat[p] == '[' ? getopt_glob_match_class( pat + p, pat_len - p, name[n], &match ) : 0;
+			if( class_len == 0 )
+			{
+				match     = pat[p] == '?' || pat[p] == name[n];
+				class_len = 1;
+			}
+			if( match )
+			{
+				p += class_len;
+				++n;
+				continue;
+			}
+		}
+
+		if( star_p > pat_len )
+			return 0;
+		p = star_p;
+		n = ++star_n;
+	}
+
+	while( p < pat_len && pat[p] == '*' )
+		++p;
+	return p == pat_len;
+}
+
+/* does the relative path match pat, "**" as a whole component matches any number of components */
+static int getopt_glob_match_path( const char* pat, const char* path )
+{
+	while( 1 )
+	{
+		if( getopt_glob_is_globstar( pat ) )
+		{
+			const char* rest = pat[2] == '/' ? pat + 3 : pat + 2;
+			if( *rest == '\0' )
+				return 1;
+
+			/* try the rest of the pattern at each component, "**" do not pass hidden directories */
+			while( 1 )
+			{
+				if( getopt_glob_match_path( rest, path ) )
+					return 1;
+
+				size_t len = getopt_glob_part_len( path );
+				if( path[0] == '.' || path[len] == '\0' )
+					return 0;
+				path += len + 1;
+			}
+		}
+
+		size_t pat_len  = getopt_glob_part_len( pat );
+		size_t name_len = getopt_glob_part_len( path );
+		if( !getopt_glob_match_part( pat, pat_len, path, name_len ) )
+			return 0;
+
+		pat  += pat_len;
+		path += name_len;
+		if( *pat == '\0' || *path == '\0' )
+			return *pat == *path;
+		++pat;
+		++path;
+	}
+}
+
+/* might something below the directory at the relative path match pat */
+static int getopt_glob_match_dir( const char* pat, const char* path )
+{
+	while( 1 )
+	{
+		if( getopt_glob_is_globstar( pat ) )
+		{
+			/* as in getopt_glob_match_path(), "**" do not pass hidden directories but the rest of the pattern might */
+			const char* rest = pat[2] == '/' ? pat + 3 : pat + 2;
+			while( 1 )
+			{
+				if( *rest != '\0' && getopt_glob_match_dir( rest, path ) )
+					return 1;
+
+				size_t len = getopt_glob_part_len( path );
+				if( path[0] == '.' )
+					return 0;
+				if( path[len] == '\0' )
+					return 1;
+				path += len + 1;
+			}
+		}
+
+		size_t pat_len  = getopt_glob_part_len( pat );
+		size_t name_len = getopt_glob_part_len( path );
+		if( !getopt_glob_match_part( pat, pat_len, path, name_len ) )
+			return 0;
+
+		pat  += pat_len;
+		path += name_len;
+		if( *pat == '\0' )
+			return 0;
+		++pat;
+		if( *path == '\0' )
+			return 1;
+		++path;
+	}
+}
+
+static int getopt_glob_entry_cmp( const void* a, const void* b )
+{
+	/* skip the type-char */
+	return strcmp( *(const char* const*)a + 1, *(const char* const*)b + 1 );
+}
+
+/* store name of type 'type' as an entry of the directory being read, returns -1 if it do not fit */
+static int getopt_glob_add_entry( getopt_glob_t* glob, const char* name, char type )
+{
+	if( name[0] == '.' && ( name[1] == '\0' || ( name[1] == '.' && name[2] == '\0' ) ) )
+		return 0;
+
+	size_t size = strlen( name ) + 2;
+	if( (size_t)( (char*)glob->entries_top - glob->names_top ) < size + sizeof( const char* ) )
+		return -1;
+
+	*--glob->entries_top = glob->names_top;
+	glob->names_top[0] = type;
+	memcpy( glob->names_top + 1, name, size - 1 );
+	glob->names_top += size;
+	return 0;
+}
+
+/* read all entries of the directory fd, 'd' for directories, 'f' for files, 'l' for symlinks and '?' if unknown */
+static int getopt_glob_read_dir( getopt_glob_t* glob, int fd )
+{
+#if defined(__linux__)
+	/* getdents64 reads many entries per syscall into memory on the stack, opendir() would allocate */
+	union { unsigned long long align; char data[8192]; } dirents;
+	while( 1 )
+	{
+		long bytes = syscall( SYS_getdents64, fd, dirents.data, sizeof( dirents.data ) );
+		if( bytes < 0 )
+			return -1;
+		if( bytes == 0 )
+			return 0;
+
+		long offset = 0;
+		while( offset < bytes )
+		{
+			/* struct linux_dirent64 { u64 d_ino; s64 d_off; u16 d_reclen; u8 d_type; char d_name[]; } */
+			const char*    dirent = dirents.data + offset;
+			unsigned short reclen;
+			memcpy( &reclen, dirent + 16, sizeof( reclen ) );
+
+			char type;
+			switch( dirent[18] )
+			{
+				case 4:  type = 'd'; break; /* DT_DIR */
+				case 8:  type = 'f'; break; /* DT_REG */
+				case 10: type = 'l'; break; /* DT_LNK */
+				default: type = '?'; break;
+			}
+			if( getopt_glob_add_entry( glob, dirent + 19, type ) < 0 )
+				return -1;
+			offset += reclen;
+		}
+	}
+#else
+	/* a dup, the fd of the level is still needed for openat() after closedir() */
+	int dir_fd = dup( fd );
+	DIR* dir = dir_fd >= 0 ? fdopendir( dir_fd ) : 0x0;
+	if( dir == 0x0 )
+	{
+		if( dir_fd >= 0 )
+			close( dir_fd );
+		return -1;
+	}
+
+	int res = 0;
+	struct dirent* entry;
+	while( res == 0 && ( entry = readdir( dir ) ) != 0x0 )
+	{
+		char type = '?';
+#if defined(DT_DIR)
+		if( entry->d_type == DT_DIR )      type = 'd';
+		else if( entry->d_type == DT_REG ) type = 'f';
+		else if( entry->d_type == DT_LNK ) type = 'l';
+#endif
+		res = getopt_glob_add_entry( glob, entry->d_name, type );
+	}
+	closedir( dir );
+	return res;
+#endif
+}
+
+/* open the directory fd as a new level with its entries sorted, takes ownership of fd */
+static int getopt_glob_push( getopt_glob_t* glob, int fd, size_t path_len )
+{
+	if( glob->depth == GETOPT_GLOB_MAX_DEPTH )
+	{
+		close( fd );
+		return -1;
+	}
+
+	getopt_glob_level_t* level = glob->levels + glob->depth;
+	const char** entries_end = glob->entries_top;
+	level->names_top = glob->names_top;
+	if( getopt_glob_read_dir( glob, fd ) < 0 )
+	{
+		glob->names_top   = level->names_top;
+		glob->entries_top = entries_end;
+		close( fd );
+		return -1;
+	}
+
+	level->fd          = fd;
+	level->entries     = glob->entries_top;
+	level->num_entries = (int)( entries_end - glob->entries_top );
+	level->pos         = 0;
+	level->path_len    = path_len;
+	qsort( (void*)level->entries, (size_t)level->num_entries, sizeof( const char* ), getopt_glob_entry_cmp );
+	++glob->depth;
+	return 0;
+}
+
+static void getopt_glob_pop( getopt_glob_t* glob )
+{
+	getopt_glob_level_t* level = glob->levels + --glob->depth;
+	close( level->fd );
+	glob->entries_top = level->entries + level->num_entries;
+	glob->names_top   = level->names_top;
+}
+
+/* is the entry in the directory fd a directory, symlinks are only followed if 'follow' is set */
+static int getopt_glob_is_dir( int fd, const char* entry, int follow )
+{
+	if( entry[0] == 'd' || entry[0] == 'f' || ( entry[0] == 'l' && !follow ) )
+		return entry[0] == 'd';
+
+	struct stat st;
+	if( fstatat( fd, entry + 1, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW ) != 0 )
+		return 0;
+	return S_ISDIR( st.st_mode );
+}
+
+/*
+	produce the next path matching the pattern in ctx->glob, returns '+' with the path in current_opt_arg,
+	'!' on error or 0 when there are no more paths.
+*/
+static int getopt_glob_step( getopt_context_t* ctx )
+{
+	getopt_glob_t* glob = ctx->glob;
+	while( glob->depth > 0 )
+	{
+		getopt_glob_level_t* level = glob->levels + glob->depth - 1;
+		if( level->pos == level->num_entries )
+		{
+			getopt_glob_pop( glob );
+			continue;
+		}
+
+		const char* entry    = level->entries[level->pos++];
+		size_t      name_len = strlen( entry + 1 );
+		if( level->path_len + name_len + 1 >= sizeof( glob->path ) )
+			break;
+
+		/* the path of the directory is still in 'path', only the '/' might have been overwritten */
+		if( glob->depth > 1 )
+			glob->path[level->path_len - 1] = '/';
+		memcpy( glob->path + level->path_len, entry + 1, name_len + 1 );
+
+		const char* rel_path = glob->path + glob->root_len;
+		if( getopt_glob_match_dir( glob->pattern, rel_path ) && getopt_glob_is_dir( level->fd, entry, glob->follow ) )
+		{
+			/* descend after the directory itself has been returned, unreadable directories are skipped */
+			int fd = openat( level->fd, entry + 1, O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+			if( fd >= 0 && getopt_glob_push( glob, fd, level->path_len + name_len + 1 ) < 0 )
+				break;
+		}
+
+		if( getopt_glob_match_path( glob->pattern, rel_path ) )
+		{
+			++glob->num_matches;
+			ctx->current_opt_arg = glob->path;
+			return '+';
+		}
+	}
+
+	if( glob->depth == 0 )
+		return 0;
+
+	getopt_release_glob( ctx );
+	ctx->current_opt_arg = glob->token;
+	return '!';
+}
+
+/* start expanding the pattern in token */
+static int getopt_glob_begin( getopt_context_t* ctx, const char* token )
+{
+	getopt_glob_t* glob = ctx->glob;
+
+	/* expansion starts in the directory before the first component with a wildcard */
+	size_t root_len = 0;
+	size_t i = 0;
+	for( ; token[i] != '*' && token[i] != '?' && token[i] != '['; ++i )
+		if( token[i] == '/' )
+			root_len = i + 1;
+	if( root_len >= sizeof( glob->path ) )
+		return '+';
+
+	memcpy( glob->path, token, root_len );
+	glob->path[root_len] = '\0';
+	glob->token       = token;
+	glob->pattern     = token + root_len;
+	glob->root_len    = root_len;
+	glob->follow      = strstr( glob->pattern, "**" ) == 0x0;
+	glob->num_matches = 0;
+
+	int fd = open( root_len > 0 ? glob->path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+	if( fd < 0 )
+		return '+';
+	if( getopt_glob_push( glob, fd, root_len ) < 0 )
+	{
+		ctx->current_opt_arg = token;
+		return '!';
+	}
+
+	int res = getopt_glob_step( ctx );
+	if( res != 0 )
+		return res;
+
+	/* no matches, the pattern is returned as is */
+	ctx->current_opt_arg = token;
+	return '+';
+}
+
+int getopt_create_glob( getopt_context_t* ctx, getopt_glob_t* glob, void* buffer, size_t buffer_size )
+{
+	/* names grow up from the start of buffer and pointers to them down from the aligned end */
+	char*  start = (char*)buffer;
+	size_t end   = ( (size_t)( start + buffer_size ) ) & ~( sizeof( const char* ) - 1 );
+	if( buffer == 0x0 || end < (size_t)start + 2 * sizeof( const char* ) )
+		return -1;
+
+	glob->names_top   = start;
+	glob->entries_end = (const char**)end;
+	glob->entries_top = glob->entries_end;
+	glob->token       = 0x0;
+	glob->depth       = 0;
+	ctx->glob = glob;
+	return 0;
+}
+
+void getopt_release_glob( getopt_context_t* ctx )
+{
+	if( ctx->glob == 0x0 )
+		return;
+	while( ctx->glob->depth > 0 )
+		getopt_glob_pop( ctx->glob );
+}
+#endif /* !defined(GETOPT_NO_GLOB) */
+
+/*
+	unknown options are echoed back to the user and non-options, also paths from a glob, are forwarded, so with
+	GETOPT_FLAG_STRICT_TEXT they are checked as text as well. returns '!' if the token in current_opt_arg is invalid.
+*/
+static int getopt_check_token_text( getopt_context_t* ctx, int res )
+{
+	size_t offset;
+	if( ( res == '+' || res == '?' ) && ( ctx->flags & GETOPT_FLAG_STRICT_TEXT ) && ctx->current_opt_arg != 0x0 &&
+		getopt_check_utf8( ctx->current_opt_arg, strlen( ctx->current_opt_arg ), &offset ) < 0 )
+	{
+		ctx->current_value.u64 = (unsigned long long)offset;
+		return '!';
+	}
+	return res;
+}
+
+int getopt_next( getopt_context_t* ctx )
+{
+	/* reset opt-arg */
+	ctx->current_opt_arg = 0x0;
+	ctx->current_opt     = 0x0;
+	ctx->current_blob    = 0x0;
+
+	const getopt_option_t* found_opt = 0x0;
+	const char* found_arg = 0x0;
+	unsigned int match = 0;
+
+#if !defined(GETOPT_NO_GLOB)
+	/* continue expanding the last non-option */
+	if( ctx->glob && ctx->glob->depth > 0 )
+	{
+		int glob_res = getopt_glob_step( ctx );
+		if( glob_res != 0 )
+			return getopt_check_token_text( ctx, glob_res );
+		ctx->current_opt_arg = 0x0;
+	}
+#endif
+
+	int token_index = ctx->current_index;
+	if( ctx->limits && token_index < ctx->argc )
+	{
+		const char* token = ctx->argv[token_index];
+		if( ( ctx->limits->max_tokens != 0 && ctx->token_base + token_index >= ctx->limits->max_tokens ) ||
+			getopt_charge_token( ctx, token, 1 ) < 0 )
+		{
+			ctx->current_opt_arg = token;
+			ctx->current_index   = ctx->argc;
+			return '#';
+		}
+	}
+
+	int res = getopt_parse_token( ctx, &found_opt, &found_arg, &match );
+
+	/* tokens consumed as argument to the option are also counted, they have not been scanned yet */
+	if( ctx->limits )
+	{
+		/* names compared when looking up an abbreviation, known first after the lookup */
+		if( ctx->limits->max_ops != 0 && ctx->used_ops > ctx->limits->max_ops )
+		{
+			ctx->current_opt_arg = ctx->argv[token_index];
+			ctx->current_index   = ctx->argc;
+			return '#';
+		}
+
+		int i = token_index + 1;
+		for( ; i < ctx->current_index; ++i )
+		{
+			if( ( ctx->limits->max_tokens != 0 && ctx->token_base + i >= ctx->limits->max_tokens ) ||
+				getopt_charge_token( ctx, ctx->argv[i], 0 ) < 0 )
+			{
+				ctx->current_opt_arg = ctx->argv[i];
+				ctx->current_index   = ctx->argc;
+				return '#';
+			}
+		}
+	}
+
+	if( res != 0 )
+	{
+		ctx->current_opt_arg = found_arg;
+		res = getopt_check_token_text( ctx, res );
+#if !defined(GETOPT_NO_GLOB)
+		if( res == '+' && ctx->glob && getopt_glob_has_magic( found_arg ) )
+			return getopt_check_token_text( ctx, getopt_glob_begin( ctx, found_arg ) );
+#endif
+		return res;
+	}
+
+	ctx->current_opt = found_opt;
+
+	if( ( match & GETOPT_MATCH_DEPRECATED ) && ctx->deprecated_func )
+		ctx->deprecated_func( found_opt, ctx->argv[token_index], ctx->deprecated_userdata );
+
+	if( ctx->constraints )
+	{
+		getopt_constraint_set_t* set = ctx->constraints;
+		int opt_index = getopt_option_index( ctx, found_opt );
+		unsigned long long bit = 1ull << ( opt_index % 64 );
+
+		/* "--no-<name>" turns a flag off again, a flag is given as the last of its options say */
+		if( match & GETOPT_MATCH_NEGATED )
+			set->seen[opt_index / 64] &= ~bit;
+		else
+		{
+			set->repeated[opt_index / 64] |= set->seen[opt_index / 64] & bit;
+			set->seen[opt_index / 64]     |= bit;
+		}
+	}
+
+	/* "--no-<name>", only flags are negatable and they never take an argument */
+	if( match & GETOPT_MATCH_NEGATED )
+	{
+		switch(found_opt->type)
+		{
+			case GETOPT_OPTION_TYPE_FLAG_SET: *found_opt->flag  = 0;                 return 0;
+			case GETOPT_OPTION_TYPE_FLAG_AND: *found_opt->flag |= ~found_opt->value; return 0;
+			case GETOPT_OPTION_TYPE_FLAG_OR:  *found_opt->flag &= ~found_opt->value; return 0;
+			default:
+				break;
+		}
+	}
+
+	if(found_arg != 0x0)
+	{
+		ctx->current_opt_arg = found_arg;
+
+		switch(found_opt->type)
+		{
+			case GETOPT_OPTION_TYPE_FLAG_SET:
+			case GETOPT_OPTION_TYPE_FLAG_AND:
+			case GETOPT_OPTION_TYPE_FLAG_OR:
+			case GETOPT_OPTION_TYPE_NO_ARG:
+				/* these types should have no argument, usage error! */
+				ctx->current_opt_arg = 0x0;
+				return '+';
+
+			case GETOPT_OPTION_TYPE_OPTIONAL:
+			case GETOPT_OPTION_TYPE_REQUIRED:
+				if( ctx->flags & GETOPT_FLAG_STRICT_TEXT )
+					return getopt_read_text(ctx, found_opt);
+				return found_opt->value;
+			case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+			case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+			case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+			case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+			case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+			case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+			case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+			case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+				if( ctx->flags & GETOPT_FLAG_LAZY_VALUES )
+					return found_opt->value; /* converted by the caller when/if the value is used */
+				return getopt_read_value(ctx, found_opt);
+
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+				return getopt_read_path(ctx, found_opt);
+
+			case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+			case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+				if( ctx->flags & GETOPT_FLAG_LAZY_VALUES )
+					return found_opt->value;
+				return getopt_read_blob(ctx, found_opt);
+
+			case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+				if( ctx->flags & GETOPT_FLAG_LAZY_VALUES )
+					return found_opt->value;
+				return getopt_read_pattern(ctx, found_opt);
+		}
+	}
+	/* no argument found */
+	else
+	{
+		switch(found_opt->type)
+		{
+			case GETOPT_OPTION_TYPE_FLAG_SET: *found_opt->flag  = found_opt->value; return 0;
+			case GETOPT_OPTION_TYPE_FLAG_AND: *found_opt->flag &= found_opt->value; return 0;
+			case GETOPT_OPTION_TYPE_FLAG_OR:  *found_opt->flag |= found_opt->value; return 0; /* zero is "a flag was set!" */
+			
+			case GETOPT_OPTION_TYPE_NO_ARG:
+			case GETOPT_OPTION_TYPE_OPTIONAL:
+			case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+			case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+				return found_opt->value;
+
+			/* the option requires an argument! (--option=arg, -o arg) */
+			case GETOPT_OPTION_TYPE_REQUIRED:
+			case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+			case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+			case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+			case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+			case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+			case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+			case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+			case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+				ctx->current_opt_arg = found_opt->name;
+				return '!';
+		}
+	}
+
+ 	return -1;
+}
+
+const getopt_subcommand_t* getopt_find_subcommand( const getopt_subcommand_t* subcommands, const char* name )
+{
+	const getopt_subcommand_t* sub = subcommands;
+	for( ; sub->name != 0x0; ++sub )
+		if( sub->name[0] == name[0] && strcmp( sub->name, name ) == 0 )
+			return sub;
+	return 0x0;
+}
+
+int getopt_create_subcommand_context( getopt_context_t* ctx, getopt_context_t* sub_ctx, const getopt_subcommand_t* subcommand )
+{
+	if( ctx->current_index == 0 )
+		return -1;
+
+	/* the subcommand-token will take the place of the program-name in argv */
+	int err = getopt_create_context( sub_ctx, ctx->argc - ctx->current_index + 1, ctx->argv + ctx->current_index - 1, subcommand->opts );
+	if( err < 0 )
+		return err;
+
+	sub_ctx->flags     = ctx->flags;
+	sub_ctx->limits    = ctx->limits;
+
+	/* limits are for the whole command line, not per subcommand */
+	sub_ctx->used_bytes = ctx->used_bytes;
+	sub_ctx->used_ops   = ctx->used_ops;
+	sub_ctx->token_base = ctx->token_base + ctx->current_index;
+	sub_ctx->deprecated_func     = ctx->deprecated_func;
+	sub_ctx->deprecated_userdata = ctx->deprecated_userdata;
+
+	/* the rest of the parent's text-buffer is free since the parent will not parse any more tokens */
+	sub_ctx->normalize_func     = ctx->normalize_func;
+	sub_ctx->normalize_userdata = ctx->normalize_userdata;
+	sub_ctx->text_buffer        = ctx->text_buffer ? ctx->text_buffer + ctx->text_used : 0x0;
+	sub_ctx->text_size          = ctx->text_size - ctx->text_used;
+	ctx->current_index = ctx->argc;
+	return 0;
+}
+
+#if !defined(GETOPT_NO_SUGGEST)
+/*
+	edit-distance between the pattern that peq was built from and name, calculated with the bit-parallel
+	algorithm by Myers (in the formulation by Hyyrö) so that each char in name is processed in O(1).
+	Returns max_distance + 1 as soon as the distance is known to be larger than max_distance.
+*/
+static int getopt_edit_distance( const uint64_t* peq, size_t pattern_len, const char* name, size_t name_len, int max_distance )
+{
+	const uint64_t last = (uint64_t)1 << ( pattern_len - 1 );
+
+	uint64_t pv = ~(uint64_t)0;
+	uint64_t mv = 0;
+	int score = (int)pattern_len;
+
+	size_t i = 0;
+	for( ; i < name_len; ++i )
+	{
+		uint64_t eq = peq[ getopt_to_lower( (unsigned char)name[i] ) ];
+		uint64_t xv = eq | mv;
+		uint64_t xh = ( ( ( eq & pv ) + pv ) ^ pv ) | eq;
+		uint64_t ph = mv | ~( xh | pv );
+		uint64_t mh = pv & xh;
+
+		if( ph & last ) ++score;
+		if( mh & last ) --score;
+
+		/* each remaining char can decrease score by at most 1 */
+		if( score - (int)( name_len - i - 1 ) > max_distance )
+			return max_distance + 1;
+
+		ph = ( ph << 1 ) | 1;
+		mh = mh << 1;
+		pv = mh | ~( xv | ph );
+		mv = ph & xv;
+	}
+	return score;
+}
+
+int getopt_suggest( const getopt_context_t* ctx, const char* token, int max_distance, const getopt_option_t** suggestions, int suggestions_size )
+{
+	int distances[64];
+	int num_suggestions = 0;
+
+	if( suggestions_size > (int)( sizeof( distances ) / sizeof( distances[0] ) ) )
+		suggestions_size = (int)( sizeof( distances ) / sizeof( distances[0] ) );
+
+	while( *token == '-' )
+		++token;
+
+	size_t token_len = 0;
+	while( token[token_len] != '\0' && token[token_len] != '=' )
+		++token_len;
+
+	if( token_len > 64 )
+		token_len = 64;
+	if( token_len == 0 || suggestions_size <= 0 || max_distance < 0 )
+		return 0;
+
+	uint64_t peq[256];
+	memset( peq, 0x0, sizeof( peq ) );
+	size_t i = 0;
+	for( ; i < token_len; ++i )
+		peq[ getopt_to_lower( (unsigned char)token[i] ) ] |= (uint64_t)1 << i;
+
+	int opt_index = 0;
+	for( ; opt_index < ctx->num_opts; ++opt_index )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, opt_index );
+		if( !opt->name )
+			continue;
+
+		/* difference in length is a lower bound of the edit-distance */
+		size_t name_len = strlen( opt->name );
+		size_t len_diff = name_len > token_len ? name_len - token_len : token_len - name_len;
+		if( len_diff > (size_t)max_distance )
+			continue;
+
+		int distance = getopt_edit_distance( peq, token_len, opt->name, name_len, max_distance );
+		if( distance > max_distance )
+			continue;
+
+		/* insert sorted by distance, keeping order of the options-list on equal distance */
+		int insert_at = num_suggestions;
+		while( insert_at > 0 && distances[insert_at - 1] > distance )
+			--insert_at;
+		if( insert_at == suggestions_size )
+			continue;
+
+		int move = num_suggestions < suggestions_size ? num_suggestions : suggestions_size - 1;
+		for( ; move > insert_at; --move )
+		{
+			suggestions[move] = suggestions[move - 1];
+			distances[move]   = distances[move - 1];
+		}
+		suggestions[insert_at] = opt;
+		distances[insert_at]   = distance;
+		if( num_suggestions < suggestions_size )
+			++num_suggestions;
+
+		/* with the list full, only closer matches are of interest */
+		if( num_suggestions == suggestions_size )
+		{
+			max_distance = distances[num_suggestions - 1] - 1;
+			if( max_distance < 0 )
+				break;
+		}
+	}
+
+	return num_suggestions;
+}
+#endif /* !defined(GETOPT_NO_SUGGEST) */
+
+#if !defined(GETOPT_NO_HELP)
+const char* getopt_create_help_string( getopt_context_t* ctx, char* buffer, size_t buffer_size )
+{
+	size_t buffer_pos = 0;
+	int    opt_index  = 0;
 	for( ; opt_index < ctx->num_opts; ++opt_index )
 	{
-		const getopt_option_t* opt = ctx->opts + opt_index;
+		const getopt_option_t* opt = getopt_option_at( ctx, opt_index );
+
+		size_t outpos;
+		char long_name[64];
+		int chars_written = str_format( long_name, 64, "--%s%s", opt->negatable ? "[no-]" : "", opt->name );
+		if( chars_written < 0 )
+			return buffer;
+
+		outpos = (size_t)chars_written;
+
+		switch( opt->type )
+		{
+			case GETOPT_OPTION_TYPE_REQUIRED:
+			case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+			case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+			case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+			case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+			case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+			case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+			case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+			case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+				str_format(long_name + outpos, 64 - outpos, "=<%s>", opt->value_desc);
+				break;
+			case GETOPT_OPTION_TYPE_OPTIONAL:
+				str_format(long_name + outpos, 64 - outpos, "(=%s)", opt->value_desc);
+				break;
+			default:
+				break;
+		}
+
+		if(opt->name_short == 0x0)
+			chars_written = str_format( buffer + buffer_pos, buffer_size - buffer_pos, "   %-32s - %s\n", long_name, opt->desc );
+		else
+			chars_written = str_format( buffer + buffer_pos, buffer_size - buffer_pos, "-%c %-32s - %s\n", opt->name_short, long_name, opt->desc);
+
+		if( chars_written < 0 )
+			return buffer;
+		
+		buffer_pos += (size_t)chars_written;
+	}
+
+	return buffer;
+}
+#endif /* !defined(GETOPT_NO_HELP) */
+
+int getopt_create_query_index( getopt_context_t* ctx, getopt_occurrence_t* occurrences, int occurrences_size )
+{
+	if( occurrences_size < ctx->num_opts )
+		return -1;
+
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		getopt_occurrence_t* occ = occurrences + i;
+		occ->count     = 0;
+		occ->first     = -1;
+		occ->last      = -1;
+		occ->first_arg = 0x0;
+		occ->last_arg  = 0x0;
+		occ->last_negated = -1;
+	}
+
+	ctx->occurrences = occurrences;
+	ctx->query_index = 0;
+	return 0;
+}
+
+static void getopt_record_occurrence( getopt_occurrence_t* occ, int argv_index, const char* arg )
+{
+	if( occ->count++ == 0 )
+	{
+		occ->first     = argv_index;
+		occ->first_arg = arg;
+	}
+	occ->last     = argv_index;
+	occ->last_arg = arg;
+}
+
+/* "--long-name" or "-s" to option */
+static const getopt_option_t* getopt_query_option( const getopt_context_t* ctx, const char* name )
+{
+	if( name[0] != '-' )
+		return 0x0;
+	if( name[1] == '-' )
+		return name[2] != '\0' ? getopt_lookup_long( ctx, name + 2, strlen( name + 2 ) ) : 0x0;
+	return name[1] != '\0' && name[2] == '\0' ? getopt_find_short_opt( ctx, name[1] ) : 0x0;
+}
+
+/*
+	get occurrences of the option called 'name', if only_first is set parsing stop at the first occurrence.
+	with a query-index, tokens are parsed from where the last query stopped and recorded in the index,
+	otherwise all tokens are parsed into 'tmp'.
+*/
+static const getopt_occurrence_t* getopt_query( getopt_context_t* ctx, const char* name, int only_first, getopt_occurrence_t* tmp )
+{
+	const getopt_option_t* opt = getopt_query_option( ctx, name );
+	if( opt == 0x0 )
+		return 0x0;
+
+	/* parse on a copy so that the state of getopt_next() is not touched */
+	getopt_context_t scan = *ctx;
+	const getopt_option_t* found_opt;
+	const char* found_arg;
+	unsigned int match;
+
+	getopt_occurrence_t* occ;
+	if( ctx->occurrences )
+	{
+		occ = ctx->occurrences + getopt_option_index( ctx, opt );
+		scan.current_index = ctx->query_index;
+	}
+	else
+	{
+		occ = tmp;
+		occ->count     = 0;
+		occ->first     = -1;
+		occ->last      = -1;
+		occ->first_arg = 0x0;
+		occ->last_arg  = 0x0;
+		occ->last_negated = -1;
+		scan.current_index = 0;
+	}
+
+	while( !( only_first && occ->count > 0 ) )
+	{
+		int token_index = scan.current_index;
+		found_opt = 0x0;
+		found_arg = 0x0;
+
+		int res = getopt_parse_token( &scan, &found_opt, &found_arg, &match );
+		if( res == -1 )
+			break;
+		if( res != 0 )
+			continue;
+
+		/* argv-indices are reported as in the argv passed to getopt_create_context(), including the program-name */
+		getopt_occurrence_t* found_occ = ctx->occurrences ? ctx->occurrences + getopt_option_index( ctx, found_opt ) : ( found_opt == opt ? occ : 0x0 );
+		if( found_occ == 0x0 )
+			continue;
+
+		/* "--no-<name>" is not an occurrence of the option */
+		if( match & GETOPT_MATCH_NEGATED )
+			found_occ->last_negated = token_index + 1;
+		else
+			getopt_record_occurrence( found_occ, token_index + 1, found_arg );
+	}
+
+	if( ctx->occurrences )
+		ctx->query_index = scan.current_index;
+	return occ;
+}
+
+int getopt_find( getopt_context_t* ctx, const char* name, const char** arg )
+{
+	getopt_occurrence_t tmp;
+	const getopt_occurrence_t* occ = getopt_query( ctx, name, 1, &tmp );
+	if( occ == 0x0 || occ->count == 0 )
+		return -1;
+
+	if( arg )
+		*arg = occ->first_arg;
+	return occ->first;
+}
+
+int getopt_last( getopt_context_t* ctx, const char* name, const char** arg )
+{
+	getopt_occurrence_t tmp;
+	const getopt_occurrence_t* occ = getopt_query( ctx, name, 0, &tmp );
+	if( occ == 0x0 || occ->count == 0 )
+		return -1;
+
+	if( arg )
+		*arg = occ->last_arg;
+	return occ->last;
+}
+
+int getopt_count( getopt_context_t* ctx, const char* name )
+{
+	getopt_occurrence_t tmp;
+	const getopt_occurrence_t* occ = getopt_query( ctx, name, 0, &tmp );
+	return occ == 0x0 ? 0 : occ->count;
+}
+
+/* set the bit for each option in the '|'-separated list 'names', -1 if a name is not an option in ctx */
+static int getopt_constraint_mask( const getopt_context_t* ctx, const char* names, unsigned long long* mask )
+{
+	if( names == 0x0 )
+		return 0;
+
+	while( 1 )
+	{
+		const char* name_end = names;
+		while( *name_end != '\0' && *name_end != '|' )
+			++name_end;
 
-		size_t outpos;
-		char long_name[64];
-		int chars_written = str_format( long_name, 64, "--%s", opt->name );
-		if( chars_written < 0 )
-			return buffer;
+		const getopt_option_t* opt = getopt_lookup_long( ctx, names, (size_t)( name_end - names ) );
+		if( opt == 0x0 )
+			return -1;
 
-		outpos = (size_t)chars_written;
+		int opt_index = getopt_option_index( ctx, opt );
+		mask[opt_index / 64] |= 1ull << ( opt_index % 64 );
+
+		if( *name_end == '\0' )
+			return 0;
+		names = name_end + 1;
+	}
+}
+
+int getopt_create_constraints( getopt_context_t* ctx, getopt_constraint_set_t* set, const getopt_constraint_t* constraints, unsigned long long* words, size_t num_words )
+{
+	int num_constraints = 0;
+	while( constraints[num_constraints].options != 0x0 )
+		++num_constraints;
+
+	size_t words_needed = (size_t)GETOPT_CONSTRAINT_WORDS( ctx->num_opts, num_constraints );
+	if( num_words < words_needed )
+		return -1;
+
+	int num_set_words = ( ctx->num_opts + 63 ) / 64;
+	memset( words, 0x0, sizeof( unsigned long long ) * words_needed );
+	set->constraints     = constraints;
+	set->num_constraints = num_constraints;
+	set->num_words       = num_set_words;
+	set->masks           = words;
+	set->seen            = words + 2 * num_constraints * num_set_words;
+	set->repeated        = set->seen + num_set_words;
+
+	int i = 0;
+	for( ; i < num_constraints; ++i )
+	{
+		unsigned long long* options = set->masks + 2 * i * num_set_words;
+		unsigned long long* targets = options + num_set_words;
+		if( getopt_constraint_mask( ctx, constraints[i].options, options ) < 0 ||
+			getopt_constraint_mask( ctx, constraints[i].targets, targets ) < 0 )
+			return -1;
+	}
+
+	ctx->constraints = set;
+	return 0;
+}
+
+/* option for the lowest set bit in word 'word_index' of a bitset */
+static const getopt_option_t* getopt_bit_to_opt( const getopt_context_t* ctx, int word_index, unsigned long long word )
+{
+	int bit = 0;
+	while( ( word & 1 ) == 0 )
+	{
+		word >>= 1;
+		++bit;
+	}
+	return getopt_option_at( ctx, word_index * 64 + bit );
+}
+
+/* first option in 'required' that is not in 'seen' or NULL */
+static const getopt_option_t* getopt_first_missing( const getopt_context_t* ctx, const unsigned long long* required, const unsigned long long* seen, int num_words )
+{
+	int w = 0;
+	for( ; w < num_words; ++w )
+	{
+		unsigned long long missing = required[w] & ~seen[w];
+		if( missing )
+			return getopt_bit_to_opt( ctx, w, missing );
+	}
+	return 0x0;
+}
+
+int getopt_check_constraints( const getopt_context_t* ctx, getopt_violation_t* violations, int violations_size )
+{
+	const getopt_constraint_set_t* set = ctx->constraints;
+	if( set == 0x0 )
+		return 0;
+
+	int num_violations = 0;
+	int num_words      = set->num_words;
+	int c = 0;
+	for( ; c < set->num_constraints; ++c )
+	{
+		const unsigned long long* options = set->masks + 2 * c * num_words;
+		const unsigned long long* targets = options + num_words;
+		const getopt_option_t*    opt     = 0x0;
+		int w = 0;
+
+		switch( set->constraints[c].type )
+		{
+			case GETOPT_CONSTRAINT_REQUIRED:
+				opt = getopt_first_missing( ctx, options, set->seen, num_words );
+				break;
+
+			case GETOPT_CONSTRAINT_EXCLUSIVE:
+			{
+				/* report the second option given */
+				int found = 0;
+				for( ; w < num_words && opt == 0x0; ++w )
+				{
+					unsigned long long given = options[w] & set->seen[w];
+					if( given == 0 )
+						continue;
+					if( found )
+						opt = getopt_bit_to_opt( ctx, w, given );
+					else if( given & ( given - 1 ) )
+						opt = getopt_bit_to_opt( ctx, w, given & ( given - 1 ) );
+					found = 1;
+				}
+				break;
+			}
+
+			case GETOPT_CONSTRAINT_REQUIRES:
+				for( ; w < num_words; ++w )
+					if( options[w] & set->seen[w] )
+						break;
+				if( w < num_words )
+					opt = getopt_first_missing( ctx, targets, set->seen, num_words );
+				break;
+
+			case GETOPT_CONSTRAINT_ONCE:
+				for( ; w < num_words && opt == 0x0; ++w )
+					if( options[w] & set->repeated[w] )
+						opt = getopt_bit_to_opt( ctx, w, options[w] & set->repeated[w] );
+				break;
+		}
+
+		if( opt == 0x0 )
+			continue;
+
+		if( num_violations < violations_size )
+		{
+			violations[num_violations].constraint = set->constraints + c;
+			violations[num_violations].opt        = opt;
+		}
+		++num_violations;
+	}
+	return num_violations;
+}
+
+/*
+	streaming 128-bit hash, bytes are collected to 64-bit blocks mixed into two lanes as in murmurhash3 x64_128.
+*/
+typedef struct getopt_hasher
+{
+	uint64_t h1;
+	uint64_t h2;
+	uint64_t block;
+	unsigned block_len;
+	uint64_t len;
+} getopt_hasher_t;
+
+static uint64_t getopt_rotl64( uint64_t x, int r )
+{
+	return ( x << r ) | ( x >> ( 64 - r ) );
+}
+
+static uint64_t getopt_fmix64( uint64_t k )
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdull;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ull;
+	k ^= k >> 33;
+	return k;
+}
+
+static void getopt_hash_block( getopt_hasher_t* hasher, uint64_t k )
+{
+	const uint64_t c1 = 0x87c37b91114253d5ull;
+	const uint64_t c2 = 0x4cf5ad432745937full;
+
+	uint64_t k1 = getopt_rotl64( k * c1, 31 ) * c2;
+	hasher->h1 ^= k1;
+	hasher->h1  = ( getopt_rotl64( hasher->h1, 27 ) + hasher->h2 ) * 5 + 0x52dce729;
+
+	uint64_t k2 = getopt_rotl64( k * c2, 33 ) * c1;
+	hasher->h2 ^= k2;
+	hasher->h2  = ( getopt_rotl64( hasher->h2, 31 ) + hasher->h1 ) * 5 + 0x38495ab5;
+}
+
+static void getopt_hash_bytes( getopt_hasher_t* hasher, const void* data, size_t size )
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i = 0;
+	for( ; i < size; ++i )
+	{
+		hasher->block |= (uint64_t)bytes[i] << ( 8 * hasher->block_len );
+		if( ++hasher->block_len == 8 )
+		{
+			getopt_hash_block( hasher, hasher->block );
+			hasher->block     = 0;
+			hasher->block_len = 0;
+		}
+	}
+	hasher->len += size;
+}
+
+static void getopt_hash_u64( getopt_hasher_t* hasher, uint64_t value )
+{
+	unsigned char bytes[8];
+	int i = 0;
+	for( ; i < 8; ++i )
+		bytes[i] = (unsigned char)( value >> ( 8 * i ) );
+	getopt_hash_bytes( hasher, bytes, sizeof( bytes ) );
+}
+
+/* strings are prefixed with their length so that "ab" + "c" and "a" + "bc" differ */
+static void getopt_hash_str( getopt_hasher_t* hasher, const char* str )
+{
+	size_t len = strlen( str );
+	getopt_hash_u64( hasher, (uint64_t)len );
+	getopt_hash_bytes( hasher, str, len );
+}
+
+#if !defined(GETOPT_NO_BLOB)
+/* hash the decoded bytes of a valid HEX or BASE64 value, "00FF" and "00ff" is the same value */
+static void getopt_hash_blob( getopt_hasher_t* hasher, const getopt_option_t* opt, const char* arg, size_t size )
+{
+	getopt_hash_bytes( hasher, "b", 1 );
+	getopt_hash_u64( hasher, (uint64_t)size );
+
+	/* decoded in chunks, 128 chars is a whole number of bytes in both hex and base64 */
+	unsigned char bytes[96];
+	size_t len = strlen( arg );
+	size_t i = 0;
+	while( i < len )
+	{
+		size_t chunk = len - i > 128 ? 128 : len - i;
+		size_t decoded;
+		getopt_decode_blob_len( opt->type, arg + i, chunk, bytes, &decoded );
+		getopt_hash_bytes( hasher, bytes, decoded );
+		i += chunk;
+	}
+}
+#endif
+
+/* hash the canonical form of 'arg' as a value to 'opt' */
+static void getopt_hash_value( getopt_hasher_t* hasher, const getopt_option_t* opt, const char* arg )
+{
+	if( arg == 0x0 )
+	{
+		getopt_hash_bytes( hasher, "n", 1 );
+		return;
+	}
+
+	switch( opt->type )
+	{
+		case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+			/* nothing is converted, the argument is the value */
+			getopt_hash_bytes( hasher, "s", 1 );
+			getopt_hash_str( hasher, arg );
+			return;
+#if !defined(GETOPT_NO_BLOB)
+		case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+		case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+		{
+			size_t size;
+			if( getopt_decode_blob( opt, arg, 0x0, 0, &size ) < 0 )
+				break;
+			getopt_hash_blob( hasher, opt, arg, size );
+			return;
+		}
+#endif
+		default:
+			break;
+	}
+
+	/* cleared so that the bytes of u64 not covered by a smaller member are zero */
+	getopt_typed_value_t value;
+	value.u64 = 0;
+	if( getopt_convert_value( opt, arg, &value ) == 0 )
+	{
+		getopt_hash_bytes( hasher, "v", 1 );
+		getopt_hash_u64( hasher, (uint64_t)value.u64 );
+		return;
+	}
+
+	getopt_hash_bytes( hasher, "s", 1 );
+	getopt_hash_str( hasher, arg );
+}
+
+/* finalize as murmurhash3 */
+static void getopt_hash_finish( const getopt_hasher_t* hasher, uint64_t out[2] )
+{
+	getopt_hasher_t h = *hasher;
+	if( h.block_len > 0 )
+		getopt_hash_block( &h, h.block );
+
+	uint64_t h1 = h.h1 ^ h.len;
+	uint64_t h2 = h.h2 ^ h.len;
+	h1 += h2;
+	h2 += h1;
+	h1 = getopt_fmix64( h1 );
+	h2 = getopt_fmix64( h2 );
+	h1 += h2;
+	h2 += h1;
+
+	out[0] = h1;
+	out[1] = h2;
+}
+
+/* is 'opt' one of the long option-names in the '|'-separated list 'names' */
+static int getopt_opt_in_names( const getopt_option_t* opt, const char* names )
+{
+	if( names == 0x0 || opt->name == 0x0 )
+		return 0;
+
+	while( 1 )
+	{
+		size_t len = getopt_key_len( names );
+		if( strncmp( names, opt->name, len ) == 0 && opt->name[len] == '\0' )
+			return 1;
+		if( names[len] == '\0' )
+			return 0;
+		names += len + 1;
+	}
+}
+
+/*
+	add value number 'nth' of the option at 'opt_index' to 'sum'. each value is hashed by itself and the hashes are
+	summed, so values of accumulating options can be hashed in the one pass over argv. 'nth' keeps the order of the
+	values of an option while values of different options can be given interleaved in any order.
+*/
+static void getopt_hash_accumulated( uint64_t sum[2], const getopt_option_t* opt, int opt_index, int nth, const char* arg )
+{
+	getopt_hasher_t hasher;
+	memset( &hasher, 0x0, sizeof( hasher ) );
+	getopt_hash_u64( &hasher, (uint64_t)opt_index );
+	getopt_hash_u64( &hasher, (uint64_t)nth );
+	getopt_hash_value( &hasher, opt, arg );
+
+	uint64_t h[2];
+	getopt_hash_finish( &hasher, h );
+	sum[0] += h[0];
+	sum[1] += h[1];
+}
+
+int getopt_fingerprint( getopt_context_t* ctx, const char* accumulate, getopt_fingerprint_t* out )
+{
+	if( ctx->occurrences == 0x0 )
+		return -1;
+
+	getopt_hasher_t hasher;
+	memset( &hasher, 0x0, sizeof( hasher ) );
+	uint64_t accumulated[2] = { 0, 0 };
+
+	/*
+		one pass over argv records all options, and negations of them, in the query-index, hashes non-options in
+		order and values of accumulating options to 'accumulated'.
+	*/
+	getopt_create_query_index( ctx, ctx->occurrences, ctx->num_opts );
+
+	getopt_context_t scan = *ctx;
+	scan.current_index = 0;
+	while( 1 )
+	{
+		int token_index = scan.current_index;
+		const getopt_option_t* found_opt = 0x0;
+		const char* found_arg = 0x0;
+		unsigned int match;
+
+		int res = getopt_parse_token( &scan, &found_opt, &found_arg, &match );
+		if( res == -1 )
+			break;
+
+		if( res == 0 )
+		{
+			int opt_index = getopt_option_index( ctx, found_opt );
+			getopt_occurrence_t* occ = ctx->occurrences + opt_index;
+			if( match & GETOPT_MATCH_NEGATED )
+			{
+				occ->last_negated = token_index + 1;
+				continue;
+			}
+
+			if( getopt_opt_might_have_arg( found_opt ) && getopt_opt_in_names( found_opt, accumulate ) )
+				getopt_hash_accumulated( accumulated, found_opt, opt_index, occ->count, found_arg );
+			getopt_record_occurrence( occ, token_index + 1, found_arg );
+			continue;
+		}
+
+		char tag = (char)res;
+		getopt_hash_bytes( &hasher, &tag, 1 );
+		getopt_hash_str( &hasher, found_arg );
+	}
+	ctx->query_index = scan.current_index;
+
+	/* options in the order of the options-list, with the value that the program will use */
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		const getopt_occurrence_t* occ = ctx->occurrences + i;
+		const getopt_option_t* opt = getopt_option_at( ctx, i );
+
+		/* a negatable flag is on, off or not given, as the last of "--<name>" and "--no-<name>" say */
+		int negated = opt->negatable && occ->last_negated > occ->last;
+		if( occ->count == 0 && !negated )
+			continue;
+
+		getopt_hash_bytes( &hasher, negated ? "-" : "o", 1 );
+		if( opt->name )
+			getopt_hash_str( &hasher, opt->name );
+		else
+			getopt_hash_u64( &hasher, (uint64_t)opt->name_short );
 
 		switch( opt->type )
 		{
-			case GETOPT_OPTION_TYPE_REQUIRED:
-				str_format(long_name + outpos, 64 - outpos, "=<%s>", opt->value_desc);
+			case GETOPT_OPTION_TYPE_NO_ARG:
+				getopt_hash_u64( &hasher, (uint64_t)occ->count );
 				break;
-			case GETOPT_OPTION_TYPE_OPTIONAL:
-				str_format(long_name + outpos, 64 - outpos, "(=%s)", opt->value_desc);
+			case GETOPT_OPTION_TYPE_FLAG_SET:
+			case GETOPT_OPTION_TYPE_FLAG_AND:
+			case GETOPT_OPTION_TYPE_FLAG_OR:
 				break;
 			default:
+				/* all values of accumulating options are in 'accumulated', hashed with their count */
+				if( getopt_opt_in_names( opt, accumulate ) )
+					getopt_hash_u64( &hasher, (uint64_t)occ->count );
+				else
+					getopt_hash_value( &hasher, opt, occ->last_arg );
 				break;
 		}
+	}
 
-		if(opt->name_short == 0x0)
-			chars_written = str_format( buffer + buffer_pos, buffer_size - buffer_pos, "   %-32s - %s\n", long_name, opt->desc );
+	getopt_hash_bytes( &hasher, "a", 1 );
+	getopt_hash_u64( &hasher, accumulated[0] );
+	getopt_hash_u64( &hasher, accumulated[1] );
+
+	uint64_t h[2];
+	getopt_hash_finish( &hasher, h );
+	out->lo = (unsigned long long)h[0];
+	out->hi = (unsigned long long)h[1];
+	return 0;
+}
+
+#if !defined(GETOPT_NO_COMPLETION)
+/* append formatted string to buffer at *buf_pos if it fits, returns 1 if it was written */
+static int str_append( char* buf, size_t buf_size, size_t* buf_pos, const char* fmt, ... )
+{
+	if( *buf_pos >= buf_size )
+		return 0;
+
+	va_list args;
+	va_start( args, fmt );
+	int ret = vsnprintf( buf + *buf_pos, buf_size - *buf_pos, fmt, args );
+	va_end( args );
+
+	if( ret < 0 || (size_t)ret >= buf_size - *buf_pos )
+	{
+		buf[*buf_pos] = '\0';
+		return 0;
+	}
+	*buf_pos += (size_t)ret;
+	return 1;
+}
+
+/*
+	complete the value of an enum- or bitmask-option, 'value' points into 'word' at the start of the value and each
+	name in value_desc that starts with it is written after the part of word before it. for a bitmask only the name
+	after the last ',' is completed.
+*/
+static int getopt_complete_value( const getopt_option_t* opt, const char* word, const char* value, char* buffer, size_t buffer_size, size_t* buffer_pos )
+{
+	if( opt == 0x0 || ( opt->type != GETOPT_OPTION_TYPE_REQUIRED_ENUM && opt->type != GETOPT_OPTION_TYPE_REQUIRED_BITMASK ) )
+		return 0;
+
+	if( opt->type == GETOPT_OPTION_TYPE_REQUIRED_BITMASK )
+	{
+		const char* last = strrchr( value, ',' );
+		if( last )
+			value = last + 1;
+	}
+
+	int    num_completions = 0;
+	int    lead_len  = (int)( value - word );
+	size_t value_len = strlen( value );
+	const char* name = opt->value_desc;
+	while( 1 )
+	{
+		size_t name_len = getopt_key_len( name );
+		if( name_len >= value_len && strncmp( name, value, value_len ) == 0 )
+			num_completions += str_append( buffer, buffer_size, buffer_pos, "%.*s%.*s\n", lead_len, word, (int)name_len, name );
+		if( name[name_len] == '\0' )
+			return num_completions;
+		name += name_len + 1;
+	}
+}
+
+int getopt_complete( getopt_context_t* ctx, char* buffer, size_t buffer_size )
+{
+	const size_t complete_arg_len = sizeof( GETOPT_COMPLETE_ARG ) - 1;
+
+	if( ctx->argc == 0 || strncmp( ctx->argv[0], GETOPT_COMPLETE_ARG "=", complete_arg_len + 1 ) != 0 || buffer_size == 0 )
+		return -1;
+
+	const char** words     = ctx->argv + 1;
+	int          num_words = ctx->argc - 1;
+	int          word_index = (int)strtol( ctx->argv[0] + complete_arg_len + 1, 0x0, 10 );
+	if( word_index < 0 )
+		word_index = num_words;
+
+	const char* word = word_index < num_words ? words[word_index] : "";
+	const char* prev = word_index > 0 && word_index <= num_words ? words[word_index - 1] : 0x0;
+
+	size_t buffer_pos = 0;
+	int num_completions = 0;
+	buffer[0] = '\0';
+
+	/* ctx is used for the query and should not be parsed after this */
+	ctx->current_index = ctx->argc;
+
+	/*
+		values of enum- and bitmask-options are completed with their names, as "--opt value", "--opt=value" and as
+		bash splits --opt=value into "--opt", "=" and "value". right after the "=" bash has "=" as the word under the cursor.
+	*/
+	if( prev && strcmp( prev, "=" ) == 0 )
+		return getopt_complete_value( word_index >= 2 ? getopt_query_option( ctx, words[word_index - 2] ) : 0x0, word, word, buffer, buffer_size, &buffer_pos );
+	if( prev && strcmp( word, "=" ) == 0 )
+		return getopt_complete_value( getopt_query_option( ctx, prev ), word, word + 1, buffer, buffer_size, &buffer_pos );
+	if( prev && word[0] != '-' )
+		return getopt_complete_value( getopt_query_option( ctx, prev ), word, word, buffer, buffer_size, &buffer_pos );
+	if( word[0] == '-' && word[1] == '-' && strchr( word, '=' ) != 0x0 )
+	{
+		const char* eq = strchr( word, '=' );
+		return getopt_complete_value( getopt_lookup_long( ctx, word + 2, (size_t)( eq - word - 2 ) ), word, eq + 1, buffer, buffer_size, &buffer_pos );
+	}
+
+	/* other positionals and values should be completed as files */
+	if( word[0] != '-' )
+		return 0;
+
+	if( word[1] == '\0' )
+	{
+		/* only "-", list all options */
+		int i = 0;
+		for( ; i < ctx->num_opts; ++i )
+		{
+			const getopt_option_t* opt = getopt_option_at( ctx, i );
+			if( opt->name_short != 0 )
+				num_completions += str_append( buffer, buffer_size, &buffer_pos, "-%c\n", opt->name_short );
+			if( opt->name != 0x0 )
+				num_completions += str_append( buffer, buffer_size, &buffer_pos, "--%s\n", opt->name );
+		}
+		return num_completions;
+	}
+
+	if( word[1] != '-' )
+	{
+		/* a complete short option is its own completion */
+		if( word[2] == '\0' && getopt_find_short_opt( ctx, word[1] ) )
+			return str_append( buffer, buffer_size, &buffer_pos, "%s\n", word );
+		return 0;
+	}
+
+	const char* prefix     = word + 2;
+	size_t      prefix_len = strlen( prefix );
+
+	if( ctx->index )
+	{
+		/* all names starting with prefix are sorted right after it */
+		int index_pos = getopt_index_lower_bound( ctx->index, ctx->index_size, prefix, prefix_len );
+		for( ; index_pos < ctx->index_size && getopt_name_starts_with( ctx->index[index_pos].name, prefix, prefix_len ); ++index_pos )
+		{
+			const char* name = ctx->index[index_pos].name;
+			if( !ctx->index[index_pos].deprecated )
+				num_completions += str_append( buffer, buffer_size, &buffer_pos, "--%.*s\n", (int)getopt_key_len( name ), name );
+		}
+		return num_completions;
+	}
+
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, i );
+		if( !opt->name )
+			continue;
+		if( str_case_cmp_len( opt->name, prefix, (unsigned int)prefix_len ) == 0 )
+			num_completions += str_append( buffer, buffer_size, &buffer_pos, "--%s\n", opt->name );
+
+		/* deprecated aliases are accepted but not suggested */
+		const char* alias = opt->aliases;
+		const char* key;
+		int deprecated;
+		while( getopt_next_alias( &alias, &key, &deprecated ) )
+			if( !deprecated && getopt_name_starts_with( key, prefix, prefix_len ) )
+				num_completions += str_append( buffer, buffer_size, &buffer_pos, "--%.*s\n", (int)getopt_key_len( key ), key );
+	}
+	return num_completions;
+}
+
+/* fish wants a single-quoted string, escape ' and \ */
+static void getopt_append_quoted( char* buffer, size_t buffer_size, size_t* buffer_pos, const char* str )
+{
+	str_append( buffer, buffer_size, buffer_pos, "'" );
+	for( ; str && *str; ++str )
+	{
+		if( *str == '\'' || *str == '\\' )
+			str_append( buffer, buffer_size, buffer_pos, "\\%c", *str );
 		else
-			chars_written = str_format( buffer + buffer_pos, buffer_size - buffer_pos, "-%c %-32s - %s\n", opt->name_short, long_name, opt->desc);
+			str_append( buffer, buffer_size, buffer_pos, "%c", *str );
+	}
+	str_append( buffer, buffer_size, buffer_pos, "'" );
+}
 
-		if( chars_written < 0 )
-			return buffer;
-		
-		buffer_pos += (size_t)chars_written;
+const char* getopt_create_completion_script( getopt_context_t* ctx, getopt_shell_t shell, const char* prog_name, char* buffer, size_t buffer_size )
+{
+	size_t buffer_pos = 0;
+	if( buffer_size == 0 )
+		return buffer;
+	buffer[0] = '\0';
+
+	/* prog_name might not be a valid identifier, i.e. my-prog */
+	char func_name[64];
+	size_t i = 0;
+	for( ; prog_name[i] != '\0' && i < sizeof( func_name ) - 1; ++i )
+	{
+		char c = prog_name[i];
+		func_name[i] = ( ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) ) ? c : '_';
+	}
+	func_name[i] = '\0';
+
+	switch( shell )
+	{
+		case GETOPT_SHELL_BASH:
+			str_append( buffer, buffer_size, &buffer_pos,
+						"_%s_getopt_complete()\n"
+						"{\n"
+						"\tlocal IFS=$'\\n'\n"
+						"\tCOMPREPLY=( $( \"${COMP_WORDS[0]}\" " GETOPT_COMPLETE_ARG "=$(( COMP_CWORD - 1 )) \"${COMP_WORDS[@]:1}\" 2>/dev/null ) )\n"
+						"}\n"
+						"complete -o default -F _%s_getopt_complete %s\n",
+						func_name, func_name, prog_name );
+			break;
+		case GETOPT_SHELL_ZSH:
+			str_append( buffer, buffer_size, &buffer_pos,
+						"#compdef %s\n"
+						"_%s_getopt_complete()\n"
+						"{\n"
+						"\tlocal -a completions\n"
+						"\tcompletions=( ${(f)\"$( ${words[1]} " GETOPT_COMPLETE_ARG "=$(( CURRENT - 2 )) \"${(@)words[2,-1]}\" 2>/dev/null )\"} )\n"
+						"\tif (( ${#completions} )); then\n"
+						"\t\tcompadd -- $completions\n"
+						"\telse\n"
+						"\t\tcompset -P '*='\n"
+						"\t\t_files\n"
+						"\tfi\n"
+						"}\n"
+						"compdef _%s_getopt_complete %s\n",
+						prog_name, func_name, func_name, prog_name );
+			break;
+		case GETOPT_SHELL_FISH:
+		{
+			int opt_index = 0;
+			for( ; opt_index < ctx->num_opts; ++opt_index )
+			{
+				const getopt_option_t* opt = getopt_option_at( ctx, opt_index );
+
+				str_append( buffer, buffer_size, &buffer_pos, "complete -c %s", prog_name );
+				if( opt->name_short != 0 )
+					str_append( buffer, buffer_size, &buffer_pos, " -s %c", opt->name_short );
+				if( opt->name != 0x0 )
+					str_append( buffer, buffer_size, &buffer_pos, " -l %s", opt->name );
+
+				switch( opt->type )
+				{
+					case GETOPT_OPTION_TYPE_REQUIRED:
+					case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+					case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+					case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+					case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+					case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+					case GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS:
+					case GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE:
+					case GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR:
+					case GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE:
+					case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+					case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+					case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+						str_append( buffer, buffer_size, &buffer_pos, " -r" );
+						break;
+					case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+					{
+						/* the names are the only valid arguments */
+						const char* name = opt->value_desc;
+						str_append( buffer, buffer_size, &buffer_pos, " -x -a '" );
+						for( ; *name != '\0'; ++name )
+							str_append( buffer, buffer_size, &buffer_pos, "%c", *name == '|' ? ' ' : *name );
+						str_append( buffer, buffer_size, &buffer_pos, "'" );
+						break;
+					}
+					case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+						str_append( buffer, buffer_size, &buffer_pos, " -x" );
+						break;
+					default:
+						break;
+				}
+
+				if( opt->desc != 0x0 )
+				{
+					str_append( buffer, buffer_size, &buffer_pos, " -d " );
+					getopt_append_quoted( buffer, buffer_size, &buffer_pos, opt->desc );
+				}
+				str_append( buffer, buffer_size, &buffer_pos, "\n" );
+			}
+		}
+		break;
 	}
 
 	return buffer;
 }
+#endif /* !defined(GETOPT_NO_COMPLETION) */
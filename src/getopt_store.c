@@ -0,0 +1,983 @@
+/* a getopt.
+   version 0.1, march, 2012
+
+   Copyright (C) 2012- Fredrik Kihlander
+
+   https://github.com/wc-duck/getopt
+
+   This software is provided 'as-is', without any express or implied
+   warranty.  In no event will the authors be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you must not
+      claim that you wrote the original software. If you use this software
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original software.
+   3. This notice may not be removed or altered from any source distribution.
+
+   Fredrik Kihlander
+*/
+
+#include <getopt/getopt_store.h>
+
+#include <stdio.h>  /* fopen, fread */
+#include <stdlib.h> /* strtol, strtof */
+#include <string.h>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#   define GETOPT_ENVIRON ( (const char* const*)_environ )
+#   include <sys/stat.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+	extern char** environ;
+#   define GETOPT_ENVIRON ( (const char* const*)environ )
+#endif
+
+#if defined(__linux__)
+#   include <sys/inotify.h>
+#   define GETOPT_HAS_INOTIFY
+#endif
+
+/* bits in getopt_value_t.state */
+#define GETOPT_VALUE_STRICT       ( 1u << 0 )
+#define GETOPT_VALUE_I32_CACHED   ( 1u << 1 )
+#define GETOPT_VALUE_I32_INVALID  ( 1u << 2 )
+#define GETOPT_VALUE_FP32_CACHED  ( 1u << 3 )
+#define GETOPT_VALUE_FP32_INVALID ( 1u << 4 )
+#define GETOPT_VALUE_CHECKED      ( 1u << 5 ) /* checked with getopt_convert_value() */
+#define GETOPT_VALUE_INVALID      ( 1u << 6 )
+
+int getopt_store_init( getopt_store_t* store, getopt_context_t* ctx, getopt_value_t* values, int num_values )
+{
+	if( num_values < ctx->num_opts )
+		return -1;
+
+	store->ctx         = ctx;
+	store->values      = values;
+	store->mapped      = 0x0;
+	store->mapped_size = 0;
+	memset( values, 0x0, sizeof( getopt_value_t ) * (size_t)ctx->num_opts );
+	return 0;
+}
+
+void getopt_store_release( getopt_store_t* store )
+{
+	if( store->mapped == 0x0 )
+		return;
+
+#if defined(_WIN32)
+	UnmapViewOfFile( store->mapped );
+#else
+	munmap( store->mapped, store->mapped_size );
+#endif
+	store->mapped      = 0x0;
+	store->mapped_size = 0;
+}
+
+int getopt_store_set( getopt_store_t* store, const getopt_option_t* opt, const char* str, size_t str_len, getopt_source_t source )
+{
+	getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+
+	/* a later value from the same source overrides the earlier one, last one wins as when parsing argv */
+	if( value->source > source )
+		return 0;
+
+	value->str     = str;
+	value->str_len = str_len;
+	value->source  = source;
+	value->state  &= GETOPT_VALUE_STRICT; /* cached conversions was of the old value */
+	return 1;
+}
+
+static int getopt_store_is_space( char c )
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+	parse all lines in [line, end), line_nr is the line-number of the first line.
+	values from the config-file pointing at or after keep_from is not overwritten since they come from later lines.
+*/
+static int getopt_store_parse_lines( getopt_store_t* store, const char* line, const char* end, int line_nr, const char* keep_from )
+{
+	int first_bad_line = 0;
+	--line_nr;
+
+	while( line < end )
+	{
+		const char* line_end = (const char*)memchr( line, '\n', (size_t)( end - line ) );
+		if( line_end == 0x0 )
+			line_end = end;
+		++line_nr;
+
+		const char* key = line;
+		line = line_end + 1;
+
+		while( key < line_end && getopt_store_is_space( *key ) )
+			++key;
+		if( key == line_end || *key == '#' || *key == ';' )
+			continue;
+
+		const char* key_end = key;
+		while( key_end < line_end && *key_end != '=' )
+			++key_end;
+
+		const char* val     = key_end < line_end ? key_end + 1 : line_end;
+		const char* val_end = line_end;
+
+		while( key_end > key && getopt_store_is_space( key_end[-1] ) )
+			--key_end;
+		while( val < val_end && getopt_store_is_space( *val ) )
+			++val;
+		while( val_end > val && getopt_store_is_space( val_end[-1] ) )
+			--val_end;
+
+		const getopt_option_t* opt = getopt_lookup_long( store->ctx, key, (size_t)( key_end - key ) );
+		if( opt == 0x0 )
+		{
+			if( first_bad_line == 0 )
+				first_bad_line = line_nr;
+			continue;
+		}
+
+		const getopt_value_t* prev = store->values + getopt_option_index( store->ctx, opt );
+		if( keep_from != 0x0 && prev->source == GETOPT_SOURCE_CONFIG_FILE && prev->str >= keep_from )
+			continue;
+
+		getopt_store_set( store, opt, val, (size_t)( val_end - val ), GETOPT_SOURCE_CONFIG_FILE );
+	}
+
+	return first_bad_line;
+}
+
+int getopt_store_read_config( getopt_store_t* store, const char* data, size_t size )
+{
+	return getopt_store_parse_lines( store, data, data + size, 1, 0x0 );
+}
+
+/* map file at path read-only, an empty file gives data == NULL and size == 0 */
+static int getopt_store_map_file( const char* path, void** out_data, size_t* out_size )
+{
+	size_t size = 0;
+	void* data = 0x0;
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0x0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0x0 );
+	if( file == INVALID_HANDLE_VALUE )
+		return -1;
+
+	LARGE_INTEGER file_size;
+	if( !GetFileSizeEx( file, &file_size ) )
+	{
+		CloseHandle( file );
+		return -1;
+	}
+	size = (size_t)file_size.QuadPart;
+
+	if( size > 0 )
+	{
+		HANDLE mapping = CreateFileMappingA( file, 0x0, PAGE_READONLY, 0, 0, 0x0 );
+		if( mapping != 0x0 )
+		{
+			data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+			CloseHandle( mapping ); /* the view keeps the mapping alive */
+		}
+	}
+	CloseHandle( file );
+#else
+	int fd = open( path, O_RDONLY );
+	if( fd < 0 )
+		return -1;
+
+	struct stat st;
+	if( fstat( fd, &st ) < 0 )
+	{
+		close( fd );
+		return -1;
+	}
+	size = (size_t)st.st_size;
+
+	if( size > 0 )
+	{
+		data = mmap( 0x0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if( data == MAP_FAILED )
+			data = 0x0;
+	}
+	close( fd ); /* the mapping stays valid after close */
+#endif
+
+	if( size > 0 && data == 0x0 )
+		return -1;
+
+	*out_data = data;
+	*out_size = size;
+	return 0;
+}
+
+int getopt_store_read_config_file( getopt_store_t* store, const char* path )
+{
+	/* only one mapped file per store */
+	if( store->mapped != 0x0 )
+		return -1;
+
+	void*  data;
+	size_t size;
+	if( getopt_store_map_file( path, &data, &size ) < 0 )
+		return -1;
+
+	store->mapped      = data;
+	store->mapped_size = size;
+	return getopt_store_read_config( store, (const char*)data, size );
+}
+
+int getopt_store_read_env( getopt_store_t* store, const char* prefix, const char* const* env )
+{
+	size_t prefix_len = strlen( prefix );
+	int num_read = 0;
+
+	if( env == 0x0 )
+		env = GETOPT_ENVIRON;
+
+	for( ; env && *env; ++env )
+	{
+		const char* var = *env;
+		if( strncmp( var, prefix, prefix_len ) != 0 )
+			continue;
+
+		const char* name = var + prefix_len;
+		const char* eq   = strchr( name, '=' );
+		if( eq == 0x0 || eq == name )
+			continue;
+
+		size_t name_len = (size_t)( eq - name );
+
+		/* option-names use '-' where variable-names use '_', try as is first for option-names containing '_' */
+		const getopt_option_t* opt = getopt_lookup_long( store->ctx, name, name_len );
+		if( opt == 0x0 )
+		{
+			char opt_name[128];
+			if( name_len >= sizeof( opt_name ) )
+				continue;
+
+			size_t i = 0;
+			for( ; i < name_len; ++i )
+				opt_name[i] = name[i] == '_' ? '-' : name[i];
+			opt = getopt_lookup_long( store->ctx, opt_name, name_len );
+		}
+
+		if( opt == 0x0 )
+			continue;
+
+		num_read += getopt_store_set( store, opt, eq + 1, strlen( eq + 1 ), GETOPT_SOURCE_ENV );
+	}
+
+	return num_read;
+}
+
+int getopt_store_next( getopt_store_t* store )
+{
+	int res = getopt_next( store->ctx );
+
+	const getopt_option_t* opt = store->ctx->current_opt;
+	if( opt == 0x0 || res == '!' )
+		return res;
+
+	const char* arg = store->ctx->current_opt_arg;
+	switch( opt->type )
+	{
+		case GETOPT_OPTION_TYPE_NO_ARG:
+		case GETOPT_OPTION_TYPE_FLAG_SET:
+		case GETOPT_OPTION_TYPE_FLAG_AND:
+		case GETOPT_OPTION_TYPE_FLAG_OR:
+			arg = 0x0;
+			break;
+		default:
+			break;
+	}
+
+	if( arg == 0x0 )
+		getopt_store_set( store, opt, "", 0, GETOPT_SOURCE_ARGV );
+	else
+		getopt_store_set( store, opt, arg, strlen( arg ), GETOPT_SOURCE_ARGV );
+	return res;
+}
+
+const getopt_value_t* getopt_store_get( const getopt_store_t* store, const getopt_option_t* opt )
+{
+	if( opt == 0x0 )
+		return 0x0;
+
+	const getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+	return value->source == GETOPT_SOURCE_NONE ? 0x0 : value;
+}
+
+/* values are not zero-terminated, copy to a buffer that strtol/strtof can work on */
+static const char* getopt_store_value_str( const getopt_value_t* value, char* buffer, size_t buffer_size )
+{
+	if( value->str_len == 0 || value->str_len >= buffer_size )
+		return 0x0;
+
+	memcpy( buffer, value->str, value->str_len );
+	buffer[value->str_len] = '\0';
+	return buffer;
+}
+
+static void getopt_store_convert_int32( getopt_value_t* value )
+{
+	char buffer[64];
+	const char* str = getopt_store_value_str( value, buffer, sizeof( buffer ) );
+
+	char* end = 0x0;
+	if( str != 0x0 )
+		value->i32 = (int)strtol( str, &end, 0 );
+	value->state |= ( str == 0x0 || *end != '\0' ) ? GETOPT_VALUE_I32_INVALID : GETOPT_VALUE_I32_CACHED;
+}
+
+static void getopt_store_convert_fp32( getopt_value_t* value )
+{
+	char buffer[64];
+	const char* str = getopt_store_value_str( value, buffer, sizeof( buffer ) );
+
+	char* end = 0x0;
+	if( str != 0x0 )
+		value->fp32 = strtof( str, &end );
+	value->state |= ( str == 0x0 || *end != '\0' ) ? GETOPT_VALUE_FP32_INVALID : GETOPT_VALUE_FP32_CACHED;
+}
+
+/* check value of an option of a type that only getopt_convert_value() knows about, in place as values can be large blobs */
+static void getopt_store_check_typed( const getopt_option_t* opt, getopt_value_t* value )
+{
+	getopt_typed_value_t typed;
+	const char* str = value->str ? value->str : "";
+	value->state |= getopt_convert_value_len( opt, str, value->str_len, &typed ) < 0 ? GETOPT_VALUE_INVALID : GETOPT_VALUE_CHECKED;
+}
+
+/* convert value of opt to the type of opt, returns -1 if the value is invalid */
+static int getopt_store_convert( getopt_store_t* store, const getopt_option_t* opt )
+{
+	getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+	if( value->source == GETOPT_SOURCE_NONE )
+		return 0;
+
+	switch( opt->type )
+	{
+		case GETOPT_OPTION_TYPE_OPTIONAL_INT32:
+		case GETOPT_OPTION_TYPE_REQUIRED_INT32:
+			if( ( value->state & ( GETOPT_VALUE_I32_CACHED | GETOPT_VALUE_I32_INVALID ) ) == 0 )
+				getopt_store_convert_int32( value );
+			/* an optional value given without argument is valid */
+			return ( value->state & GETOPT_VALUE_I32_INVALID ) && !( value->str_len == 0 && opt->type == GETOPT_OPTION_TYPE_OPTIONAL_INT32 ) ? -1 : 0;
+		case GETOPT_OPTION_TYPE_OPTIONAL_FP32:
+		case GETOPT_OPTION_TYPE_REQUIRED_FP32:
+			if( ( value->state & ( GETOPT_VALUE_FP32_CACHED | GETOPT_VALUE_FP32_INVALID ) ) == 0 )
+				getopt_store_convert_fp32( value );
+			return ( value->state & GETOPT_VALUE_FP32_INVALID ) && !( value->str_len == 0 && opt->type == GETOPT_OPTION_TYPE_OPTIONAL_FP32 ) ? -1 : 0;
+		case GETOPT_OPTION_TYPE_REQUIRED_ENUM:
+		case GETOPT_OPTION_TYPE_REQUIRED_BITMASK:
+		case GETOPT_OPTION_TYPE_REQUIRED_SIZE:
+		case GETOPT_OPTION_TYPE_REQUIRED_DURATION:
+		case GETOPT_OPTION_TYPE_REQUIRED_RATE:
+		case GETOPT_OPTION_TYPE_REQUIRED_HEX:
+		case GETOPT_OPTION_TYPE_REQUIRED_BASE64:
+		case GETOPT_OPTION_TYPE_REQUIRED_PATTERN:
+			if( ( value->state & ( GETOPT_VALUE_CHECKED | GETOPT_VALUE_INVALID ) ) == 0 )
+				getopt_store_check_typed( opt, value );
+			return ( value->state & GETOPT_VALUE_INVALID ) ? -1 : 0;
+		default:
+			return 0; /* strings, paths and flags */
+	}
+}
+
+int getopt_store_get_int32( const getopt_store_t* store, const getopt_option_t* opt, int* out )
+{
+	if( getopt_store_get( store, opt ) == 0x0 )
+		return -1;
+
+	/* store is const for the caller, the cache is not */
+	getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+	if( ( value->state & ( GETOPT_VALUE_I32_CACHED | GETOPT_VALUE_I32_INVALID ) ) == 0 )
+		getopt_store_convert_int32( value );
+
+	if( value->state & GETOPT_VALUE_I32_INVALID )
+		return -1;
+
+	*out = value->i32;
+	return 0;
+}
+
+int getopt_store_get_fp32( const getopt_store_t* store, const getopt_option_t* opt, float* out )
+{
+	if( getopt_store_get( store, opt ) == 0x0 )
+		return -1;
+
+	getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+	if( ( value->state & ( GETOPT_VALUE_FP32_CACHED | GETOPT_VALUE_FP32_INVALID ) ) == 0 )
+		getopt_store_convert_fp32( value );
+
+	if( value->state & GETOPT_VALUE_FP32_INVALID )
+		return -1;
+
+	*out = value->fp32;
+	return 0;
+}
+
+void getopt_store_set_strict( getopt_store_t* store, const getopt_option_t* opt, int strict )
+{
+	getopt_value_t* value = store->values + getopt_option_index( store->ctx, opt );
+	if( strict )
+		value->state |= GETOPT_VALUE_STRICT;
+	else
+		value->state &= ~GETOPT_VALUE_STRICT;
+}
+
+int getopt_store_check( getopt_store_t* store, const getopt_option_t** failed )
+{
+	int i = 0;
+	for( ; i < store->ctx->num_opts; ++i )
+	{
+		if( ( store->values[i].state & GETOPT_VALUE_STRICT ) == 0 )
+			continue;
+
+		const getopt_option_t* opt = getopt_option_at( store->ctx, i );
+		if( getopt_store_convert( store, opt ) < 0 )
+		{
+			if( failed )
+				*failed = opt;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+#define GETOPT_SNAPSHOT_MAGIC   0x50414e53u /* "SNAP" */
+#define GETOPT_SNAPSHOT_VERSION 1u
+
+static unsigned long long getopt_snapshot_hash_bytes( unsigned long long hash, const void* data, size_t size )
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i = 0;
+	for( ; i < size; ++i )
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/* fnv-1a over names and types of all options, a snapshot can only be read with the same options-list */
+static unsigned long long getopt_snapshot_schema_hash( const getopt_context_t* ctx )
+{
+	unsigned long long hash = 0xcbf29ce484222325ull;
+	int i = 0;
+	for( ; i < ctx->num_opts; ++i )
+	{
+		const getopt_option_t* opt = getopt_option_at( ctx, i );
+		const char* name = opt->name ? opt->name : "";
+		int type = (int)opt->type;
+		hash = getopt_snapshot_hash_bytes( hash, name, strlen( name ) + 1 );
+		hash = getopt_snapshot_hash_bytes( hash, &opt->name_short, sizeof( opt->name_short ) );
+		hash = getopt_snapshot_hash_bytes( hash, &type, sizeof( type ) );
+	}
+	return hash;
+}
+
+/* index of an earlier set value with the same string as value i, -1 if none */
+static int getopt_snapshot_find_equal( const getopt_store_t* store, int i )
+{
+	const getopt_value_t* value = store->values + i;
+	int j = 0;
+	for( ; j < i; ++j )
+	{
+		const getopt_value_t* other = store->values + j;
+		if( other->source != GETOPT_SOURCE_NONE && other->str_len == value->str_len && memcmp( other->str, value->str, value->str_len ) == 0 )
+			return j;
+	}
+	return -1;
+}
+
+int getopt_snapshot_write( const getopt_store_t* store, void* buffer, size_t buffer_size )
+{
+	const getopt_context_t* ctx = store->ctx;
+	int num_values = ctx->num_opts;
+
+	size_t size = sizeof( getopt_snapshot_t ) + sizeof( getopt_snapshot_value_t ) * (size_t)num_values;
+	int i = 0;
+	for( ; i < num_values; ++i )
+		if( store->values[i].source != GETOPT_SOURCE_NONE && getopt_snapshot_find_equal( store, i ) < 0 )
+			size += store->values[i].str_len + 1;
+	size = ( size + 7 ) & ~(size_t)7;
+
+	if( size > 0x7fffffff )
+		return -1;
+	if( size > buffer_size )
+		return (int)size;
+
+	getopt_snapshot_t* snapshot = (getopt_snapshot_t*)buffer;
+	snapshot->magic       = GETOPT_SNAPSHOT_MAGIC;
+	snapshot->version     = GETOPT_SNAPSHOT_VERSION;
+	snapshot->size        = (unsigned int)size;
+	snapshot->num_values  = (unsigned int)num_values;
+	snapshot->schema_hash = getopt_snapshot_schema_hash( ctx );
+
+	getopt_snapshot_value_t* values = (getopt_snapshot_value_t*)( snapshot + 1 );
+	char* base     = (char*)buffer;
+	char* str_data = (char*)( values + num_values );
+	memset( values, 0x0, size - sizeof( getopt_snapshot_t ) );
+
+	for( i = 0; i < num_values; ++i )
+	{
+		const getopt_value_t*    value = store->values + i;
+		getopt_snapshot_value_t* out   = values + i;
+		out->source = (unsigned int)value->source;
+		if( value->source == GETOPT_SOURCE_NONE )
+			continue;
+
+		int equal = getopt_snapshot_find_equal( store, i );
+		if( equal >= 0 )
+			out->str_offset = values[equal].str_offset;
+		else
+		{
+			out->str_offset = (unsigned int)( str_data - base );
+			memcpy( str_data, value->str, value->str_len );
+			str_data += value->str_len + 1; /* zero-terminated by the memset above */
+		}
+		out->str_len = (unsigned int)value->str_len;
+
+		/* the copy is zero-terminated, so it can be converted directly */
+		out->valid = getopt_convert_value( getopt_option_at( ctx, i ), base + out->str_offset, &out->value ) == 0;
+		if( !out->valid )
+			out->value.u64 = 0;
+	}
+
+	return (int)size;
+}
+
+const getopt_snapshot_t* getopt_snapshot_open( const void* data, size_t size, const getopt_context_t* ctx )
+{
+	const getopt_snapshot_t* snapshot = (const getopt_snapshot_t*)data;
+	if( size < sizeof( getopt_snapshot_t ) ||
+		snapshot->magic != GETOPT_SNAPSHOT_MAGIC ||
+		snapshot->version != GETOPT_SNAPSHOT_VERSION ||
+		snapshot->size > size ||
+		snapshot->num_values != (unsigned int)ctx->num_opts ||
+		snapshot->size < sizeof( getopt_snapshot_t ) + sizeof( getopt_snapshot_value_t ) * snapshot->num_values ||
+		snapshot->schema_hash != getopt_snapshot_schema_hash( ctx ) )
+		return 0x0;
+
+	/* all strings need to be inside the snapshot and zero-terminated */
+	const getopt_snapshot_value_t* values = (const getopt_snapshot_value_t*)( snapshot + 1 );
+	const char* base = (const char*)data;
+	unsigned int i = 0;
+	for( ; i < snapshot->num_values; ++i )
+	{
+		const getopt_snapshot_value_t* value = values + i;
+		if( value->source == GETOPT_SOURCE_NONE )
+			continue;
+		if( value->str_offset >= snapshot->size || snapshot->size - value->str_offset <= value->str_len || base[value->str_offset + value->str_len] != '\0' )
+			return 0x0;
+	}
+	return snapshot;
+}
+
+const getopt_snapshot_value_t* getopt_snapshot_get( const getopt_snapshot_t* snapshot, const getopt_context_t* ctx, const getopt_option_t* opt )
+{
+	if( opt == 0x0 )
+		return 0x0;
+
+	const getopt_snapshot_value_t* value = (const getopt_snapshot_value_t*)( snapshot + 1 ) + getopt_option_index( ctx, opt );
+	return value->source == GETOPT_SOURCE_NONE ? 0x0 : value;
+}
+
+const char* getopt_snapshot_str( const getopt_snapshot_t* snapshot, const getopt_snapshot_value_t* value )
+{
+	return (const char*)snapshot + value->str_offset;
+}
+
+#if defined(_MSC_VER)
+#   define GETOPT_ATOMIC_LOAD( ptr )         _InterlockedCompareExchange( (ptr), 0, 0 )
+#   define GETOPT_ATOMIC_STORE( ptr, value ) _InterlockedExchange( (ptr), (value) )
+#   define GETOPT_ATOMIC_AND( ptr, value )   _InterlockedAnd( (volatile long*)(ptr), (long)(value) )
+#   define GETOPT_ATOMIC_OR( ptr, value )    _InterlockedOr( (volatile long*)(ptr), (long)(value) )
+#   define GETOPT_ATOMIC_ADD( ptr, value )   _InterlockedExchangeAdd( (ptr), (value) )
+#   define GETOPT_ATOMIC_FENCE()             MemoryBarrier()
+#else
+#   define GETOPT_ATOMIC_LOAD( ptr )         __atomic_load_n( (ptr), __ATOMIC_ACQUIRE )
+#   define GETOPT_ATOMIC_STORE( ptr, value ) __atomic_store_n( (ptr), (value), __ATOMIC_RELEASE )
+#   define GETOPT_ATOMIC_AND( ptr, value )   __atomic_fetch_and( (ptr), (value), __ATOMIC_RELEASE )
+#   define GETOPT_ATOMIC_OR( ptr, value )    __atomic_fetch_or( (ptr), (value), __ATOMIC_RELEASE )
+#   define GETOPT_ATOMIC_ADD( ptr, value )   __atomic_fetch_add( (ptr), (value), __ATOMIC_SEQ_CST )
+#   define GETOPT_ATOMIC_FENCE()             __atomic_thread_fence( __ATOMIC_SEQ_CST )
+#endif
+
+/* fill the cache of all set values, readers of a store that is published never write to it after this */
+static void getopt_store_convert_all( getopt_store_t* store )
+{
+	int i = 0;
+	for( ; i < store->ctx->num_opts; ++i )
+	{
+		getopt_value_t* value = store->values + i;
+		if( value->source == GETOPT_SOURCE_NONE )
+			continue;
+
+		if( ( value->state & ( GETOPT_VALUE_I32_CACHED | GETOPT_VALUE_I32_INVALID ) ) == 0 )
+			getopt_store_convert_int32( value );
+		if( ( value->state & ( GETOPT_VALUE_FP32_CACHED | GETOPT_VALUE_FP32_INVALID ) ) == 0 )
+			getopt_store_convert_fp32( value );
+		getopt_store_convert( store, getopt_option_at( store->ctx, i ) );
+	}
+}
+
+/* write the flag of a flag-option that was set, or undo the flag-operation as "--no-<name>" when it was unset */
+static void getopt_store_write_flag( const getopt_option_t* opt, int set )
+{
+	if( opt->flag == 0x0 )
+		return;
+
+	switch( opt->type )
+	{
+		case GETOPT_OPTION_TYPE_FLAG_SET:
+			if( set )
+				GETOPT_ATOMIC_STORE( opt->flag, opt->value );
+			else
+				GETOPT_ATOMIC_STORE( opt->flag, 0 );
+			break;
+		case GETOPT_OPTION_TYPE_FLAG_AND:
+			if( set )
+				GETOPT_ATOMIC_AND( opt->flag, opt->value );
+			else
+				GETOPT_ATOMIC_OR( opt->flag, ~opt->value );
+			break;
+		case GETOPT_OPTION_TYPE_FLAG_OR:
+			if( set )
+				GETOPT_ATOMIC_OR( opt->flag, opt->value );
+			else
+				GETOPT_ATOMIC_AND( opt->flag, ~opt->value );
+			break;
+		default:
+			break;
+	}
+}
+
+/* st_mtime alone only has whole seconds, a second write within the same second would not be seen */
+static void getopt_store_file_stamp( const char* path, getopt_store_file_stamp_t* stamp )
+{
+	struct stat st;
+	if( stat( path, &st ) < 0 )
+	{
+		stamp->mtime      = -1;
+		stamp->mtime_nsec = 0;
+		stamp->size       = -1;
+		stamp->ino        = 0;
+		return;
+	}
+
+	stamp->mtime = (long long)st.st_mtime;
+#if defined(_WIN32)
+	stamp->mtime_nsec = 0;
+#elif defined(__APPLE__)
+	stamp->mtime_nsec = (long)st.st_mtimespec.tv_nsec;
+#else
+	stamp->mtime_nsec = (long)st.st_mtim.tv_nsec;
+#endif
+	stamp->size = (long long)st.st_size;
+	stamp->ino  = (unsigned long long)st.st_ino;
+}
+
+static int getopt_store_file_stamp_equal( const getopt_store_file_stamp_t* a, const getopt_store_file_stamp_t* b )
+{
+	return a->mtime      == b->mtime &&
+		   a->mtime_nsec == b->mtime_nsec &&
+		   a->size       == b->size &&
+		   a->ino        == b->ino;
+}
+
+#if defined(GETOPT_HAS_INOTIFY)
+static void getopt_store_watch_add( getopt_store_watch_t* watch )
+{
+	/* editors often replace the file instead of writing it, then the watch has to be added to the new file */
+	watch->wd = inotify_add_watch( watch->fd, watch->path, IN_CLOSE_WRITE | IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB );
+}
+#endif
+
+/* read file at path into buffer, returns -1 if it could not be read or do not fit */
+static int getopt_store_read_file( const char* path, char* buffer, size_t buffer_size, size_t* out_size )
+{
+	FILE* f = fopen( path, "rb" );
+	if( f == 0x0 )
+		return -1;
+
+	size_t size = fread( buffer, 1, buffer_size, f );
+	int too_large = size == buffer_size && fgetc( f ) != EOF;
+	int failed = ferror( f );
+	fclose( f );
+
+	if( too_large || failed )
+		return -1;
+	*out_size = size;
+	return 0;
+}
+
+int getopt_store_watch_init( getopt_store_watch_t* watch, getopt_store_t* store, getopt_store_t* back_store, const char* path, char* buffers[2], size_t buffer_size )
+{
+	if( store->ctx != back_store->ctx || store->values == back_store->values || store->mapped != 0x0 )
+		return -1;
+
+	watch->stores[0]    = store;
+	watch->stores[1]    = back_store;
+	watch->buffers[0]   = buffers[0];
+	watch->buffers[1]   = buffers[1];
+	watch->data_size[0] = 0;
+	watch->data_size[1] = 0;
+	watch->buffer_size  = buffer_size;
+	watch->current      = 0;
+	watch->readers[0]   = 0;
+	watch->readers[1]   = 0;
+	watch->path         = path;
+	watch->fd           = -1;
+	watch->wd           = -1;
+
+	/* stamp before reading so a write during the read is seen by the next poll */
+	getopt_store_file_stamp( path, &watch->stamp );
+
+#if defined(GETOPT_HAS_INOTIFY)
+	/* start watching before reading so no change is missed */
+	watch->fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if( watch->fd >= 0 )
+		getopt_store_watch_add( watch );
+#endif
+
+	if( getopt_store_read_file( path, buffers[0], buffer_size, &watch->data_size[0] ) < 0 )
+	{
+		getopt_store_watch_release( watch );
+		return -1;
+	}
+
+	int res = getopt_store_read_config( store, buffers[0], watch->data_size[0] );
+	getopt_store_convert_all( store );
+	return res;
+}
+
+void getopt_store_watch_release( getopt_store_watch_t* watch )
+{
+#if defined(GETOPT_HAS_INOTIFY)
+	if( watch->fd >= 0 )
+		close( watch->fd );
+#endif
+	watch->fd = -1;
+	watch->wd = -1;
+}
+
+const getopt_store_t* getopt_store_watch_current( const getopt_store_watch_t* watch )
+{
+	return watch->stores[ GETOPT_ATOMIC_LOAD( (volatile long*)&watch->current ) ];
+}
+
+const getopt_store_t* getopt_store_watch_acquire( getopt_store_watch_t* watch )
+{
+	for( ;; )
+	{
+		long current = GETOPT_ATOMIC_LOAD( &watch->current );
+		GETOPT_ATOMIC_ADD( &watch->readers[current], 1 );
+
+		/* pairs with the fence in getopt_store_watch_busy(), either the reload sees this reader or this reader
+		   sees that the store was switched and tries again */
+		GETOPT_ATOMIC_FENCE();
+		if( GETOPT_ATOMIC_LOAD( &watch->current ) == current )
+			return watch->stores[current];
+
+		GETOPT_ATOMIC_ADD( &watch->readers[current], -1 );
+	}
+}
+
+void getopt_store_watch_done( getopt_store_watch_t* watch, const getopt_store_t* store )
+{
+	GETOPT_ATOMIC_ADD( &watch->readers[store == watch->stores[1]], -1 );
+}
+
+/* returns 1 if a reader still uses the store that the next reload would rewrite */
+static int getopt_store_watch_busy( getopt_store_watch_t* watch )
+{
+	long current = GETOPT_ATOMIC_LOAD( &watch->current ); /* only written by the reloading thread */
+	GETOPT_ATOMIC_FENCE();
+	return GETOPT_ATOMIC_LOAD( &watch->readers[!current] ) != 0;
+}
+
+static int getopt_store_value_equal( const getopt_value_t* a, const getopt_value_t* b )
+{
+	if( a->source != b->source )
+		return 0;
+	if( a->source == GETOPT_SOURCE_NONE )
+		return 1;
+	return a->str_len == b->str_len && memcmp( a->str, b->str, a->str_len ) == 0;
+}
+
+/* consume all pending inotify-events, returns 1 if there were any, 0 if not and -1 if inotify is not used */
+static int getopt_store_watch_read_events( getopt_store_watch_t* watch )
+{
+#if defined(GETOPT_HAS_INOTIFY)
+	if( watch->fd < 0 )
+		return -1;
+
+	int has_changed = 0;
+	char events[4096];
+	ssize_t len;
+	while( ( len = read( watch->fd, events, sizeof( events ) ) ) > 0 )
+	{
+		const char* ev = events;
+		while( ev < events + len )
+		{
+			const struct inotify_event* event = (const struct inotify_event*)(const void*)ev;
+			if( event->mask & ( IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED ) )
+			{
+				inotify_rm_watch( watch->fd, watch->wd );
+				getopt_store_watch_add( watch );
+			}
+			has_changed = 1;
+			ev += sizeof( struct inotify_event ) + event->len;
+		}
+	}
+
+	/* the file might not have existed when the watch was added */
+	if( watch->wd < 0 )
+	{
+		getopt_store_watch_add( watch );
+		has_changed = watch->wd >= 0;
+	}
+	return has_changed;
+#else
+	(void)watch;
+	return -1;
+#endif
+}
+
+int getopt_store_watch_reload( getopt_store_watch_t* watch, getopt_store_change_func changed, void* userdata )
+{
+	if( getopt_store_watch_busy( watch ) )
+		return -2;
+
+	/* events up until now are covered by this reload */
+	getopt_store_watch_read_events( watch );
+
+	long            current = GETOPT_ATOMIC_LOAD( &watch->current ); /* only written by the reloading thread */
+	getopt_store_t* front   = watch->stores[current];
+	getopt_store_t* back    = watch->stores[!current];
+	int             num_opts = front->ctx->num_opts;
+
+	/* stamp before reading so a write during the read is seen by the next poll */
+	getopt_store_file_stamp_t stamp;
+	getopt_store_file_stamp( watch->path, &stamp );
+
+	size_t size;
+	if( getopt_store_read_file( watch->path, watch->buffers[!current], watch->buffer_size, &size ) < 0 )
+		return -1;
+	watch->stamp = stamp;
+	watch->data_size[!current] = size;
+
+	/* no reader has acquired the back store, readers of getopt_store_watch_current() got it before the last reload */
+	memcpy( back->values, front->values, sizeof( getopt_value_t ) * (size_t)num_opts );
+
+	const char* old_data = watch->buffers[current];
+	size_t      old_size = watch->data_size[current];
+	const char* new_data = watch->buffers[!current];
+	size_t      new_size = size;
+
+	/* find the unchanged lines at start and end of the file, only lines in between need to be parsed */
+	size_t min_size = old_size < new_size ? old_size : new_size;
+	size_t prefix = 0;
+	while( prefix < min_size && old_data[prefix] == new_data[prefix] )
+		++prefix;
+	while( prefix > 0 && old_data[prefix - 1] != '\n' )
+		--prefix;
+
+	size_t suffix = 0;
+	while( suffix < min_size - prefix && old_data[old_size - suffix - 1] == new_data[new_size - suffix - 1] )
+		++suffix;
+	while( suffix > 0 && !( ( suffix == old_size || old_data[old_size - suffix - 1] == '\n' ) &&
+							( suffix == new_size || new_data[new_size - suffix - 1] == '\n' ) ) )
+		--suffix;
+
+	const char* new_suffix = new_data + new_size - suffix;
+
+	/* move values from unchanged lines over to the new mapping, values from changed lines are unset until parsed again */
+	int num_unset = 0;
+	int i = 0;
+	for( ; i < num_opts; ++i )
+	{
+		getopt_value_t* value = back->values + i;
+		if( value->source != GETOPT_SOURCE_CONFIG_FILE )
+			continue;
+
+		size_t offset = (size_t)( value->str - old_data );
+		if( offset < prefix )
+			value->str = new_data + offset;
+		else if( offset >= old_size - suffix )
+			value->str = new_suffix + ( offset - ( old_size - suffix ) );
+		else
+		{
+			unsigned int strict = value->state & GETOPT_VALUE_STRICT;
+			memset( value, 0x0, sizeof( getopt_value_t ) );
+			value->state = strict;
+			++num_unset;
+		}
+	}
+
+	/* an unset option might also be set by an earlier unchanged line */
+	if( num_unset > 0 )
+		getopt_store_parse_lines( back, new_data, new_data + prefix, 1, new_suffix );
+	getopt_store_parse_lines( back, new_data + prefix, new_suffix, 1, new_suffix );
+
+	/* convert before readers can see the values, readers should never write to the cache */
+	getopt_store_convert_all( back );
+
+	for( i = 0; i < num_opts; ++i )
+	{
+		const getopt_value_t* old_value = front->values + i;
+		const getopt_value_t* new_value = back->values + i;
+		if( getopt_store_value_equal( old_value, new_value ) )
+			continue;
+
+		/* flags are read by other threads */
+		const getopt_option_t* opt = getopt_option_at( front->ctx, i );
+		getopt_store_write_flag( opt, new_value->source != GETOPT_SOURCE_NONE );
+
+		if( changed )
+			changed( opt,
+					 old_value->source == GETOPT_SOURCE_NONE ? 0x0 : old_value,
+					 new_value->source == GETOPT_SOURCE_NONE ? 0x0 : new_value,
+					 userdata );
+	}
+
+	GETOPT_ATOMIC_STORE( &watch->current, !current );
+	return 0;
+}
+
+int getopt_store_watch_poll( getopt_store_watch_t* watch, getopt_store_change_func changed, void* userdata )
+{
+	/* leave the events pending, the change is found again when the back store is no longer used */
+	if( getopt_store_watch_busy( watch ) )
+		return 0;
+
+	int has_changed = getopt_store_watch_read_events( watch );
+	if( has_changed < 0 )
+	{
+		getopt_store_file_stamp_t stamp;
+		getopt_store_file_stamp( watch->path, &stamp );
+		has_changed = !getopt_store_file_stamp_equal( &stamp, &watch->stamp );
+	}
+
+	if( !has_changed )
+		return 0;
+
+	return getopt_store_watch_reload( watch, changed, userdata ) < 0 ? -1 : 1;
+}
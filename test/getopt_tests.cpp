@@ -26,6 +26,18 @@
 
 #include "greatest.h"
 #include <getopt/getopt.h>
+#include <getopt/getopt_store.h>
+
+#if __cplusplus >= 201703L || ( defined(_MSVC_LANG) && _MSVC_LANG >= 201703L )
+#  include <getopt/getopt.hpp>
+#  include <type_traits>
+#  define GETOPT_TEST_CPP17
+#endif
+
+#include <errno.h>
+#if !defined(_WIN32)
+#  include <sys/stat.h> // mkdir
+#endif
 
 #define ARRAY_LENGTH( arr ) ( sizeof( arr ) / sizeof( arr[0] ) )
 
@@ -33,23 +45,23 @@ int g_flag = -1;
 
 static const getopt_option_t option_list[] = 
 {
-	{ "aaaa", 'a', GETOPT_OPTION_TYPE_NO_ARG,          0x0,      'a', "help a", 0 },
-	{ "bbbb", 'b', GETOPT_OPTION_TYPE_NO_ARG,          0x0,      'b', "help b", 0 },
-	{ "cccc", 'c', GETOPT_OPTION_TYPE_REQUIRED,        0x0,      'c', "help c", 0 },
-	{ "dddd", 'd', GETOPT_OPTION_TYPE_OPTIONAL,        0x0,      'd', "help d", 0 },
-	{ "eeee", 'e', GETOPT_OPTION_TYPE_FLAG_SET,        &g_flag, 1337, "help e", 0 },
-	{ "ffff", 'f', GETOPT_OPTION_TYPE_FLAG_AND,        &g_flag,    1, "help f", 0 },
-	{ "gggg", 'g', GETOPT_OPTION_TYPE_FLAG_OR ,        &g_flag,    1, "help g", 0 },
-	{ "hhhh", 'h', GETOPT_OPTION_TYPE_NO_ARG,          0x0,        0, "help h", 0 },
+	{ "aaaa", 'a', GETOPT_OPTION_TYPE_NO_ARG,          0x0,      'a', "help a", 0, 0x0, 0 },
+	{ "bbbb", 'b', GETOPT_OPTION_TYPE_NO_ARG,          0x0,      'b', "help b", 0, 0x0, 0 },
+	{ "cccc", 'c', GETOPT_OPTION_TYPE_REQUIRED,        0x0,      'c', "help c", 0, 0x0, 0 },
+	{ "dddd", 'd', GETOPT_OPTION_TYPE_OPTIONAL,        0x0,      'd', "help d", 0, 0x0, 0 },
+	{ "eeee", 'e', GETOPT_OPTION_TYPE_FLAG_SET,        &g_flag, 1337, "help e", 0, 0x0, 0 },
+	{ "ffff", 'f', GETOPT_OPTION_TYPE_FLAG_AND,        &g_flag,    1, "help f", 0, 0x0, 0 },
+	{ "gggg", 'g', GETOPT_OPTION_TYPE_FLAG_OR ,        &g_flag,    1, "help g", 0, 0x0, 0 },
+	{ "hhhh", 'h', GETOPT_OPTION_TYPE_NO_ARG,          0x0,        0, "help h", 0, 0x0, 0 },
 	GETOPT_OPTIONS_END
 };
 
 static const getopt_option_t parse_option_list[] = 
 {
-	{ "ri32", 'a', GETOPT_OPTION_TYPE_REQUIRED_INT32,  0x0,      'a', "help a", 0 },
-	{ "rf32", 'b', GETOPT_OPTION_TYPE_REQUIRED_FP32,   0x0,      'b', "help b", 0 },
-	{ "oi32", 'c', GETOPT_OPTION_TYPE_OPTIONAL_INT32,  0x0,      'c', "help c", 0 },
-	{ "of32", 'd', GETOPT_OPTION_TYPE_OPTIONAL_FP32,   0x0,      'd', "help d", 0 },
+	{ "ri32", 'a', GETOPT_OPTION_TYPE_REQUIRED_INT32,  0x0,      'a', "help a", 0, 0x0, 0 },
+	{ "rf32", 'b', GETOPT_OPTION_TYPE_REQUIRED_FP32,   0x0,      'b', "help b", 0, 0x0, 0 },
+	{ "oi32", 'c', GETOPT_OPTION_TYPE_OPTIONAL_INT32,  0x0,      'c', "help c", 0, 0x0, 0 },
+	{ "of32", 'd', GETOPT_OPTION_TYPE_OPTIONAL_FP32,   0x0,      'd', "help d", 0, 0x0, 0 },
 	GETOPT_OPTIONS_END
 };
 
@@ -576,8 +588,8 @@ TEST same_prefix_long_opt()
 {
 	static const getopt_option_t bug_option_list[] = 
 	{
-		{ "input", 		   0x0, GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'i', "help input", "input value" },
-		{ "input-variant", 0x0, GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'I', "help input-variant", "input variant" },
+		{ "input", 		   0x0, GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'i', "help input", "input value", 0x0, 0 },
+		{ "input-variant", 0x0, GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'I', "help input-variant", "input variant", 0x0, 0 },
 		GETOPT_OPTIONS_END
 	};
 
@@ -615,7 +627,7 @@ TEST no_longopt_with_longopt()
 {
 	static const getopt_option_t bug_option_list[] = 
 	{
-		{ 0x0, 'a', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
+		{ 0x0, 'a', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
 		GETOPT_OPTIONS_END
 	};
 
@@ -656,7 +668,7 @@ TEST capture_bad_longopt()
 		static const getopt_option_t bug_option_list[] = 
 		{
 			// args are not allowed to begin with one '-'
-			{ "-bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
+			{ "-bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
 			GETOPT_OPTIONS_END
 		};
 		
@@ -669,7 +681,7 @@ TEST capture_bad_longopt()
 		static const getopt_option_t bug_option_list[] = 
 		{
 			// args are not allowed to begin with two '-'
-			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
+			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
 			GETOPT_OPTIONS_END
 		};
 		
@@ -682,8 +694,8 @@ TEST capture_bad_longopt()
 	{
 		static const getopt_option_t bug_option_list[] = 
 		{
-			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
-			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value" },
+			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
+			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value", 0x0, 0 },
 			GETOPT_OPTIONS_END
 		};
 		
@@ -695,8 +707,8 @@ TEST capture_bad_longopt()
 	{
 		static const getopt_option_t bug_option_list[] = 
 		{
-			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value" },
-			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
+			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value", 0x0, 0 },
+			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
 			GETOPT_OPTIONS_END
 		};
 		
@@ -708,9 +720,9 @@ TEST capture_bad_longopt()
 	{
 		static const getopt_option_t bug_option_list[] = 
 		{
-			{ "j",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'c', "help input", "input value" },
-			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value" },
-			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value" },
+			{ "j",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'c', "help input", "input value", 0x0, 0 },
+			{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help input", "input value", 0x0, 0 },
+			{ "i",     0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help input", "input value", 0x0, 0 },
 			GETOPT_OPTIONS_END
 		};
 		
@@ -722,6 +734,1942 @@ TEST capture_bad_longopt()
 	return 0;
 }
 
+static const getopt_option_t abbrev_option_list[] =
+{
+	{ "verbose",       'v', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'v', "help verbose",       0, 0x0, 0 },
+	{ "version",       'V', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'V', "help version",       0, 0x0, 0 },
+	{ "input",         'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'i', "help input",         "FILE", 0x0, 0 },
+	{ "input-variant", 'I', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'I', "help input-variant", "FILE", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static int test_abbreviations( bool use_index )
+{
+	const char* argv[] = { "dummy_prog", "--verb", "--VERS", "--ver", "--input", "in", "--input-v=variant", "--inputx" };
+	int argc = (int)ARRAY_LENGTH( argv );
+
+	getopt_index_entry_t index[ARRAY_LENGTH( abbrev_option_list )];
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, argc, argv, abbrev_option_list ) );
+	if( use_index )
+		ASSERT_EQ( 0, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_ALLOW_ABBREVIATIONS );
+
+	ASSERT_EQ( 'v', getopt_next( &ctx ) );
+	ASSERT_EQ( 'V', getopt_next( &ctx ) );
+
+	// ... ambiguous, the candidates can be found via getopt_lookup_prefix() ...
+	ASSERT_EQ( '?', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "--ver", ctx.current_opt_arg );
+	const getopt_option_t* candidates[4];
+	ASSERT_EQ( 2, getopt_lookup_prefix( &ctx, "ver", 3, candidates, 4 ) );
+	ASSERT( ( candidates[0]->value == 'v' && candidates[1]->value == 'V' ) || ( candidates[0]->value == 'V' && candidates[1]->value == 'v' ) );
+	ASSERT_EQ( 2, getopt_lookup_prefix( &ctx, "ver", 3, candidates, 1 ) );
+
+	// ... an exact match wins over a longer option with the same prefix ...
+	ASSERT_EQ( 'i', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "in", ctx.current_opt_arg );
+	ASSERT_EQ( 'I', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "variant", ctx.current_opt_arg );
+
+	ASSERT_EQ( '?', getopt_next( &ctx ) );
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+	return 0;
+}
+
+TEST enum_and_bitmask()
+{
+	static const getopt_option_t choice_option_list[] =
+	{
+		{ "mode",     'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM,    0x0, 'm', "help mode",     "fast|balanced|safe", 0x0, 0 },
+		{ "features", 'f', GETOPT_OPTION_TYPE_REQUIRED_BITMASK, 0x0, 'f', "help features", "simd|mmap|async", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	const char* argv[] = { "dummy_prog", "--mode=safe", "-f", "async,simd", "--mode", "Fast", "--features=mmap,", "--mode" };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, choice_option_list ) );
+
+	ASSERT_EQ( 'm', getopt_next( &ctx ) );
+	ASSERT_EQ( 2, ctx.current_value.i32 );
+	ASSERT_EQ( 'f', getopt_next( &ctx ) );
+	ASSERT_EQ( 5u, ctx.current_value.u32 );
+
+	// ... names are case-sensitive and the valid names can be found from current_opt ...
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "mode", ctx.current_opt_arg );
+	ASSERT_STR_EQ( "fast|balanced|safe", ctx.current_opt->value_desc );
+
+	ASSERT_EQ( '!', getopt_next( &ctx ) ); // ... empty name in list ...
+	ASSERT_EQ( '!', getopt_next( &ctx ) ); // ... missing argument ...
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+
+	// ... lists with duplicate or empty names are invalid ...
+	static const getopt_option_t dup_option_list[] =
+	{
+		{ "mode", 'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM, 0x0, 'm', "help mode", "fast|safe|fast", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	static const getopt_option_t empty_option_list[] =
+	{
+		{ "mode", 'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM, 0x0, 'm', "help mode", "fast||safe", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	ASSERT_EQ( -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, dup_option_list ) );
+	ASSERT_EQ( -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, empty_option_list ) );
+	return 0;
+}
+
+static int check_unit_value( const getopt_option_t* opts, const char* token, unsigned long long expect )
+{
+	const char* argv[] = { "dummy_prog", token };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, opts ) );
+	if( expect == ~0ull )
+	{
+		ASSERT_EQ( '!', getopt_next( &ctx ) );
+		return 0;
+	}
+	ASSERT_EQ( 'u', getopt_next( &ctx ) );
+	ASSERT_EQ( expect, ctx.current_value.u64 );
+	return 0;
+}
+
+TEST unit_values()
+{
+	static const getopt_option_t size_opts[]     = { { "u", 'u', GETOPT_OPTION_TYPE_REQUIRED_SIZE,     0x0, 'u', "help", "SIZE", 0x0, 0 }, GETOPT_OPTIONS_END };
+	static const getopt_option_t duration_opts[] = { { "u", 'u', GETOPT_OPTION_TYPE_REQUIRED_DURATION, 0x0, 'u', "help", "TIME", 0x0, 0 }, GETOPT_OPTIONS_END };
+	static const getopt_option_t rate_opts[]     = { { "u", 'u', GETOPT_OPTION_TYPE_REQUIRED_RATE,     0x0, 'u', "help", "RATE", 0x0, 0 }, GETOPT_OPTIONS_END };
+	const unsigned long long invalid = ~0ull;
+
+	if( check_unit_value( size_opts, "--u=512",    512ull ) != 0 )                        return -1;
+	if( check_unit_value( size_opts, "--u=512M",   512000000ull ) != 0 )                  return -1;
+	if( check_unit_value( size_opts, "--u=512MiB", 512ull * 1024 * 1024 ) != 0 )          return -1;
+	if( check_unit_value( size_opts, "--u=1.5Ki",  1536ull ) != 0 )                       return -1;
+	if( check_unit_value( size_opts, "--u=.5kB",   500ull ) != 0 )                        return -1;
+	if( check_unit_value( size_opts, "--u=16EiB",  invalid ) != 0 )                       return -1; // ... overflow ...
+	if( check_unit_value( size_opts, "--u=18446744073709551616", invalid ) != 0 )         return -1;
+	if( check_unit_value( size_opts, "--u=18446744073709551614", 18446744073709551614ull ) != 0 ) return -1;
+	if( check_unit_value( size_opts, "--u=12X",    invalid ) != 0 )                       return -1;
+	if( check_unit_value( size_opts, "--u=M",      invalid ) != 0 )                       return -1;
+	if( check_unit_value( size_opts, "--u=-1",     invalid ) != 0 )                       return -1;
+
+	if( check_unit_value( duration_opts, "--u=250ms", 250000000ull ) != 0 )               return -1;
+	if( check_unit_value( duration_opts, "--u=2",     2000000000ull ) != 0 )              return -1;
+	if( check_unit_value( duration_opts, "--u=1.5h",  5400ull * 1000000000ull ) != 0 )    return -1;
+	if( check_unit_value( duration_opts, "--u=10us",  10000ull ) != 0 )                   return -1;
+	if( check_unit_value( duration_opts, "--u=10MB",  invalid ) != 0 )                    return -1;
+
+	if( check_unit_value( rate_opts, "--u=10k/s",   10000ull ) != 0 )                     return -1;
+	if( check_unit_value( rate_opts, "--u=100MB/s", 100000000ull ) != 0 )                 return -1;
+	if( check_unit_value( rate_opts, "--u=100",     100ull ) != 0 )                       return -1;
+	if( check_unit_value( rate_opts, "--u=/s",      invalid ) != 0 )                      return -1;
+	return 0;
+}
+
+TEST constraints()
+{
+	static const getopt_option_t constraint_option_list[] =
+	{
+		{ "input",   'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'i', "help input",   "FILE", 0x0, 0 },
+		{ "output",  'o', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'o', "help output",  "FILE", 0x0, 0 },
+		{ "fast",    'f', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'f', "help fast",    0, 0x0, 0 },
+		{ "safe",    's', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 's', "help safe",    0, 0x0, 0 },
+		{ "tls",     't', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 't', "help tls",     0, 0x0, 0 },
+		{ "tls-key", 'k', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'k', "help tls-key", "FILE", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	static const getopt_constraint_t constraint_list[] =
+	{
+		{ GETOPT_CONSTRAINT_REQUIRED,  "input|output", 0x0 },
+		{ GETOPT_CONSTRAINT_EXCLUSIVE, "fast|safe",    0x0 },
+		{ GETOPT_CONSTRAINT_REQUIRES,  "tls-key",      "tls" },
+		{ GETOPT_CONSTRAINT_ONCE,      "output",       0x0 },
+		GETOPT_CONSTRAINTS_END
+	};
+
+	const char* argv[] = { "dummy_prog", "--safe", "-k", "key.pem", "--fast", "-o", "a", "--output=b" };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, constraint_option_list ) );
+
+	getopt_constraint_set_t set;
+	unsigned long long words[GETOPT_CONSTRAINT_WORDS( ARRAY_LENGTH( constraint_option_list ), ARRAY_LENGTH( constraint_list ) )];
+	ASSERT_EQ( -1, getopt_create_constraints( &ctx, &set, constraint_list, words, 2 ) );
+	ASSERT_EQ( 0,  getopt_create_constraints( &ctx, &set, constraint_list, words, ARRAY_LENGTH( words ) ) );
+
+	while( getopt_next( &ctx ) != -1 ) {}
+
+	// ... all violations are reported at once ...
+	getopt_violation_t violations[2];
+	ASSERT_EQ( 4, getopt_check_constraints( &ctx, violations, (int)ARRAY_LENGTH( violations ) ) );
+	ASSERT_EQ( &constraint_list[0],        violations[0].constraint );
+	ASSERT_EQ( &constraint_option_list[0], violations[0].opt );
+	ASSERT_EQ( &constraint_list[1],        violations[1].constraint );
+	ASSERT_EQ( &constraint_option_list[3], violations[1].opt );
+
+	getopt_violation_t all_violations[4];
+	ASSERT_EQ( 4, getopt_check_constraints( &ctx, all_violations, (int)ARRAY_LENGTH( all_violations ) ) );
+	ASSERT_EQ( &constraint_option_list[4], all_violations[2].opt );
+	ASSERT_EQ( &constraint_option_list[1], all_violations[3].opt );
+
+	// ... a command line that fulfills all constraints ...
+	const char* valid_argv[] = { "dummy_prog", "-i", "a", "-o", "b", "--fast", "--tls" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( valid_argv ), valid_argv, constraint_option_list ) );
+	ASSERT_EQ( 0, getopt_create_constraints( &ctx, &set, constraint_list, words, ARRAY_LENGTH( words ) ) );
+	while( getopt_next( &ctx ) != -1 ) {}
+	ASSERT_EQ( 0, getopt_check_constraints( &ctx, all_violations, (int)ARRAY_LENGTH( all_violations ) ) );
+
+	// ... unknown option-names in constraints are errors ...
+	static const getopt_constraint_t bad_constraint_list[] =
+	{
+		{ GETOPT_CONSTRAINT_REQUIRES, "tls-key", "tls|tls-cert" },
+		GETOPT_CONSTRAINTS_END
+	};
+	ASSERT_EQ( -1, getopt_create_constraints( &ctx, &set, bad_constraint_list, words, ARRAY_LENGTH( words ) ) );
+	return 0;
+}
+
+TEST limits()
+{
+	char long_token[256];
+	memset( long_token, 'a', sizeof( long_token ) - 1 );
+	long_token[0] = '-';
+	long_token[1] = '-';
+	long_token[sizeof( long_token ) - 1] = '\0';
+
+	const char* argv[] = { "dummy_prog", "-a", "--cccc", "arg", long_token, "-b" };
+	getopt_context_t ctx;
+	getopt_limits_t limits;
+
+	// ... token length, the long token is never scanned to its end ...
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_token_len = 64;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( 'c', getopt_next( &ctx ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+	ASSERT_EQ( long_token, ctx.current_opt_arg );
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+
+	// ... token count, an argument to an option is a token as well ...
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_tokens = 2;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "arg", ctx.current_opt_arg );
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+
+	// ... total bytes ...
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_total_bytes = 11;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( 'c', getopt_next( &ctx ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+
+	// ... operations, a short option cost its 2 chars, a long option without an index its chars + every option ...
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_ops = 15;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "--cccc", ctx.current_opt_arg );
+
+	// ... short options are found in a table whatever the number of options ...
+	const char* short_argv[] = { "dummy_prog", "-a", "-b", "-a", "-b", "-a" };
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_ops = 10;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( short_argv ), short_argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	int res;
+	while( ( res = getopt_next( &ctx ) ) != -1 )
+		ASSERT( res != '#' );
+	ASSERT_EQ( 10ul, ctx.used_ops );
+
+	// ... '#' is reserved for limits and is not a valid value of an option ...
+	static const getopt_option_t hash_list[] =
+	{
+		{ "progress", '#', GETOPT_OPTION_TYPE_NO_ARG, 0x0, '#', "", 0x0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	ASSERT_EQ( -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( short_argv ), short_argv, hash_list ) );
+
+	// ... an abbreviation is charged by the names compared, the lookup stops at the second option ...
+	static const getopt_option_t alias_list[] =
+	{
+		{ "alpha", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 1, "", 0x0, "alpha1|alpha2|alpha3|alpha4|alpha5|alpha6|alpha7|alpha8", 0 },
+		{ "alps",  0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 2, "", 0x0, 0x0, 0 },
+		{ "alto",  0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 3, "", 0x0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	const char* alias_argv[] = { "dummy_prog", "--alph", "--alp" };
+	getopt_index_entry_t index[11];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( alias_argv ), alias_argv, alias_list ) );
+	ASSERT_EQ( 0, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_ALLOW_ABBREVIATIONS );
+	ASSERT_EQ( 2, getopt_lookup_prefix( &ctx, "alp", 3, 0x0, 0 ) );
+	ASSERT_EQ( 3, getopt_lookup_prefix( &ctx, "a", 1, 0x0, 0 ) );
+
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_ops = 100;
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 1, getopt_next( &ctx ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "--alp", ctx.current_opt_arg );
+	return 0;
+}
+
+TEST abbreviations()
+{
+	if( test_abbreviations( false ) != 0 ) return -1;
+	if( test_abbreviations( true ) != 0 ) return -1;
+	return 0;
+}
+
+TEST no_abbreviations_by_default()
+{
+	const char* argv[] = { "dummy_prog", "--verb", "--verbose" };
+	int argc = (int)ARRAY_LENGTH( argv );
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, argc, argv, abbrev_option_list ) );
+	ASSERT_EQ( '?', getopt_next( &ctx ) );
+	ASSERT_EQ( 'v', getopt_next( &ctx ) );
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+	return 0;
+}
+
+TEST index_lookup()
+{
+	const char* argv[] = { "dummy_prog", "--cccc=c_value_1", "--AAAA", "-b", "--cccc", "c_value_2", "--dddd", "--aaaax" };
+	int argc = (int)ARRAY_LENGTH( argv );
+
+	getopt_index_entry_t index[ARRAY_LENGTH( option_list )];
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, argc, argv, option_list ) );
+	ASSERT_EQ( -1, getopt_create_index( &ctx, index, 2 ) ); // ... to small ...
+	ASSERT_EQ( 0, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+
+	ASSERT_EQ( &option_list[2], getopt_lookup_long( &ctx, "cccc", 4 ) );
+	ASSERT_EQ( &option_list[2], getopt_lookup_long( &ctx, "cccc=apa", 4 ) );
+	ASSERT_EQ( (const getopt_option_t*)0x0, getopt_lookup_long( &ctx, "ccc", 3 ) );
+	ASSERT_EQ( (const getopt_option_t*)0x0, getopt_lookup_long( &ctx, "ccccc", 5 ) );
+
+	ASSERT_EQ( 'c', getopt_next( &ctx ) ); ASSERT_STR_EQ( "c_value_1", ctx.current_opt_arg );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( 'b', getopt_next( &ctx ) );
+	ASSERT_EQ( 'c', getopt_next( &ctx ) ); ASSERT_STR_EQ( "c_value_2", ctx.current_opt_arg );
+	ASSERT_EQ( 'd', getopt_next( &ctx ) ); ASSERT_EQ( (const char*)0x0, ctx.current_opt_arg );
+	ASSERT_EQ( '?', getopt_next( &ctx ) ); ASSERT_STR_EQ( "--aaaax", ctx.current_opt_arg );
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+
+	// ... duplicate long names can not be indexed ...
+	static const getopt_option_t dup_option_list[] =
+	{
+		{ "same", 'a', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help a", 0, 0x0, 0 },
+		{ 0x0,    'b', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'b', "help b", 0, 0x0, 0 },
+		{ "SAME", 'c', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'c', "help c", 0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+	ASSERT_EQ( 0, getopt_create_context( &ctx, argc, argv, dup_option_list ) );
+	ASSERT_EQ( -1, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+	return 0;
+}
+
+static const getopt_option_t registry_core_list[] =
+{
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'v', "help verbose", 0, 0x0, 0 },
+	{ "output",  'o', GETOPT_OPTION_TYPE_REQUIRED,       0x0, 'o', "help output",  "FILE", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static const getopt_option_t registry_plugin_list[] =
+{
+	{ "zip-level", 'z', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0, 'z', "help zip-level", "N", 0x0, 0 },
+	{ "archive",   'a', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'a', "help archive",   0, 0x0, 0 },
+	{ "no-zip",     0,  GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'n', "help no-zip",    0, 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static int check_registry( getopt_registry_t* registry )
+{
+	static const getopt_option_t dup_long[]  = { { "OUTPUT", 0,  GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'x', "help", 0, 0x0, 0 }, GETOPT_OPTIONS_END };
+	static const getopt_option_t dup_short[] = { { "other",  'v', GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'x', "help", 0, 0x0, 0 }, GETOPT_OPTIONS_END };
+	static const getopt_option_t dup_self[]  =
+	{
+		{ "same", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'x', "help", 0, 0x0, 0 },
+		{ "same", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'y', "help", 0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	const getopt_option_t* conflict = 0x0;
+	ASSERT_EQ( 0, getopt_registry_add( registry, registry_core_list, &conflict ) );
+	ASSERT_EQ( 0, getopt_registry_add( registry, registry_plugin_list, &conflict ) );
+
+	// ... conflicts are reported and leave the registry untouched ...
+	ASSERT_EQ( -1, getopt_registry_add( registry, dup_long, &conflict ) );  ASSERT_EQ( &dup_long[0], conflict );
+	ASSERT_EQ( -1, getopt_registry_add( registry, dup_short, &conflict ) ); ASSERT_EQ( &dup_short[0], conflict );
+	ASSERT_EQ( -1, getopt_registry_add( registry, dup_self, &conflict ) );  ASSERT( conflict == &dup_self[0] || conflict == &dup_self[1] );
+	ASSERT_EQ( 2, registry->num_tables );
+	ASSERT_EQ( 5, registry->num_opts );
+
+	const char* argv[] = { "dummy_prog", "-z", "9", "--Output=file", "--archive", "-v", "--no-zip", "--zip" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context_registry( &ctx, (int)ARRAY_LENGTH( argv ), argv, registry ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_ALLOW_ABBREVIATIONS );
+
+	ASSERT_EQ( 'z', getopt_next( &ctx ) ); ASSERT_EQ( 9, ctx.current_value.i32 );
+	ASSERT_EQ( 'o', getopt_next( &ctx ) ); ASSERT_STR_EQ( "file", ctx.current_opt_arg );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( 'v', getopt_next( &ctx ) );
+	ASSERT_EQ( 'n', getopt_next( &ctx ) );
+	ASSERT_EQ( '!', getopt_next( &ctx ) ); // ... unique abbreviation of --zip-level, missing its arg ...
+	ASSERT_EQ( -1,  getopt_next( &ctx ) );
+
+	// ... options are numbered in registration-order ...
+	ASSERT_EQ( &registry_core_list[1],   getopt_option_at( &ctx, 1 ) );
+	ASSERT_EQ( &registry_plugin_list[0], getopt_option_at( &ctx, 2 ) );
+	ASSERT_EQ( &registry_plugin_list[2], getopt_option_at( &ctx, 4 ) );
+	ASSERT_EQ( 3, getopt_option_index( &ctx, &registry_plugin_list[1] ) );
+	ASSERT_EQ( -1, getopt_option_index( &ctx, &dup_long[0] ) );
+	return 0;
+}
+
+TEST registry()
+{
+	getopt_registry_table_t tables[4];
+	getopt_registry_t registry;
+
+	// ... with room to spare the lists are merged into the index, without it the index is sorted again ...
+	getopt_index_entry_t index[16];
+	ASSERT_EQ( 0, getopt_registry_init( &registry, tables, (int)ARRAY_LENGTH( tables ), index, (int)ARRAY_LENGTH( index ) ) );
+	ASSERT_EQ( 0, check_registry( &registry ) );
+
+	getopt_index_entry_t tight_index[7];
+	ASSERT_EQ( 0, getopt_registry_init( &registry, tables, (int)ARRAY_LENGTH( tables ), tight_index, (int)ARRAY_LENGTH( tight_index ) ) );
+	ASSERT_EQ( 0, check_registry( &registry ) );
+
+	getopt_index_entry_t small_index[4];
+	const getopt_option_t* conflict = &registry_core_list[0];
+	ASSERT_EQ( 0, getopt_registry_init( &registry, tables, (int)ARRAY_LENGTH( tables ), small_index, (int)ARRAY_LENGTH( small_index ) ) );
+	ASSERT_EQ( 0,  getopt_registry_add( &registry, registry_core_list, &conflict ) );
+	ASSERT_EQ( -1, getopt_registry_add( &registry, registry_plugin_list, &conflict ) );
+	ASSERT_EQ( (const getopt_option_t*)0x0, conflict );
+
+	// ... a value-store works on the options of all lists ...
+	const char* argv[] = { "dummy_prog", "--zip-level=3", "-o", "out" };
+	ASSERT_EQ( 0, getopt_registry_init( &registry, tables, (int)ARRAY_LENGTH( tables ), index, (int)ARRAY_LENGTH( index ) ) );
+	ASSERT_EQ( 0, getopt_registry_add( &registry, registry_core_list, 0x0 ) );
+	ASSERT_EQ( 0, getopt_registry_add( &registry, registry_plugin_list, 0x0 ) );
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context_registry( &ctx, (int)ARRAY_LENGTH( argv ), argv, &registry ) );
+	getopt_value_t values[5];
+	getopt_store_t store;
+	ASSERT_EQ( 0, getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+	while( getopt_store_next( &store ) != -1 ) {}
+
+	int zip_level = 0;
+	ASSERT_EQ( 0, getopt_store_get_int32( &store, &registry_plugin_list[0], &zip_level ) );
+	ASSERT_EQ( 3, zip_level );
+	ASSERT_EQ( 3u, (unsigned int)getopt_store_get( &store, &registry_core_list[1] )->str_len );
+	return 0;
+}
+
+static int alias_color  = 0;
+static int alias_quiet  = 0;
+static int alias_checks = 0;
+
+static const getopt_option_t alias_option_list[] =
+{
+	{ "colour", 'c', GETOPT_OPTION_TYPE_FLAG_SET, &alias_color,  1, "color output",  0x0, "color|~colour-output", 1 },
+	{ "quiet",  'q', GETOPT_OPTION_TYPE_FLAG_OR,  &alias_quiet,  2, "less output",   0x0, "silent",               1 },
+	{ "checks",  0,  GETOPT_OPTION_TYPE_FLAG_AND, &alias_checks, 6, "keep checks",   0x0, 0x0,                    1 },
+	{ "output", 'o', GETOPT_OPTION_TYPE_REQUIRED, 0x0,          'o', "output file",  "FILE", "out",               0 },
+	{ "no-op",   0,  GETOPT_OPTION_TYPE_NO_ARG,   0x0,          'n', "do nothing",   0x0, 0x0,                    0 },
+	GETOPT_OPTIONS_END
+};
+
+static void count_deprecated( const getopt_option_t* opt, const char* token, void* userdata )
+{
+	(void)opt; (void)token;
+	++*(int*)userdata;
+}
+
+static int check_aliases( getopt_index_entry_t* index, int index_size )
+{
+	const char* argv[] = { "dummy_prog", "--color", "--no-quiet", "--COLOUR-OUTPUT", "--out=file", "--no-checks", "--no-op", "--no-colour" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, alias_option_list ) );
+	if( index )
+		ASSERT_EQ( 0, getopt_create_index( &ctx, index, index_size ) );
+
+	int deprecated = 0;
+	getopt_set_deprecated_callback( &ctx, count_deprecated, &deprecated );
+
+	alias_color  = 0;
+	alias_quiet  = 3;
+	alias_checks = 1;
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( 1, alias_color );
+	ASSERT_EQ( &alias_option_list[0], ctx.current_opt );
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( 1, alias_quiet );
+	ASSERT_EQ( 0, deprecated );
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( 1, deprecated );
+	ASSERT_EQ( 'o', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "file", ctx.current_opt_arg );
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( -7, alias_checks );
+
+	// ... an option really called "no-<name>" is not a negation ...
+	ASSERT_EQ( 'n', getopt_next( &ctx ) );
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( 0, alias_color );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... only negatable options can be negated ...
+	const char* bad_argv[] = { "dummy_prog", "--no-output", "--no-silent" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( bad_argv ), bad_argv, alias_option_list ) );
+	if( index )
+		ASSERT_EQ( 0, getopt_create_index( &ctx, index, index_size ) );
+	ASSERT_EQ( '?', getopt_next( &ctx ) );
+	ASSERT_EQ( 0, getopt_next( &ctx ) );
+	ASSERT_EQ( 0, alias_quiet & 2 );
+
+	// ... abbreviations are unique if all matching names belong to the same option ...
+	getopt_set_flags( &ctx, GETOPT_FLAG_ALLOW_ABBREVIATIONS );
+	const getopt_option_t* found[2];
+	ASSERT_EQ( 1, getopt_lookup_prefix( &ctx, "col", 3, found, 2 ) );
+	ASSERT_EQ( &alias_option_list[0], found[0] );
+	ASSERT_EQ( &alias_option_list[3], getopt_lookup_long( &ctx, "OUT", 3 ) );
+	ASSERT_EQ( (const getopt_option_t*)0x0, getopt_lookup_long( &ctx, "colou", 5 ) );
+	return 0;
+}
+
+TEST aliases_and_negation()
+{
+	getopt_index_entry_t index[9];
+	ASSERT_EQ( 0, check_aliases( 0x0, 0 ) );
+	ASSERT_EQ( 0, check_aliases( index, (int)ARRAY_LENGTH( index ) ) );
+
+	// ... every alias needs an entry in the index ...
+	const char* argv[] = { "dummy_prog" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, alias_option_list ) );
+	ASSERT_EQ( -1, getopt_create_index( &ctx, index, 8 ) );
+
+	static const getopt_option_t dup_alias[] =
+	{
+		{ "colour", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 1, "", 0x0, "color", 0 },
+		{ "color",  0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 2, "", 0x0, 0x0,     0 },
+		GETOPT_OPTIONS_END
+	};
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, dup_alias ) );
+	ASSERT_EQ( -1, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+
+	static const getopt_option_t bad_alias[]     = { { "a", 0, GETOPT_OPTION_TYPE_NO_ARG,   0x0, 1, "", 0x0, "b||c", 0 }, GETOPT_OPTIONS_END };
+	static const getopt_option_t bad_negatable[] = { { "a", 0, GETOPT_OPTION_TYPE_REQUIRED, 0x0, 1, "", 0x0, 0x0,    1 }, GETOPT_OPTIONS_END };
+	ASSERT_EQ( -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, bad_alias ) );
+	ASSERT_EQ( -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, bad_negatable ) );
+
+	// ... help list each option once ...
+	char buffer[1024];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, alias_option_list ) );
+	getopt_create_help_string( &ctx, buffer, sizeof( buffer ) );
+	ASSERT( strstr( buffer, "--[no-]colour" ) != 0x0 );
+	ASSERT( strstr( buffer, "--color" ) == 0x0 );
+
+	// ... a negated flag is not given for constraints ...
+	static const getopt_constraint_t negated_constraints[] =
+	{
+		{ GETOPT_CONSTRAINT_REQUIRES,  "output", "colour" },
+		{ GETOPT_CONSTRAINT_EXCLUSIVE, "colour|quiet", 0x0 },
+		GETOPT_CONSTRAINTS_END
+	};
+	const char* negated_argv[] = { "dummy_prog", "--colour", "--quiet", "--no-colour", "-o", "file" };
+	getopt_constraint_set_t set;
+	unsigned long long words[GETOPT_CONSTRAINT_WORDS( ARRAY_LENGTH( alias_option_list ), ARRAY_LENGTH( negated_constraints ) )];
+	getopt_violation_t violations[2];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( negated_argv ), negated_argv, alias_option_list ) );
+	ASSERT_EQ( 0, getopt_create_constraints( &ctx, &set, negated_constraints, words, ARRAY_LENGTH( words ) ) );
+	while( getopt_next( &ctx ) != -1 ) {}
+	ASSERT_EQ( 1, getopt_check_constraints( &ctx, violations, (int)ARRAY_LENGTH( violations ) ) );
+	ASSERT_EQ( &negated_constraints[0], violations[0].constraint );
+	ASSERT_EQ( &alias_option_list[0],   violations[0].opt );
+	return 0;
+}
+
+static const getopt_option_t path_option_list[] =
+{
+	{ "input",  'i', GETOPT_OPTION_TYPE_REQUIRED_PATH_FILE,     0x0, 'i', "input file",   "FILE", 0x0, 0 },
+	{ "dir",    'd', GETOPT_OPTION_TYPE_REQUIRED_PATH_DIR,      0x0, 'd', "work dir",     "DIR",  0x0, 0 },
+	{ "config", 'c', GETOPT_OPTION_TYPE_REQUIRED_PATH_READABLE, 0x0, 'c', "config file",  "FILE", 0x0, 0 },
+	{ "any",    'a', GETOPT_OPTION_TYPE_REQUIRED_PATH_EXISTS,   0x0, 'a', "any path",     "PATH", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+TEST paths()
+{
+	const char* file = "getopt_path_test.txt";
+	FILE* f = fopen( file, "wb" );
+	ASSERT( f != 0x0 );
+	fclose( f );
+
+	// ... without a batch paths are checked when found ...
+	const char* argv[] = { "dummy_prog", "--input", file, "-d", ".", "--input=.", "--any=does_not_exist" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, path_option_list ) );
+	ASSERT_EQ( 'i', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( file, ctx.current_opt_arg );
+	ASSERT_EQ( 'd', getopt_next( &ctx ) );
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "input", ctx.current_opt_arg );
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... with a batch all failures are reported together after the parse, enough paths to be checked on threads ...
+	const char* many_argv[64] = { "dummy_prog", "--dir", file, "-c", file, "--any=does_not_exist" };
+	int many_argc = 6;
+	for( ; many_argc < (int)ARRAY_LENGTH( many_argv ); ++many_argc )
+		many_argv[many_argc] = ( many_argc % 16 ) == 0 ? "does_not_exist" : file;
+
+	getopt_path_t paths[ARRAY_LENGTH( many_argv )];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, many_argc, many_argv, path_option_list ) );
+	ASSERT_EQ( -1, getopt_check_paths( &ctx, 0x0, 0 ) );
+	ASSERT_EQ( 0, getopt_create_path_batch( &ctx, paths, (int)ARRAY_LENGTH( paths ) ) );
+
+	int res;
+	while( ( res = getopt_next( &ctx ) ) != -1 )
+	{
+		if( res == '+' )
+			ASSERT_EQ( 0, getopt_add_path( &ctx, ctx.current_opt_arg, GETOPT_PATH_CHECK_FILE ) );
+		else
+			ASSERT( res == 'd' || res == 'c' || res == 'a' );
+	}
+
+	const getopt_path_t* failed[8];
+	ASSERT_EQ( 5, getopt_check_paths( &ctx, failed, (int)ARRAY_LENGTH( failed ) ) );
+	ASSERT_EQ( &path_option_list[1], failed[0]->opt );
+	ASSERT_EQ( (unsigned int)GETOPT_PATH_CHECK_DIR, failed[0]->failed );
+	ASSERT_EQ( 0, failed[0]->error );
+	ASSERT_EQ( &path_option_list[3], failed[1]->opt );
+	ASSERT_EQ( (unsigned int)GETOPT_PATH_CHECK_EXISTS, failed[1]->failed );
+	ASSERT_EQ( ENOENT, failed[1]->error );
+	ASSERT_EQ( (const getopt_option_t*)0x0, failed[2]->opt );
+	ASSERT_STR_EQ( "does_not_exist", failed[2]->path );
+	ASSERT_EQ( 0u, paths[1].failed );
+
+	// ... a full batch is reported ...
+	ASSERT_EQ( 0, getopt_create_context( &ctx, many_argc, many_argv, path_option_list ) );
+	ASSERT_EQ( 0, getopt_create_path_batch( &ctx, paths, 2 ) );
+	while( getopt_next( &ctx ) != -1 ) {}
+	ASSERT_EQ( -1, getopt_check_paths( &ctx, failed, (int)ARRAY_LENGTH( failed ) ) );
+
+	remove( file );
+	return 0;
+}
+
+static const getopt_option_t blob_option_list[] =
+{
+	{ "key",  'k', GETOPT_OPTION_TYPE_REQUIRED_HEX,    0x0, 'k', "key as hex",     "HEX",    0x0, 0 },
+	{ "data", 'd', GETOPT_OPTION_TYPE_REQUIRED_BASE64, 0x0, 'd', "data as base64", "BASE64", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static int check_blob( const getopt_option_t* opt, const char* str, int expected_res, size_t expected_result, const char* expected_bytes )
+{
+	unsigned char out[64];
+	size_t result = 0;
+	ASSERT_EQ( expected_res, getopt_decode_blob( opt, str, out, sizeof( out ), &result ) );
+	ASSERT_EQ( expected_result, result );
+	if( expected_res == 0 )
+		ASSERT_EQ( 0, memcmp( expected_bytes, out, result ) );
+	return 0;
+}
+
+TEST blob_values()
+{
+	const getopt_option_t* hex = &blob_option_list[0];
+	const getopt_option_t* b64 = &blob_option_list[1];
+
+	ASSERT_EQ( 0, check_blob( hex, "",       0, 0, "" ) );
+	ASSERT_EQ( 0, check_blob( hex, "00fF10", 0, 3, "\x00\xff\x10" ) );
+	ASSERT_EQ( 0, check_blob( hex, "00fg10", -1, 3, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( hex, "00f",    -1, 3, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( hex, "00x",    -1, 2, 0x0 ) );
+
+	// ... long enough for the wide decoder, with invalid chars in and after the first block ...
+	ASSERT_EQ( 0, check_blob( hex, "000102030405060708090a0B0c0D0e0F10111213", 0, 20, "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13" ) );
+	ASSERT_EQ( 0, check_blob( hex, "0001020304050:0708090a0b0c0d0e0f", -1, 13, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( hex, "000102030405060708090a0b0c0d0e0f\xe4", -1, 32, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( hex, "000102030405060708090a0b0c0d0e0G", -1, 31, 0x0 ) );
+
+	ASSERT_EQ( 0, check_blob( b64, "",             0, 0, "" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYmFy",     0, 6, "foobar" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYg==",     0, 4, "foob" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYg",       0, 4, "foob" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYmE=",     0, 5, "fooba" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYmE",      0, 5, "fooba" ) );
+	ASSERT_EQ( 0, check_blob( b64, "+/+/",         0, 3, "\xfb\xff\xbf" ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9v-mFy",     -1, 4, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vY",        -1, 5, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm9vYg=",      -1, 6, 0x0 ) );
+	ASSERT_EQ( 0, check_blob( b64, "Zm=vYmFy",     -1, 2, 0x0 ) );
+
+	// ... to small output-buffer is reported with the needed size ...
+	unsigned char small[2];
+	size_t result = 0;
+	ASSERT_EQ( -2, getopt_decode_blob( b64, "Zm9vYmFy", small, sizeof( small ), &result ) );
+	ASSERT_EQ( 6u, result );
+	ASSERT_EQ( -1, getopt_decode_blob( &path_option_list[0], "00", small, sizeof( small ), &result ) );
+
+	// ... getopt_next() decode into the blob-buffer as long as there is room ...
+	const char* argv[] = { "dummy_prog", "--key", "cafe", "-d", "Zm9vYmFy", "--key=0123456789", "--data=Zm9v!mFy", "-k", "abc" };
+	unsigned char buffer[10];
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, blob_option_list ) );
+	getopt_set_blob_buffer( &ctx, buffer, sizeof( buffer ) );
+
+	ASSERT_EQ( 'k', getopt_next( &ctx ) );
+	ASSERT_EQ( 2u, ctx.current_value.u64 );
+	ASSERT_EQ( (const unsigned char*)buffer, ctx.current_blob );
+	ASSERT_EQ( 0, memcmp( "\xca\xfe", ctx.current_blob, 2 ) );
+
+	ASSERT_EQ( 'd', getopt_next( &ctx ) );
+	ASSERT_EQ( 6u, ctx.current_value.u64 );
+	ASSERT_EQ( (const unsigned char*)buffer + 2, ctx.current_blob );
+	ASSERT_EQ( 0, memcmp( "foobar", ctx.current_blob, 6 ) );
+
+	ASSERT_EQ( 'k', getopt_next( &ctx ) );
+	ASSERT_EQ( 5u, ctx.current_value.u64 );
+	ASSERT_EQ( (const unsigned char*)0x0, ctx.current_blob );
+	ASSERT_STR_EQ( "0123456789", ctx.current_opt_arg );
+
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_EQ( 4u, ctx.current_value.u64 );
+	ASSERT_STR_EQ( "data", ctx.current_opt_arg );
+
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_EQ( 3u, ctx.current_value.u64 );
+	ASSERT_STR_EQ( "key", ctx.current_opt_arg );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	getopt_typed_value_t value;
+	ASSERT_EQ( 0, getopt_convert_value( b64, "Zm9vYg", &value ) );
+	ASSERT_EQ( 4u, value.u64 );
+	ASSERT_EQ( -1, getopt_convert_value( hex, "0", &value ) );
+	return 0;
+}
+
+#if !defined(GETOPT_NO_GLOB)
+static int next_arg( getopt_context_t* ctx, int expected_res, const char* expected_arg )
+{
+	ASSERT_EQ( expected_res, getopt_next( ctx ) );
+	ASSERT_STR_EQ( expected_arg, ctx->current_opt_arg );
+	return 0;
+}
+
+TEST glob_expansion()
+{
+	const char* dirs[]  = { "glob_test", "glob_test/sub", "glob_test/sub/deep", "glob_test/.hidden" };
+	const char* files[] = { "glob_test/b.h", "glob_test/a.c", "glob_test/sub/c.c", "glob_test/sub/deep/d.c", "glob_test/.hidden/e.c" };
+	for( size_t i = 0; i < ARRAY_LENGTH( dirs ); ++i )
+		mkdir( dirs[i], 0755 );
+	for( size_t i = 0; i < ARRAY_LENGTH( files ); ++i )
+	{
+		FILE* f = fopen( files[i], "wb" );
+		ASSERT( f != 0x0 );
+		fclose( f );
+	}
+
+	const char* argv[] = { "dummy_prog", "glob_test/**/*.c", "-a", "glob_test/s[t-v]b", "glob_test/*.zz", "glob_test/*" };
+	getopt_context_t ctx;
+	getopt_glob_t glob;
+	char buffer[256];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	ASSERT_EQ( 0, getopt_create_glob( &ctx, &glob, buffer, sizeof( buffer ) ) );
+
+	// ... entries of each directory in order, a directory before what is in it ...
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/a.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub/c.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub/deep/d.c" ) );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub" ) );
+
+	// ... no matches, the pattern is returned as is ...
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/*.zz" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/a.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/b.h" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub" ) );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... "**" do not walk into hidden directories, the large one would not fit in the buffer ...
+	char large_name[256];
+	memset( large_name, 'x', sizeof( large_name ) );
+	memcpy( large_name, "glob_test/.hidden/", 18 );
+	large_name[220] = '\0';
+	FILE* large = fopen( large_name, "wb" );
+	ASSERT( large != 0x0 );
+	fclose( large );
+
+	const char* hidden_argv[] = { "dummy_prog", "glob_test/**/*.c", "glob_test/**/.hidden/*.c" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( hidden_argv ), hidden_argv, option_list ) );
+	ASSERT_EQ( 0, getopt_create_glob( &ctx, &glob, buffer, sizeof( buffer ) ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/a.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub/c.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/sub/deep/d.c" ) );
+
+	// ... unless the pattern names it ...
+	remove( large_name );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/.hidden/e.c" ) );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... a directory that do not fit in the buffer is an error ...
+	const char* small_argv[] = { "dummy_prog", "glob_test/*" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( small_argv ), small_argv, option_list ) );
+	ASSERT_EQ( -1, getopt_create_glob( &ctx, &glob, buffer, 4 ) );
+	ASSERT_EQ( 0, getopt_create_glob( &ctx, &glob, buffer, 32 ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '!', "glob_test/*" ) );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... with GETOPT_FLAG_STRICT_TEXT paths are checked as other non-options ...
+	const char* bad_name = "glob_test/\xff.c";
+	FILE* bad = fopen( bad_name, "wb" );
+	ASSERT( bad != 0x0 );
+	fclose( bad );
+
+	const char* strict_argv[] = { "dummy_prog", "glob_test/*.c" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( strict_argv ), strict_argv, option_list ) );
+	ASSERT_EQ( 0, getopt_create_glob( &ctx, &glob, buffer, sizeof( buffer ) ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_STRICT_TEXT );
+	ASSERT_EQ( 0, next_arg( &ctx, '+', "glob_test/a.c" ) );
+	ASSERT_EQ( 0, next_arg( &ctx, '!', bad_name ) );
+	ASSERT_EQ( 10u, ctx.current_value.u64 );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+	remove( bad_name );
+
+	for( size_t i = ARRAY_LENGTH( files ); i > 0; --i )
+		remove( files[i - 1] );
+	for( size_t i = ARRAY_LENGTH( dirs ); i > 0; --i )
+		remove( dirs[i - 1] );
+	return 0;
+}
+#endif
+
+static const getopt_option_t pattern_option_list[] =
+{
+	{ "host",    'h', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'h', "host name",   "[a-z0-9]([a-z0-9-]*[a-z0-9])?(\\.[a-z0-9]([a-z0-9-]*[a-z0-9])?)*", 0x0, 0 },
+	{ "define",  'D', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'D', "key=value",   "[A-Za-z_]\\w*=[^,]*",                                           0x0, 0 },
+	{ "version", 'v', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'v', "version",     "\\d+\\.\\d+(\\.\\d+)?(-(alpha|beta|rc)\\d*)?",               0x0, 0 },
+	{ "empty",   'e', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'e', "maybe empty", "(ab)*",                                                          0x0, 0 },
+	{ "blowup",  'b', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'b', "many states", "(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)",               0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static int check_pattern( int use_dfa, const char* name, const char* arg, int expected_res, unsigned long long expected_offset )
+{
+	const char* argv[] = { "dummy_prog", name, arg };
+	getopt_context_t ctx;
+	getopt_pattern_t patterns[ARRAY_LENGTH( pattern_option_list ) - 1];
+	unsigned short table[1024];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, pattern_option_list ) );
+	if( use_dfa )
+		ASSERT( getopt_create_patterns( &ctx, patterns, (int)ARRAY_LENGTH( patterns ), table, ARRAY_LENGTH( table ) ) > 0 );
+
+	ASSERT_EQ( expected_res, getopt_next( &ctx ) );
+	if( expected_res == '!' )
+		ASSERT_EQ( expected_offset, ctx.current_value.u64 );
+
+	// ... getopt_convert_value() always match by simulation ...
+	getopt_typed_value_t value;
+	ASSERT_EQ( expected_res == '!' ? -1 : 0, getopt_convert_value( ctx.current_opt, arg, &value ) );
+	return 0;
+}
+
+static int check_patterns( int use_dfa )
+{
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "example.com",           'h', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "a",                     'h', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "my-host.internal",      'h', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "_bad.com",              '!', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "bad-.com",              '!', 4 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "example.com.",          '!', 12 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--host",    "",                      '!', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--define",  "KEY_1=some value",      'D', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--define",  "KEY=",                  'D', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--define",  "1KEY=x",                '!', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--define",  "KEY=a,b",               '!', 5 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--version", "1.2",                   'v', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--version", "10.20.3-rc1",           'v', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--version", "1.2.3-beta",            'v', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--version", "1.2.3-gamma",           '!', 6 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--version", "1.",                    '!', 2 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--empty",   "",                      'e', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--empty",   "abab",                  'e', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--empty",   "aba",                   '!', 3 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--blowup",  "bbbabbbbbbbb",          'b', 0 ) );
+	ASSERT_EQ( 0, check_pattern( use_dfa, "--blowup",  "bbbbbbbbbbbb",          '!', 12 ) );
+	return 0;
+}
+
+TEST patterns()
+{
+	static const char* invalid[] = { "", "(ab", "ab)", "*a", "a**b|+", "[]", "[z-a]", "[abc", "a\\", "a{2}",
+	                                 "((((((((((((((((((a))))))))))))))))))",
+	                                 "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" };
+	const char* argv[] = { "dummy_prog" };
+	getopt_context_t ctx;
+	for( size_t i = 0; i < ARRAY_LENGTH( invalid ); ++i )
+	{
+		getopt_option_t opts[] = { { "p", 'p', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'p', "pattern", invalid[i], 0x0, 0 }, GETOPT_OPTIONS_END };
+		ASSERT_EQ( i == 0 ? 0 : -1, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, opts ) );
+	}
+
+	// ... by simulation and with DFAs ...
+	ASSERT_EQ( 0, check_patterns( 0 ) );
+	ASSERT_EQ( 0, check_patterns( 1 ) );
+
+	// ... the table can be sized before it is created, a pattern with to many states is still simulated ...
+	getopt_pattern_t patterns[ARRAY_LENGTH( pattern_option_list ) - 1];
+	unsigned short table[1024];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, pattern_option_list ) );
+	int size = getopt_create_patterns( &ctx, patterns, (int)ARRAY_LENGTH( patterns ), 0x0, 0 );
+	ASSERT( size > 0 && size <= (int)ARRAY_LENGTH( table ) );
+	ASSERT_EQ( (const getopt_pattern_t*)0x0, ctx.patterns );
+	ASSERT_EQ( -1, getopt_create_patterns( &ctx, patterns, 2, table, ARRAY_LENGTH( table ) ) );
+	ASSERT_EQ( -1, getopt_create_patterns( &ctx, patterns, (int)ARRAY_LENGTH( patterns ), table, (size_t)size - 1 ) );
+	ASSERT_EQ( size, getopt_create_patterns( &ctx, patterns, (int)ARRAY_LENGTH( patterns ), table, ARRAY_LENGTH( table ) ) );
+	ASSERT_EQ( (const getopt_option_t*)&pattern_option_list[4], patterns[4].opt );
+	ASSERT_EQ( (const unsigned short*)0x0, patterns[4].next );
+	ASSERT( patterns[0].next != 0x0 );
+	ASSERT_EQ( (const getopt_pattern_t*)patterns, ctx.patterns );
+	return 0;
+}
+
+static int check_utf8( const char* str, int expected_res, size_t expected_offset )
+{
+	size_t offset = 0;
+	ASSERT_EQ( expected_res, getopt_validate_utf8( str, strlen( str ), &offset ) );
+	if( expected_res < 0 )
+		ASSERT_EQ( expected_offset, offset );
+	return 0;
+}
+
+// composes "e" + U+0301 to U+00E9, enough of NFC to test with
+static size_t compose_e_acute( const char* str, size_t len, char* out, size_t out_size, void* userdata )
+{
+	int* calls = (int*)userdata;
+	++*calls;
+
+	size_t out_len = 0;
+	for( size_t i = 0; i < len; ++i )
+	{
+		int compose = str[i] == 'e' && len - i >= 3 && memcmp( str + i + 1, "\xcc\x81", 2 ) == 0;
+		if( out_len + 2 <= out_size )
+		{
+			if( compose )
+				memcpy( out + out_len, "\xc3\xa9", 2 );
+			else
+				out[out_len] = str[i];
+		}
+		out_len += compose ? 2 : 1;
+		i       += compose ? 2 : 0;
+	}
+	return out_len;
+}
+
+TEST strict_text()
+{
+	ASSERT_EQ( 0, check_utf8( "",                                       0, 0 ) );
+	ASSERT_EQ( 0, check_utf8( "plain ascii that is longer than a block", 0, 0 ) );
+	ASSERT_EQ( 0, check_utf8( "r\xc3\xa4ksm\xc3\xb6rg\xc3\xa5s \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf", 0, 0 ) );
+	ASSERT_EQ( 0, check_utf8( "abc\x80",                    -1, 3 ) );  // lone continuation
+	ASSERT_EQ( 0, check_utf8( "ab\xc0\xaf",                -1, 2 ) );  // overlong '/'
+	ASSERT_EQ( 0, check_utf8( "\xe0\x9f\xbf",             -1, 0 ) );  // overlong
+	ASSERT_EQ( 0, check_utf8( "a\xed\xa0\x80",            -1, 1 ) );  // surrogate
+	ASSERT_EQ( 0, check_utf8( "\xf4\x90\x80\x80",        -1, 0 ) );  // above U+10FFFF
+	ASSERT_EQ( 0, check_utf8( "\xf5\x80\x80\x80",        -1, 0 ) );
+	ASSERT_EQ( 0, check_utf8( "\xe2\x82",                  -1, 0 ) );  // truncated
+	ASSERT_EQ( 0, check_utf8( "\xe2\x82\x41",             -1, 0 ) );
+	ASSERT_EQ( 0, check_utf8( "0123456789abcdef0123456789abcd\xc3\xa4\xff", -1, 32 ) );
+	ASSERT_EQ( 0, check_utf8( "0123456789abcdef0123456789abcdef\xc3", -1, 32 ) );
+
+	const char* argv[] = { "dummy_prog", "--cccc", "caf\xc3\xa9", "--cccc=cafe\xcc\x81", "--cccc=plain", "--cccc=\xff\xfe", "--unkn\xc3own", "--unknown", "--cccc=bad\xe2\x82", "fil\xc3\xa9", "ok\xff\xfe" };
+	getopt_context_t ctx;
+
+	// ... without the flag bytes are passed through as is ...
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	while( getopt_next( &ctx ) != -1 )
+		ASSERT( ctx.current_opt_arg != 0x0 );
+
+	int calls = 0;
+	char buffer[8];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_STRICT_TEXT );
+	getopt_set_normalizer( &ctx, compose_e_acute, &calls, buffer, sizeof( buffer ) );
+
+	// ... already normalized values are not copied ...
+	ASSERT_EQ( 'c', getopt_next( &ctx ) );
+	ASSERT_EQ( argv[2], ctx.current_opt_arg );
+	ASSERT_EQ( 1, calls );
+
+	ASSERT_EQ( 'c', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "caf\xc3\xa9", ctx.current_opt_arg );
+	ASSERT_EQ( (const char*)buffer, ctx.current_opt_arg );
+
+	// ... ascii never reach the normalizer ...
+	ASSERT_EQ( 'c', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "plain", ctx.current_opt_arg );
+	ASSERT_EQ( 2, calls );
+
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "cccc", ctx.current_opt_arg );
+	ASSERT_EQ( 0u, ctx.current_value.u64 );
+
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_STR_EQ( "--unkn\xc3own", ctx.current_opt_arg );
+	ASSERT_EQ( 6u, ctx.current_value.u64 );
+	ASSERT_EQ( (const getopt_option_t*)0x0, ctx.current_opt );
+
+	ASSERT_EQ( '?', getopt_next( &ctx ) );
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_EQ( 3u, ctx.current_value.u64 );
+
+	// ... non-options are forwarded as they are, only checked ...
+	ASSERT_EQ( '+', getopt_next( &ctx ) );
+	ASSERT_EQ( argv[9], ctx.current_opt_arg );
+	ASSERT_EQ( '!', getopt_next( &ctx ) );
+	ASSERT_EQ( argv[10], ctx.current_opt_arg );
+	ASSERT_EQ( 2u, ctx.current_value.u64 );
+	ASSERT_EQ( 2, calls );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	// ... a full buffer stops the parse ...
+	const char* full_argv[] = { "dummy_prog", "--cccc", "e\xcc\x81" "e\xcc\x81" "e\xcc\x81" "e\xcc\x81", "--cccc=x" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( full_argv ), full_argv, option_list ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_STRICT_TEXT );
+	getopt_set_normalizer( &ctx, compose_e_acute, &calls, buffer, sizeof( buffer ) );
+	ASSERT_EQ( '#', getopt_next( &ctx ) );
+	ASSERT_EQ( full_argv[2], ctx.current_opt_arg );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+	return 0;
+}
+
+#if defined(GETOPT_TEST_CPP17)
+enum class cpp_opt : int { verbose = 'v', threads = 't', ratio = 'r', name = 'n' };
+
+static const getopt_option_t cpp_option_list[] =
+{
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_NO_ARG,   0x0, getopt_cpp::option_value( cpp_opt::verbose ), "verbose", 0x0, 0x0, 0 },
+	{ "threads", 't', GETOPT_OPTION_TYPE_REQUIRED, 0x0, getopt_cpp::option_value( cpp_opt::threads ), "threads", "N", 0x0, 0 },
+	{ "ratio",   'r', GETOPT_OPTION_TYPE_REQUIRED, 0x0, getopt_cpp::option_value( cpp_opt::ratio ),   "ratio",   "R", 0x0, 0 },
+	{ "name",    'n', GETOPT_OPTION_TYPE_OPTIONAL, 0x0, getopt_cpp::option_value( cpp_opt::name ),    "name",    "S", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+TEST cpp_layer()
+{
+	static_assert( !std::is_copy_constructible_v<getopt_cpp::context>, "contexts are move-only" );
+	static_assert( std::is_nothrow_move_constructible_v<getopt_cpp::context>, "contexts are move-only" );
+
+	const getopt_option_t bad_list[] = { { "bad", 'b', GETOPT_OPTION_TYPE_NO_ARG, 0x0, '!', "bad", 0x0, 0x0, 0 }, GETOPT_OPTIONS_END };
+	const char* argv[] = { "dummy_prog", "-v", "--threads=8", "-r", "0.5", "--threads=8x", "file", "--name", "--unknown", "--ratio" };
+	ASSERT( !getopt_cpp::context::create( (int)ARRAY_LENGTH( argv ), argv, bad_list ) );
+
+	auto created = getopt_cpp::basic_context<cpp_opt>::create( (int)ARRAY_LENGTH( argv ), argv, cpp_option_list );
+	ASSERT( created.has_value() );
+	getopt_cpp::basic_context<cpp_opt> ctx = std::move( *created );
+
+	// ... the events are the same as from the getopt_next()-loop ...
+	getopt_context_t c_ctx;
+	ASSERT_EQ( 0, getopt_create_context( &c_ctx, (int)ARRAY_LENGTH( argv ), argv, cpp_option_list ) );
+
+	int num_events = 0;
+	for( auto ev : ctx )
+	{
+		ASSERT_EQ( getopt_next( &c_ctx ), ev.raw() );
+		ASSERT_EQ( c_ctx.current_opt_arg, ev.c_str() );
+		switch( num_events++ )
+		{
+			case 0:
+				ASSERT( ev.kind() == getopt_cpp::event_kind::option && ev.id() == cpp_opt::verbose );
+				ASSERT( !ev.has_arg() );
+				ASSERT( ev.arg().empty() );
+				break;
+			case 1:
+				ASSERT( ev.id() == cpp_opt::threads );
+				ASSERT( ev.arg() == "8" );
+				ASSERT_EQ( 8, ev.arg_as<int>().value_or( -1 ) );
+				ASSERT_EQ( 8u, ev.arg_as<unsigned char>().value_or( 0 ) );
+				break;
+			case 2:
+				ASSERT( ev.id() == cpp_opt::ratio );
+				ASSERT_EQ( 0.5, ev.arg_as<double>().value_or( -1.0 ) );
+				ASSERT( !ev.arg_as<int>().has_value() );
+				break;
+			case 3:
+				ASSERT( ev.id() == cpp_opt::threads );
+				ASSERT( !ev.arg_as<int>().has_value() );
+				break;
+			case 4:
+				ASSERT( ev.kind() == getopt_cpp::event_kind::non_option );
+				ASSERT( ev.arg() == "file" );
+				break;
+			case 5:
+				ASSERT( ev.id() == cpp_opt::name );
+				ASSERT( !ev.has_arg() );
+				ASSERT( !ev.arg_as<int>().has_value() );
+				break;
+			case 6:
+				ASSERT( ev.kind() == getopt_cpp::event_kind::unknown );
+				ASSERT( ev.arg() == "--unknown" );
+				break;
+			case 7:
+				ASSERT( ev.kind() == getopt_cpp::event_kind::invalid );
+				ASSERT( ev.arg() == "ratio" );
+				ASSERT_EQ( &cpp_option_list[2], ev.option() );
+				break;
+		}
+	}
+	ASSERT_EQ( 8, num_events );
+	ASSERT_EQ( -1, getopt_next( &c_ctx ) );
+	ASSERT_EQ( -1, ctx.next().raw() );
+
+	char buffer[1024];
+	ASSERT( ctx.help( buffer, sizeof( buffer ) ).find( "--threads=<N>" ) != std::string_view::npos );
+	return 0;
+}
+#endif
+
+TEST suggestions()
+{
+	static const getopt_option_t suggest_option_list[] =
+	{
+		{ "verbose",  'v', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'v', "help verbose",  0, 0x0, 0 },
+		{ "version",  'V', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'V', "help version",  0, 0x0, 0 },
+		{ "input",    'i', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'i', "help input",    "FILE", 0x0, 0 },
+		{ 0x0,        'x', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'x', "help x",        0, 0x0, 0 },
+		{ "output",   'o', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 'o', "help output",   "FILE", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	const char* argv[] = { "dummy_prog" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, suggest_option_list ) );
+
+	const getopt_option_t* found[4];
+
+	ASSERT_EQ( 1, getopt_suggest( &ctx, "--verbse", 1, found, 4 ) );
+	ASSERT_STR_EQ( "verbose", found[0]->name );
+
+	// ... closest first ...
+	ASSERT_EQ( 2, getopt_suggest( &ctx, "--VERSOIN", 3, found, 4 ) );
+	ASSERT_STR_EQ( "version", found[0]->name );
+	ASSERT_STR_EQ( "verbose", found[1]->name );
+
+	// ... list full, only the closest are kept ...
+	ASSERT_EQ( 1, getopt_suggest( &ctx, "--VERSOIN", 3, found, 1 ) );
+	ASSERT_STR_EQ( "version", found[0]->name );
+
+	ASSERT_EQ( 1, getopt_suggest( &ctx, "--inptu=file", 2, found, 4 ) );
+	ASSERT_STR_EQ( "input", found[0]->name );
+
+	ASSERT_EQ( 1, getopt_suggest( &ctx, "-outptu", 2, found, 4 ) );
+	ASSERT_STR_EQ( "output", found[0]->name );
+
+	ASSERT_EQ( 0, getopt_suggest( &ctx, "--zzzzzz", 2, found, 4 ) );
+	ASSERT_EQ( 0, getopt_suggest( &ctx, "--", 2, found, 4 ) );
+	return 0;
+}
+
+TEST completion()
+{
+	char buffer[1024];
+	getopt_context_t ctx;
+
+	const char* not_query[] = { "dummy_prog", "--verbose" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( not_query ), not_query, abbrev_option_list ) );
+	ASSERT_EQ( -1, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+
+	const char* long_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "file", "--ver" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( long_query ), long_query, abbrev_option_list ) );
+	ASSERT_EQ( 2, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "--verbose\n--version\n", buffer );
+	ASSERT_EQ( -1, getopt_next( &ctx ) ); // ... query is consumed ...
+
+	// ... with an index ...
+	getopt_index_entry_t index[ARRAY_LENGTH( abbrev_option_list )];
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( long_query ), long_query, abbrev_option_list ) );
+	ASSERT_EQ( 0, getopt_create_index( &ctx, index, (int)ARRAY_LENGTH( index ) ) );
+	ASSERT_EQ( 2, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "--verbose\n--version\n", buffer );
+
+	// ... to small buffer only get the completions that fit ...
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( long_query ), long_query, abbrev_option_list ) );
+	ASSERT_EQ( 1, getopt_complete( &ctx, buffer, 15 ) );
+	ASSERT_STR_EQ( "--verbose\n", buffer );
+
+	const char* dash_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=0", "-" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( dash_query ), dash_query, option_list ) );
+	ASSERT_EQ( 16, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+
+	// ... values and positionals should be completed by the shell ...
+	const char* value_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=2", "--input", "=", "fi" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( value_query ), value_query, abbrev_option_list ) );
+	ASSERT_EQ( 0, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "", buffer );
+
+	const char* new_word_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "--input" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( new_word_query ), new_word_query, abbrev_option_list ) );
+	ASSERT_EQ( 0, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	return 0;
+}
+
+TEST completion_of_values()
+{
+	static const getopt_option_t choice_option_list[] =
+	{
+		{ "mode",     'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM,    0x0, 'm', "help mode",     "fast|balanced|safe", 0x0, 0 },
+		{ "features", 'f', GETOPT_OPTION_TYPE_REQUIRED_BITMASK, 0x0, 'f', "help features", "simd|mmap|async", 0x0, 0 },
+		{ "input",    'i', GETOPT_OPTION_TYPE_REQUIRED,         0x0, 'i', "help input",    "FILE", 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	char buffer[1024];
+	getopt_context_t ctx;
+
+	// ... as bash split --mode=fa ...
+	const char* split_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=2", "--mode", "=", "fa" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( split_query ), split_query, choice_option_list ) );
+	ASSERT_EQ( 1, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "fast\n", buffer );
+
+	// ... cursor right after the '=' ...
+	const char* eq_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "--mode", "=" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( eq_query ), eq_query, choice_option_list ) );
+	ASSERT_EQ( 3, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "=fast\n=balanced\n=safe\n", buffer );
+
+	// ... unsplit as from zsh ...
+	const char* joined_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=0", "--mode=s" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( joined_query ), joined_query, choice_option_list ) );
+	ASSERT_EQ( 1, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "--mode=safe\n", buffer );
+
+	// ... value as separate token ...
+	const char* token_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "-m", "b" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( token_query ), token_query, choice_option_list ) );
+	ASSERT_EQ( 1, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "balanced\n", buffer );
+
+	const char* empty_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "--features" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( empty_query ), empty_query, choice_option_list ) );
+	ASSERT_EQ( 3, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "simd\nmmap\nasync\n", buffer );
+
+	// ... only the last name in a bitmask is completed ...
+	const char* bitmask_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=0", "--features=simd,m" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( bitmask_query ), bitmask_query, choice_option_list ) );
+	ASSERT_EQ( 1, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "--features=simd,mmap\n", buffer );
+
+	// ... names are case-sensitive ...
+	const char* case_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=1", "--mode", "F" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( case_query ), case_query, choice_option_list ) );
+	ASSERT_EQ( 0, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+
+	// ... other values are still left to the shell ...
+	const char* file_query[] = { "dummy_prog", GETOPT_COMPLETE_ARG "=0", "--input=fi" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( file_query ), file_query, choice_option_list ) );
+	ASSERT_EQ( 0, getopt_complete( &ctx, buffer, sizeof( buffer ) ) );
+	ASSERT_STR_EQ( "", buffer );
+	return 0;
+}
+
+TEST completion_script()
+{
+	char buffer[2048];
+	const char* argv[] = { "dummy_prog" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, abbrev_option_list ) );
+
+	getopt_create_completion_script( &ctx, GETOPT_SHELL_BASH, "my-prog", buffer, sizeof( buffer ) );
+	ASSERT( strstr( buffer, "complete -o default -F _my_prog_getopt_complete my-prog\n" ) != 0x0 );
+
+	getopt_create_completion_script( &ctx, GETOPT_SHELL_ZSH, "my-prog", buffer, sizeof( buffer ) );
+	ASSERT( strstr( buffer, "#compdef my-prog\n" ) != 0x0 );
+
+	getopt_create_completion_script( &ctx, GETOPT_SHELL_FISH, "my-prog", buffer, sizeof( buffer ) );
+	ASSERT( strstr( buffer, "complete -c my-prog -s i -l input -r -d 'help input'\n" ) != 0x0 );
+	ASSERT( strstr( buffer, "complete -c my-prog -s v -l verbose -d 'help verbose'\n" ) != 0x0 );
+	return 0;
+}
+
+TEST subcommands()
+{
+	static const getopt_option_t build_option_list[] =
+	{
+		{ "target", 't', GETOPT_OPTION_TYPE_REQUIRED, 0x0, 't', "help target", "TARGET", 0x0, 0 },
+		{ "fast",   'f', GETOPT_OPTION_TYPE_NO_ARG,   0x0, 'f', "help fast",   0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	// ... invalid option-list, should only be found when deploy is used ...
+	static const getopt_option_t deploy_option_list[] =
+	{
+		{ "--bad", 0, GETOPT_OPTION_TYPE_NO_ARG, 0x0, 'a', "help bad", 0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	static const getopt_subcommand_t subcommand_list[] =
+	{
+		{ "build",  build_option_list,  1, "build stuff" },
+		{ "deploy", deploy_option_list, 2, "deploy stuff" },
+		GETOPT_SUBCOMMANDS_END
+	};
+
+	const char* argv[] = { "dummy_prog", "-a", "build", "--target=x", "-a", "file", "-f" };
+	getopt_context_t ctx;
+	getopt_context_t sub_ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( '+', getopt_next( &ctx ) );
+	ASSERT_EQ( (const getopt_subcommand_t*)0x0, getopt_find_subcommand( subcommand_list, "buil" ) );
+	const getopt_subcommand_t* sub = getopt_find_subcommand( subcommand_list, ctx.current_opt_arg );
+	ASSERT_EQ( &subcommand_list[0], sub );
+	ASSERT_EQ( 0, getopt_create_subcommand_context( &ctx, &sub_ctx, sub ) );
+	ASSERT_EQ( -1, getopt_next( &ctx ) );
+
+	ASSERT_EQ( 't', getopt_next( &sub_ctx ) ); ASSERT_STR_EQ( "x", sub_ctx.current_opt_arg );
+	ASSERT_EQ( '?', getopt_next( &sub_ctx ) ); ASSERT_STR_EQ( "-a", sub_ctx.current_opt_arg );
+	ASSERT_EQ( '+', getopt_next( &sub_ctx ) ); ASSERT_STR_EQ( "file", sub_ctx.current_opt_arg );
+	ASSERT_EQ( 'f', getopt_next( &sub_ctx ) );
+	ASSERT_EQ( -1,  getopt_next( &sub_ctx ) );
+
+	// ... limits are for the whole command line, the subcommand continues where the parent stopped ...
+	getopt_limits_t limits;
+	memset( &limits, 0x0, sizeof( limits ) );
+	limits.max_tokens      = 4;
+	limits.max_total_bytes = 1000;
+	limits.max_ops         = 1000;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	getopt_set_limits( &ctx, &limits );
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	ASSERT_EQ( '+', getopt_next( &ctx ) );
+	ASSERT_EQ( 0, getopt_create_subcommand_context( &ctx, &sub_ctx, sub ) );
+	ASSERT_EQ( ctx.used_bytes, sub_ctx.used_bytes );
+	ASSERT_EQ( ctx.used_ops,   sub_ctx.used_ops );
+	ASSERT_EQ( 't', getopt_next( &sub_ctx ) );
+	ASSERT_EQ( '?', getopt_next( &sub_ctx ) );
+	ASSERT_EQ( '#', getopt_next( &sub_ctx ) ); ASSERT_STR_EQ( "file", sub_ctx.current_opt_arg );
+	ASSERT_EQ( -1,  getopt_next( &sub_ctx ) );
+
+	const char* argv_deploy[] = { "dummy_prog", "deploy" };
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv_deploy ), argv_deploy, option_list ) );
+	ASSERT_EQ( '+', getopt_next( &ctx ) );
+	ASSERT_EQ( -1, getopt_create_subcommand_context( &ctx, &sub_ctx, getopt_find_subcommand( subcommand_list, ctx.current_opt_arg ) ) );
+	return 0;
+}
+
+static int check_queries( getopt_context_t* ctx )
+{
+	const char* arg = 0x0;
+	ASSERT_EQ( 2, getopt_find( ctx, "--cccc", &arg ) );
+	ASSERT_STR_EQ( "c1", arg );
+	ASSERT_EQ( 6, getopt_last( ctx, "-c", &arg ) );
+	ASSERT_STR_EQ( "c2", arg );
+	ASSERT_EQ( 3, getopt_count( ctx, "-a" ) );
+	ASSERT_EQ( 1, getopt_find( ctx, "--aaaa", &arg ) );
+	ASSERT_EQ( (const char*)0x0, arg );
+	ASSERT_EQ( 0,  getopt_count( ctx, "--bbbb" ) );
+	ASSERT_EQ( -1, getopt_find( ctx, "--bbbb", 0x0 ) );
+	ASSERT_EQ( -1, getopt_find( ctx, "--not-an-option", 0x0 ) );
+	ASSERT_EQ( -1, getopt_find( ctx, "cccc", 0x0 ) );
+	ASSERT_EQ( 0,  getopt_count( ctx, "-" ) );
+	return 0;
+}
+
+static const getopt_option_t fingerprint_option_list[] =
+{
+	{ "output",  'o', GETOPT_OPTION_TYPE_REQUIRED,       0x0,      'o', "help output",  "FILE", 0x0, 0 },
+	{ "jobs",    'j', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0,      'j', "help jobs",    "N", 0x0, 0 },
+	{ "cache",   'c', GETOPT_OPTION_TYPE_REQUIRED_SIZE,  0x0,      'c', "help cache",   "SIZE", 0x0, 0 },
+	{ "verbose", 'v', GETOPT_OPTION_TYPE_NO_ARG,         0x0,      'v', "help verbose", 0, 0x0, 0 },
+	{ "fast",    'f', GETOPT_OPTION_TYPE_FLAG_SET,       &g_flag,   1,  "help fast",    0, 0x0, 0 },
+	{ "host",    'h', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0,    'h', "help host",    "[a-z]+", 0x0, 0 },
+	{ "colour",   0,  GETOPT_OPTION_TYPE_FLAG_SET,       &g_flag,   2,  "help colour",  0, 0x0, 1 },
+	{ "key",     'k', GETOPT_OPTION_TYPE_REQUIRED_HEX,   0x0,      'k', "help key",     "HEX", 0x0, 0 },
+	{ "data",    'd', GETOPT_OPTION_TYPE_REQUIRED_BASE64, 0x0,     'd', "help data",    "B64", 0x0, 0 },
+	{ "include", 'I', GETOPT_OPTION_TYPE_REQUIRED,       0x0,      'I', "help include", "DIR", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static getopt_fingerprint_t fingerprint_of( int argc, const char** argv )
+{
+	getopt_occurrence_t occurrences[ARRAY_LENGTH( fingerprint_option_list )];
+	getopt_context_t ctx;
+	getopt_fingerprint_t fp = { 0, 0 };
+	if( getopt_create_context( &ctx, argc, argv, fingerprint_option_list ) == 0 &&
+		getopt_create_query_index( &ctx, occurrences, (int)ARRAY_LENGTH( occurrences ) ) == 0 )
+		getopt_fingerprint( &ctx, "include", &fp );
+	return fp;
+}
+
+TEST fingerprint()
+{
+	const char* argv1[] = { "dummy_prog", "-o", "x", "--jobs=16", "-f", "a.c", "b.c", "-v", "--cache=1M" };
+	const char* argv2[] = { "dummy_prog", "--verbose", "--cache", "1000k", "a.c", "-j", "4", "--output=x", "--fast", "-f", "-j", "0x10", "b.c" };
+	const char* argv3[] = { "dummy_prog", "-o", "x", "--jobs=16", "-f", "b.c", "a.c", "-v", "--cache=1M" }; // ... positional order matters ...
+	const char* argv4[] = { "dummy_prog", "-o", "x", "--jobs=16", "-f", "a.c", "b.c", "-v", "-v", "--cache=1M" }; // ... -v count matters ...
+	const char* argv5[] = { "dummy_prog", "-o", "y", "--jobs=16", "-f", "a.c", "b.c", "-v", "--cache=1M" };
+
+	getopt_fingerprint_t fp1 = fingerprint_of( (int)ARRAY_LENGTH( argv1 ), argv1 );
+	getopt_fingerprint_t fp2 = fingerprint_of( (int)ARRAY_LENGTH( argv2 ), argv2 );
+	getopt_fingerprint_t fp3 = fingerprint_of( (int)ARRAY_LENGTH( argv3 ), argv3 );
+	getopt_fingerprint_t fp4 = fingerprint_of( (int)ARRAY_LENGTH( argv4 ), argv4 );
+	getopt_fingerprint_t fp5 = fingerprint_of( (int)ARRAY_LENGTH( argv5 ), argv5 );
+
+	ASSERT( fp1.lo != 0 || fp1.hi != 0 );
+	ASSERT( fp1.lo == fp2.lo && fp1.hi == fp2.hi );
+	ASSERT( fp1.lo != fp3.lo && fp1.hi != fp3.hi );
+	ASSERT( fp1.lo != fp4.lo && fp1.hi != fp4.hi );
+	ASSERT( fp1.lo != fp5.lo && fp1.hi != fp5.hi );
+
+	// ... the value of a pattern-option is the argument ...
+	const char* argv6[] = { "dummy_prog", "--host", "abc" };
+	const char* argv7[] = { "dummy_prog", "--host", "xyz" };
+	getopt_fingerprint_t fp6 = fingerprint_of( (int)ARRAY_LENGTH( argv6 ), argv6 );
+	getopt_fingerprint_t fp7 = fingerprint_of( (int)ARRAY_LENGTH( argv7 ), argv7 );
+	ASSERT( fp6.lo != fp7.lo && fp6.hi != fp7.hi );
+
+	// ... only the last value of a repeated option is used ...
+	const char* argv14[] = { "dummy_prog", "-o", "x", "a.c", "-o", "y" };
+	const char* argv15[] = { "dummy_prog", "a.c", "--output=y" };
+	const char* argv16[] = { "dummy_prog", "-o", "y", "a.c", "-o", "x" };
+	getopt_fingerprint_t fp14 = fingerprint_of( (int)ARRAY_LENGTH( argv14 ), argv14 );
+	getopt_fingerprint_t fp15 = fingerprint_of( (int)ARRAY_LENGTH( argv15 ), argv15 );
+	getopt_fingerprint_t fp16 = fingerprint_of( (int)ARRAY_LENGTH( argv16 ), argv16 );
+	ASSERT( fp14.lo == fp15.lo && fp14.hi == fp15.hi );
+	ASSERT( fp14.lo != fp16.lo && fp14.hi != fp16.hi );
+
+	// ... unless the option accumulates, then all values are used in order ...
+	const char* argv23[] = { "dummy_prog", "-I", "a", "-o", "x", "a.c", "-I", "b" };
+	const char* argv24[] = { "dummy_prog", "-I", "c", "-o", "x", "a.c", "-I", "b" };
+	const char* argv25[] = { "dummy_prog", "-I", "b", "-o", "x", "a.c", "-I", "a" };
+	const char* argv26[] = { "dummy_prog", "a.c", "-I", "b" };
+	const char* argv27[] = { "dummy_prog", "-o", "x", "--include=a", "a.c", "--include", "b" };
+	getopt_fingerprint_t fp23 = fingerprint_of( (int)ARRAY_LENGTH( argv23 ), argv23 );
+	getopt_fingerprint_t fp24 = fingerprint_of( (int)ARRAY_LENGTH( argv24 ), argv24 );
+	getopt_fingerprint_t fp25 = fingerprint_of( (int)ARRAY_LENGTH( argv25 ), argv25 );
+	getopt_fingerprint_t fp26 = fingerprint_of( (int)ARRAY_LENGTH( argv26 ), argv26 );
+	getopt_fingerprint_t fp27 = fingerprint_of( (int)ARRAY_LENGTH( argv27 ), argv27 );
+	ASSERT( fp23.lo != fp24.lo && fp23.hi != fp24.hi );
+	ASSERT( fp23.lo != fp25.lo && fp23.hi != fp25.hi );
+	ASSERT( fp23.lo != fp26.lo && fp23.hi != fp26.hi );
+	ASSERT( fp23.lo == fp27.lo && fp23.hi == fp27.hi );
+
+	// ... the last of "--<name>" and "--no-<name>" decides if a negatable flag is on or off ...
+	const char* argv18[] = { "dummy_prog", "--colour", "--no-colour" };
+	const char* argv19[] = { "dummy_prog", "--no-colour", "--colour" };
+	const char* argv20[] = { "dummy_prog", "--colour", "--no-colour", "--colour" };
+	const char* argv21[] = { "dummy_prog", "--no-colour" };
+	const char* argv22[] = { "dummy_prog" };
+	getopt_fingerprint_t fp18 = fingerprint_of( (int)ARRAY_LENGTH( argv18 ), argv18 );
+	getopt_fingerprint_t fp19 = fingerprint_of( (int)ARRAY_LENGTH( argv19 ), argv19 );
+	getopt_fingerprint_t fp20 = fingerprint_of( (int)ARRAY_LENGTH( argv20 ), argv20 );
+	getopt_fingerprint_t fp21 = fingerprint_of( (int)ARRAY_LENGTH( argv21 ), argv21 );
+	getopt_fingerprint_t fp22 = fingerprint_of( (int)ARRAY_LENGTH( argv22 ), argv22 );
+	ASSERT( fp18.lo != fp19.lo && fp18.hi != fp19.hi );
+	ASSERT( fp19.lo == fp20.lo && fp19.hi == fp20.hi );
+	ASSERT( fp18.lo == fp21.lo && fp18.hi == fp21.hi );
+	ASSERT( fp21.lo != fp22.lo && fp21.hi != fp22.hi );
+
+	// ... blobs are compared by their bytes, not only by their size ...
+	const char* argv8[]  = { "dummy_prog", "--key", "00ff", "--data", "QQ==" };
+	const char* argv9[]  = { "dummy_prog", "--key", "00FF", "--data", "QQ" };
+	const char* argv10[] = { "dummy_prog", "--key", "ff00", "--data", "QQ==" };
+	const char* argv11[] = { "dummy_prog", "--key", "00ff", "--data", "Qg==" };
+	getopt_fingerprint_t fp8  = fingerprint_of( (int)ARRAY_LENGTH( argv8 ), argv8 );
+	getopt_fingerprint_t fp9  = fingerprint_of( (int)ARRAY_LENGTH( argv9 ), argv9 );
+	getopt_fingerprint_t fp10 = fingerprint_of( (int)ARRAY_LENGTH( argv10 ), argv10 );
+	getopt_fingerprint_t fp11 = fingerprint_of( (int)ARRAY_LENGTH( argv11 ), argv11 );
+	ASSERT( fp8.lo == fp9.lo && fp8.hi == fp9.hi );
+	ASSERT( fp8.lo != fp10.lo && fp8.hi != fp10.hi );
+	ASSERT( fp8.lo != fp11.lo && fp8.hi != fp11.hi );
+
+	// ... also when longer than one decoded chunk ...
+	char long_key1[301];
+	char long_key2[301];
+	memset( long_key1, 'a', 300 );
+	long_key1[300] = '\0';
+	memcpy( long_key2, long_key1, sizeof( long_key2 ) );
+	long_key2[290] = 'b';
+	const char* argv12[] = { "dummy_prog", "--key", long_key1 };
+	const char* argv13[] = { "dummy_prog", "--key", long_key2 };
+	getopt_fingerprint_t fp12 = fingerprint_of( (int)ARRAY_LENGTH( argv12 ), argv12 );
+	getopt_fingerprint_t fp13 = fingerprint_of( (int)ARRAY_LENGTH( argv13 ), argv13 );
+	ASSERT( fp12.lo != fp13.lo && fp12.hi != fp13.hi );
+
+	// ... a query-index is needed ...
+	getopt_context_t ctx;
+	getopt_fingerprint_t fp;
+	ASSERT_EQ( 0,  getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv1 ), argv1, fingerprint_option_list ) );
+	ASSERT_EQ( -1, getopt_fingerprint( &ctx, 0x0, &fp ) );
+	return 0;
+}
+
+TEST queries()
+{
+	const char* argv[] = { "dummy_prog", "-a", "--cccc", "c1", "file", "--aaaa", "-c", "c2", "-e", "-a" };
+	getopt_occurrence_t occurrences[ARRAY_LENGTH( option_list )];
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+
+	// ... without an index ...
+	g_flag = 0;
+	if( check_queries( &ctx ) != 0 )
+		return -1;
+	ASSERT_EQ( 0, g_flag ); // ... queries do not set flags ...
+
+	// ... with an index, only the tokens up to the first --cccc is parsed by the first query ...
+	ASSERT_EQ( -1, getopt_create_query_index( &ctx, occurrences, 2 ) );
+	ASSERT_EQ( 0,  getopt_create_query_index( &ctx, occurrences, (int)ARRAY_LENGTH( occurrences ) ) );
+	ASSERT_EQ( 2, getopt_find( &ctx, "--cccc", 0x0 ) );
+	ASSERT_EQ( 3, ctx.query_index );
+	if( check_queries( &ctx ) != 0 )
+		return -1;
+	ASSERT_EQ( 1, occurrences[4].count );
+
+	// ... getopt_next() is not affected by queries ...
+	ASSERT_EQ( 'a', getopt_next( &ctx ) );
+	return 0;
+}
+
+static const getopt_option_t store_option_list[] =
+{
+	{ "output-dir", 'o', GETOPT_OPTION_TYPE_REQUIRED,       0x0, 'o', "help output-dir", "DIR", 0x0, 0 },
+	{ "threads",    't', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0, 't', "help threads",    "N", 0x0, 0 },
+	{ "scale",      's', GETOPT_OPTION_TYPE_REQUIRED_FP32,  0x0, 's', "help scale",      "S", 0x0, 0 },
+	{ "verbose",    'v', GETOPT_OPTION_TYPE_NO_ARG,         0x0, 'v', "help verbose",    0, 0x0, 0 },
+	{ "log_file",   'l', GETOPT_OPTION_TYPE_REQUIRED,       0x0, 'l', "help log_file",   "FILE", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+static int check_store_value( const getopt_store_t* store, int opt_index, const char* expect, getopt_source_t source )
+{
+	const getopt_value_t* value = getopt_store_get( store, &store_option_list[opt_index] );
+	if( expect == 0x0 )
+	{
+		ASSERT_EQ( (const getopt_value_t*)0x0, value );
+		return 0;
+	}
+	ASSERT( value != 0x0 );
+	ASSERT_EQ( source, value->source );
+	ASSERT_EQ( strlen( expect ), value->str_len );
+	ASSERT( strncmp( expect, value->str, value->str_len ) == 0 );
+	return 0;
+}
+
+TEST store_layers()
+{
+	const char* argv[] = { "dummy_prog", "--threads=8", "file", "-t", "16" };
+	static const char config[] =
+		"# comment\n"
+		"  output-dir = /from/config  \r\n"
+		"\n"
+		"threads=4\n"
+		"not-an-option = 1\n"
+		"scale = 0.5\n"
+		"verbose";
+	const char* env[] = { "PATH=/bin", "APP_OUTPUT_DIR=/from/env", "APP_SCALE=", "APP_LOG_FILE=log.txt", "APP_UNKNOWN=1", 0x0 };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, store_option_list ) );
+
+	getopt_value_t values[ARRAY_LENGTH( store_option_list )];
+	getopt_store_t store;
+	ASSERT_EQ( -1, getopt_store_init( &store, &ctx, values, 2 ) );
+	ASSERT_EQ( 0,  getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+
+	// ... argv first to check that precedence do not depend on read-order ...
+	int opt;
+	int num_positional = 0;
+	while( ( opt = getopt_store_next( &store ) ) != -1 )
+	{
+		switch( opt )
+		{
+			case 't': break;
+			case '+': ++num_positional; break;
+			default:
+				FAILm( "got an unexpected opt!" );
+				break;
+		}
+	}
+	ASSERT_EQ( 1, num_positional );
+
+	ASSERT_EQ( 3, getopt_store_read_env( &store, "APP_", env ) );
+	ASSERT_EQ( 5, getopt_store_read_config( &store, config, sizeof( config ) - 1 ) );
+	ASSERT_EQ( 0, getopt_store_set( &store, &store_option_list[3], "0", 1, GETOPT_SOURCE_DEFAULT ) ); // ... config has higher precedence ...
+
+	if( check_store_value( &store, 0, "/from/env",  GETOPT_SOURCE_ENV ) != 0 )         return -1;
+	if( check_store_value( &store, 1, "16",         GETOPT_SOURCE_ARGV ) != 0 )        return -1;
+	if( check_store_value( &store, 2, "",           GETOPT_SOURCE_ENV ) != 0 )         return -1;
+	if( check_store_value( &store, 3, "",           GETOPT_SOURCE_CONFIG_FILE ) != 0 ) return -1;
+	if( check_store_value( &store, 4, "log.txt",    GETOPT_SOURCE_ENV ) != 0 )         return -1;
+
+	int   i32  = 0;
+	float fp32 = 0.0f;
+	ASSERT_EQ( 0,  getopt_store_get_int32( &store, &store_option_list[1], &i32 ) );
+	ASSERT_EQ( 16, i32 );
+	ASSERT_EQ( -1, getopt_store_get_fp32( &store, &store_option_list[2], &fp32 ) ); // ... set to empty in env ...
+	ASSERT_EQ( -1, getopt_store_get_int32( &store, &store_option_list[0], &i32 ) );
+	return 0;
+}
+
+TEST store_lazy_values()
+{
+	const char* argv[] = { "dummy_prog", "--threads=abc", "--scale", "1.5", "-t", "0x10", "--scale=fast" };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, store_option_list ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_LAZY_VALUES );
+
+	getopt_value_t values[ARRAY_LENGTH( store_option_list )];
+	getopt_store_t store;
+	ASSERT_EQ( 0, getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+	getopt_store_set_strict( &store, &store_option_list[1], 1 );
+
+	// ... invalid values are not reported while parsing ...
+	ASSERT_EQ( 't', getopt_store_next( &store ) );
+	ASSERT_STR_EQ( "abc", ctx.current_opt_arg );
+	ASSERT_EQ( 's', getopt_store_next( &store ) );
+	ASSERT_EQ( 't', getopt_store_next( &store ) );
+	ASSERT_EQ( 's', getopt_store_next( &store ) );
+	ASSERT_EQ( -1,  getopt_store_next( &store ) );
+
+	// ... only strict options are checked, the invalid --threads was overridden ...
+	const getopt_option_t* failed = 0x0;
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+	ASSERT_EQ( (const getopt_option_t*)0x0, failed );
+
+	int   i32  = 0;
+	float fp32 = 0.0f;
+	ASSERT_EQ( 0, getopt_store_get_int32( &store, &store_option_list[1], &i32 ) );
+	ASSERT_EQ( 16, i32 );
+	ASSERT_EQ( -1, getopt_store_get_fp32( &store, &store_option_list[2], &fp32 ) );
+
+	// ... marking scale as strict makes check fail, setting a new value drops the cached conversion ...
+	getopt_store_set_strict( &store, &store_option_list[2], 1 );
+	ASSERT_EQ( -1, getopt_store_check( &store, &failed ) );
+	ASSERT_EQ( &store_option_list[2], failed );
+
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_option_list[2], "2.5", 3, GETOPT_SOURCE_ARGV ) );
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+	ASSERT_EQ( 0, getopt_store_get_fp32( &store, &store_option_list[2], &fp32 ) );
+	ASSERT_EQ( 2.5f, fp32 );
+	return 0;
+}
+
+static const getopt_option_t store_typed_option_list[] =
+{
+	{ "mode",  'm', GETOPT_OPTION_TYPE_REQUIRED_ENUM, 0x0, 'm', "help mode",  "fast|safe", 0x0, 0 },
+	{ "cache", 'c', GETOPT_OPTION_TYPE_REQUIRED_SIZE, 0x0, 'c', "help cache", "SIZE", 0x0, 0 },
+	{ "key",   'k', GETOPT_OPTION_TYPE_REQUIRED_HEX,  0x0, 'k', "help key",   "HEX", 0x0, 0 },
+	{ "host",  'h', GETOPT_OPTION_TYPE_REQUIRED_PATTERN, 0x0, 'h', "help host", "[a-z]+(\\.[a-z]+)*", 0x0, 0 },
+	GETOPT_OPTIONS_END
+};
+
+TEST store_lazy_typed_values()
+{
+	const char* argv[] = { "dummy_prog", "--mode=slow", "--cache=12XB", "--key=zz", "--host=a..b" };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, store_typed_option_list ) );
+	getopt_set_flags( &ctx, GETOPT_FLAG_LAZY_VALUES );
+
+	getopt_value_t values[ARRAY_LENGTH( store_typed_option_list )];
+	getopt_store_t store;
+	ASSERT_EQ( 0, getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+
+	// ... not reported while parsing ...
+	int opt;
+	while( ( opt = getopt_store_next( &store ) ) != -1 )
+		ASSERT( opt != '!' );
+
+	// ... but by the check of each strict option, with the rules of getopt_next() ...
+	const getopt_option_t* failed = 0x0;
+	int i = 0;
+	for( ; i < (int)ARRAY_LENGTH( store_typed_option_list ) - 1; ++i )
+	{
+		getopt_store_set_strict( &store, &store_typed_option_list[i], 1 );
+		ASSERT_EQ( -1, getopt_store_check( &store, &failed ) );
+		ASSERT_EQ( &store_typed_option_list[i], failed );
+		getopt_store_set_strict( &store, &store_typed_option_list[i], 0 );
+	}
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+
+	// ... a valid value passes ...
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_typed_option_list[0], "safe", 4, GETOPT_SOURCE_ARGV ) );
+	getopt_store_set_strict( &store, &store_typed_option_list[0], 1 );
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+
+	// ... values are checked in place whatever their length, only the chars in the value are used ...
+	static char long_key[4097];
+	memset( long_key, 'a', sizeof( long_key ) - 1 );
+	long_key[2048] = 'z';
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_typed_option_list[2], long_key, 2048, GETOPT_SOURCE_ARGV ) );
+	getopt_store_set_strict( &store, &store_typed_option_list[2], 1 );
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_typed_option_list[2], long_key, 2049, GETOPT_SOURCE_ARGV ) );
+	ASSERT_EQ( -1, getopt_store_check( &store, &failed ) );
+	ASSERT_EQ( &store_typed_option_list[2], failed );
+
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_typed_option_list[2], long_key, 4096, GETOPT_SOURCE_ARGV ) );
+	ASSERT_EQ( -1, getopt_store_check( &store, &failed ) );
+	getopt_store_set_strict( &store, &store_typed_option_list[2], 0 );
+
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_typed_option_list[3], long_key, 2000, GETOPT_SOURCE_ARGV ) );
+	getopt_store_set_strict( &store, &store_typed_option_list[3], 1 );
+	ASSERT_EQ( 0, getopt_store_check( &store, &failed ) );
+	return 0;
+}
+
+TEST store_snapshot()
+{
+	const char* argv[] = { "dummy_prog", "--output-dir=/tmp", "-t", "0x10", "--log_file", "/tmp" };
+
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, store_option_list ) );
+
+	getopt_value_t values[ARRAY_LENGTH( store_option_list )];
+	getopt_store_t store;
+	ASSERT_EQ( 0, getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+	while( getopt_store_next( &store ) != -1 ) {}
+	ASSERT_EQ( 1, getopt_store_set( &store, &store_option_list[2], "1.5", 3, GETOPT_SOURCE_DEFAULT ) );
+
+	// ... nothing is written if the buffer is too small ...
+	unsigned long long buffer[64];
+	int size = getopt_snapshot_write( &store, 0x0, 0 );
+	ASSERT( size > 0 && (size_t)size <= sizeof( buffer ) );
+	ASSERT_EQ( size, getopt_snapshot_write( &store, buffer, sizeof( buffer ) ) );
+
+	// ... the snapshot does not point back into the store and can be moved to any address ...
+	unsigned long long moved[64];
+	memcpy( moved, buffer, (size_t)size );
+	memset( buffer, 0xff, sizeof( buffer ) );
+
+	const getopt_snapshot_t* snapshot = getopt_snapshot_open( moved, (size_t)size, &ctx );
+	ASSERT( snapshot != 0x0 );
+
+	const getopt_snapshot_value_t* out_dir  = getopt_snapshot_get( snapshot, &ctx, &store_option_list[0] );
+	const getopt_snapshot_value_t* threads  = getopt_snapshot_get( snapshot, &ctx, &store_option_list[1] );
+	const getopt_snapshot_value_t* scale    = getopt_snapshot_get( snapshot, &ctx, &store_option_list[2] );
+	const getopt_snapshot_value_t* log_file = getopt_snapshot_get( snapshot, &ctx, &store_option_list[4] );
+	ASSERT( out_dir != 0x0 && threads != 0x0 && scale != 0x0 && log_file != 0x0 );
+	ASSERT_EQ( (const getopt_snapshot_value_t*)0x0, getopt_snapshot_get( snapshot, &ctx, &store_option_list[3] ) );
+
+	ASSERT_STR_EQ( "/tmp", getopt_snapshot_str( snapshot, out_dir ) );
+	ASSERT_EQ( GETOPT_SOURCE_ARGV, (getopt_source_t)out_dir->source );
+	ASSERT_EQ( 16, threads->value.i32 );
+	ASSERT( threads->valid );
+	ASSERT_EQ( 1.5f, scale->value.fp32 );
+	ASSERT_EQ( GETOPT_SOURCE_DEFAULT, (getopt_source_t)scale->source );
+
+	// ... equal strings are only stored once ...
+	ASSERT_EQ( out_dir->str_offset, log_file->str_offset );
+	ASSERT_EQ( getopt_snapshot_str( snapshot, out_dir ), getopt_snapshot_str( snapshot, log_file ) );
+
+	// ... snapshots for a different options-list or truncated data are rejected ...
+	getopt_context_t other_ctx;
+	ASSERT_EQ( 0, getopt_create_context( &other_ctx, (int)ARRAY_LENGTH( argv ), argv, option_list ) );
+	ASSERT_EQ( (const getopt_snapshot_t*)0x0, getopt_snapshot_open( moved, (size_t)size, &other_ctx ) );
+	ASSERT_EQ( (const getopt_snapshot_t*)0x0, getopt_snapshot_open( moved, (size_t)size - 8, &ctx ) );
+	return 0;
+}
+
+TEST store_config_file()
+{
+	const char* path = "getopt_store_test.cfg";
+	FILE* f = fopen( path, "wb" );
+	ASSERT( f != 0x0 );
+	fputs( "threads = 0x10\nscale=2.5\n", f );
+	fclose( f );
+
+	const char* argv[] = { "dummy_prog" };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, store_option_list ) );
+
+	getopt_value_t values[ARRAY_LENGTH( store_option_list )];
+	getopt_store_t store;
+	ASSERT_EQ( 0, getopt_store_init( &store, &ctx, values, (int)ARRAY_LENGTH( values ) ) );
+	ASSERT_EQ( -1, getopt_store_read_config_file( &store, "does_not_exist.cfg" ) );
+	ASSERT_EQ( 0, getopt_store_read_config_file( &store, path ) );
+
+	int   i32  = 0;
+	float fp32 = 0.0f;
+	ASSERT_EQ( 0, getopt_store_get_int32( &store, &store_option_list[1], &i32 ) );
+	ASSERT_EQ( 0, getopt_store_get_fp32( &store, &store_option_list[2], &fp32 ) );
+	ASSERT_EQ( 16, i32 );
+	ASSERT_EQ( 2.5f, fp32 );
+
+	getopt_store_release( &store );
+	remove( path );
+	return 0;
+}
+
+struct store_changes
+{
+	int         num_changes;
+	const char* changed[8];
+};
+
+static void store_on_change( const getopt_option_t* opt, const getopt_value_t*, const getopt_value_t*, void* userdata )
+{
+	store_changes* changes = (store_changes*)userdata;
+	changes->changed[changes->num_changes++] = opt->name;
+}
+
+static void store_write_file( const char* path, const char* data )
+{
+	FILE* f = fopen( path, "wb" );
+	fputs( data, f );
+	fclose( f );
+}
+
+TEST store_watch()
+{
+	const char* path = "getopt_store_watch_test.cfg";
+	store_write_file( path, "output-dir = /a\n"
+							"threads = 4\n"
+							"log_file = a.log\n"
+							"scale = 1.5\n" );
+
+	static int watch_flag = 0;
+	static const getopt_option_t watch_option_list[] =
+	{
+		{ "output-dir", 'o', GETOPT_OPTION_TYPE_REQUIRED,       0x0,         'o', "help output-dir", "DIR", 0x0, 0 },
+		{ "threads",    't', GETOPT_OPTION_TYPE_REQUIRED_INT32, 0x0,         't', "help threads",    "N", 0x0, 0 },
+		{ "scale",      's', GETOPT_OPTION_TYPE_REQUIRED_FP32,  0x0,         's', "help scale",      "S", 0x0, 0 },
+		{ "log_file",   'l', GETOPT_OPTION_TYPE_REQUIRED,       0x0,         'l', "help log_file",   "FILE", 0x0, 0 },
+		{ "fast",       'f', GETOPT_OPTION_TYPE_FLAG_SET,       &watch_flag,  1,  "help fast",       0, 0x0, 0 },
+		GETOPT_OPTIONS_END
+	};
+
+	const char* argv[] = { "dummy_prog" };
+	const char* env[]  = { "APP_LOG_FILE=env.log", 0x0 };
+	getopt_context_t ctx;
+	ASSERT_EQ( 0, getopt_create_context( &ctx, (int)ARRAY_LENGTH( argv ), argv, watch_option_list ) );
+
+	getopt_value_t values[2][ARRAY_LENGTH( watch_option_list )];
+	getopt_store_t stores[2];
+	ASSERT_EQ( 0, getopt_store_init( &stores[0], &ctx, values[0], (int)ARRAY_LENGTH( values[0] ) ) );
+	ASSERT_EQ( 0, getopt_store_init( &stores[1], &ctx, values[1], (int)ARRAY_LENGTH( values[1] ) ) );
+	ASSERT_EQ( 1, getopt_store_read_env( &stores[0], "APP_", env ) );
+
+	char  buffer0[256];
+	char  buffer1[256];
+	char* buffers[2] = { buffer0, buffer1 };
+
+	getopt_store_watch_t watch;
+	ASSERT_EQ( 0, getopt_store_watch_init( &watch, &stores[0], &stores[1], path, buffers, sizeof( buffer0 ) ) );
+	ASSERT_EQ( &stores[0], getopt_store_watch_current( &watch ) );
+
+	// ... values are converted before readers get the store, reading them do not write to it ...
+	getopt_value_t before[ARRAY_LENGTH( watch_option_list )];
+	memcpy( before, values[0], sizeof( before ) );
+	int   i32  = 0;
+	float fp32 = 0.0f;
+	ASSERT_EQ( 0, getopt_store_get_int32( &stores[0], &watch_option_list[1], &i32 ) );
+	ASSERT_EQ( 0, getopt_store_get_fp32( &stores[0], &watch_option_list[2], &fp32 ) );
+	ASSERT_EQ( -1, getopt_store_get_int32( &stores[0], &watch_option_list[0], &i32 ) );
+	ASSERT_EQ( 0, memcmp( before, values[0], sizeof( before ) ) );
+
+	// ... change threads, remove output-dir, add fast, log_file is set from env and should not change ...
+	store_write_file( path, "threads = 8\n"
+							"log_file = b.log\n"
+							"fast\n"
+							"scale = 1.5\n" );
+
+	store_changes changes = { 0, { 0x0 } };
+	ASSERT_EQ( 0, getopt_store_watch_reload( &watch, store_on_change, &changes ) );
+
+	const getopt_store_t* store = getopt_store_watch_current( &watch );
+	ASSERT_EQ( &stores[1], store );
+	ASSERT_EQ( 3, changes.num_changes );
+	ASSERT_STR_EQ( "output-dir", changes.changed[0] );
+	ASSERT_STR_EQ( "threads",    changes.changed[1] );
+	ASSERT_STR_EQ( "fast",       changes.changed[2] );
+	ASSERT_EQ( 1, watch_flag );
+
+	ASSERT_EQ( (const getopt_value_t*)0x0, getopt_store_get( store, &watch_option_list[0] ) );
+	ASSERT_EQ( 0, getopt_store_get_int32( store, &watch_option_list[1], &i32 ) );
+	ASSERT_EQ( 8, i32 );
+	ASSERT_EQ( 0, getopt_store_get_fp32( store, &watch_option_list[2], &fp32 ) );
+	ASSERT_EQ( 1.5f, fp32 );
+	ASSERT_EQ( GETOPT_SOURCE_ENV, getopt_store_get( store, &watch_option_list[3] )->source );
+
+	// ... no change, no reload ...
+	ASSERT_EQ( 0, getopt_store_watch_poll( &watch, store_on_change, &changes ) );
+
+	// ... a change in the middle of the file ...
+	store_write_file( path, "threads = 8\n"
+							"log_file = b.log\n"
+							"scale = 2.5\n" );
+	changes.num_changes = 0;
+	ASSERT_EQ( 0, getopt_store_watch_reload( &watch, store_on_change, &changes ) );
+	store = getopt_store_watch_current( &watch );
+	ASSERT_EQ( &stores[0], store );
+	ASSERT_EQ( 2, changes.num_changes );
+	ASSERT_STR_EQ( "scale", changes.changed[0] );
+	ASSERT_STR_EQ( "fast",  changes.changed[1] );
+	ASSERT_EQ( 0, watch_flag ); // ... the removed flag is undone ...
+	ASSERT_EQ( 0, getopt_store_get_int32( store, &watch_option_list[1], &i32 ) );
+	ASSERT_EQ( 8, i32 );
+	ASSERT_EQ( 0, getopt_store_get_fp32( store, &watch_option_list[2], &fp32 ) );
+	ASSERT_EQ( 2.5f, fp32 );
+
+	// ... a reload never rewrites a store that a reader still uses ...
+	const getopt_store_t* held = getopt_store_watch_acquire( &watch );
+	ASSERT_EQ( &stores[0], held );
+	ASSERT_EQ( 0, getopt_store_watch_reload( &watch, 0x0, 0x0 ) );
+	ASSERT_EQ( &stores[1], getopt_store_watch_current( &watch ) );
+	ASSERT_EQ( -2, getopt_store_watch_reload( &watch, 0x0, 0x0 ) );
+	ASSERT_EQ( 0, getopt_store_watch_poll( &watch, 0x0, 0x0 ) );
+	ASSERT_EQ( 0, getopt_store_get_fp32( held, &watch_option_list[2], &fp32 ) );
+	ASSERT_EQ( 2.5f, fp32 );
+	getopt_store_watch_done( &watch, held );
+	ASSERT_EQ( 0, getopt_store_watch_reload( &watch, 0x0, 0x0 ) );
+	ASSERT_EQ( &stores[0], getopt_store_watch_current( &watch ) );
+
+	// ... without inotify a second write within the same second is still seen ...
+	getopt_store_watch_release( &watch );
+	ASSERT_EQ( 0, getopt_store_watch_poll( &watch, 0x0, 0x0 ) );
+	store_write_file( path, "threads = 16\n"
+							"log_file = b.log\n"
+							"scale = 2.5\n" );
+	ASSERT_EQ( 1, getopt_store_watch_poll( &watch, 0x0, 0x0 ) );
+	ASSERT_EQ( 0, getopt_store_get_int32( getopt_store_watch_current( &watch ), &watch_option_list[1], &i32 ) );
+	ASSERT_EQ( 16, i32 );
+	ASSERT_EQ( 0, getopt_store_watch_poll( &watch, 0x0, 0x0 ) );
+
+	remove( path );
+	return 0;
+}
+
 GREATEST_SUITE( getopt )
 {
 	RUN_TEST( short_opt );
@@ -740,6 +2688,38 @@ GREATEST_SUITE( getopt )
 	RUN_TEST( same_prefix_long_opt );
 	RUN_TEST( no_longopt_with_longopt );
 	RUN_TEST( capture_bad_longopt );
+	RUN_TEST( enum_and_bitmask );
+	RUN_TEST( unit_values );
+	RUN_TEST( constraints );
+	RUN_TEST( limits );
+	RUN_TEST( abbreviations );
+	RUN_TEST( no_abbreviations_by_default );
+	RUN_TEST( index_lookup );
+	RUN_TEST( registry );
+	RUN_TEST( aliases_and_negation );
+	RUN_TEST( paths );
+	RUN_TEST( blob_values );
+#if !defined(GETOPT_NO_GLOB)
+	RUN_TEST( glob_expansion );
+#endif
+	RUN_TEST( patterns );
+	RUN_TEST( strict_text );
+#if defined(GETOPT_TEST_CPP17)
+	RUN_TEST( cpp_layer );
+#endif
+	RUN_TEST( suggestions );
+	RUN_TEST( completion );
+	RUN_TEST( completion_of_values );
+	RUN_TEST( completion_script );
+	RUN_TEST( subcommands );
+	RUN_TEST( queries );
+	RUN_TEST( fingerprint );
+	RUN_TEST( store_layers );
+	RUN_TEST( store_lazy_values );
+	RUN_TEST( store_lazy_typed_values );
+	RUN_TEST( store_snapshot );
+	RUN_TEST( store_config_file );
+	RUN_TEST( store_watch );
 }
 
 GREATEST_MAIN_DEFS();